@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "avl.h"
+
+/*
+ * AVL Tree
+ *
+ * Usage:
+ * avl *tree = avl_create();
+ * avl_insert(tree, 10);
+ * bool found = avl_contains(tree, 10);
+ * avl_remove(tree, 10);
+ * avl_destroy(tree);
+ *
+ * Every node stores the height of its subtree. Inserts and removals walk down
+ * iteratively, remembering the links they followed, then walk back up that path
+ * updating heights and rotating wherever the two sides of a node differ by two.
+ */
+
+// --- Maximum Height ---
+// An AVL tree of height h holds at least fib(h + 2) - 1 nodes, so 96 levels is far
+// more than any size_t number of nodes needs.
+#define AVL_MAX_HEIGHT 96
+
+// --- Tree Node ---
+// 24 bytes, the same as the plain tree's struct node: the height fills the padding.
+struct avl_node
+{
+    int val;
+    int height; // Height of the subtree rooted here, 1 for a leaf
+    struct avl_node *left, *right;
+};
+
+// --- Tree Structure ---
+struct avl
+{
+    struct avl_node *root;
+    size_t length; // Number of values stored
+};
+
+/*
+ * avl_create
+ * ----------
+ * Allocates an empty tree.
+ */
+avl *avl_create(void)
+{
+    avl *tree = malloc(sizeof(avl));
+    if (tree == NULL)
+        return NULL;
+    tree->root = NULL;
+    tree->length = 0;
+    return tree;
+}
+
+/*
+ * avl_free_nodes
+ * ----------
+ * Frees a subtree. The recursion is bounded by the tree's height.
+ */
+static void avl_free_nodes(struct avl_node *node)
+{
+    if (node == NULL)
+        return;
+    avl_free_nodes(node->left);
+    avl_free_nodes(node->right);
+    free(node);
+}
+
+void avl_destroy(avl *tree)
+{
+    if (tree == NULL)
+        return;
+    avl_free_nodes(tree->root);
+    free(tree);
+}
+
+static inline int avl_node_height(const struct avl_node *node)
+{
+    return node != NULL ? node->height : 0;
+}
+
+static inline void avl_update_height(struct avl_node *node)
+{
+    int left = avl_node_height(node->left), right = avl_node_height(node->right);
+    node->height = (left > right ? left : right) + 1;
+}
+
+/*
+ * avl_rotate_right / avl_rotate_left
+ * ----------
+ * Lift the left (right) child of node into its place, and return it as the new
+ * root of the subtree.
+ */
+static struct avl_node *avl_rotate_right(struct avl_node *node)
+{
+    struct avl_node *left = node->left;
+    node->left = left->right;
+    left->right = node;
+    avl_update_height(node);
+    avl_update_height(left);
+    return left;
+}
+
+static struct avl_node *avl_rotate_left(struct avl_node *node)
+{
+    struct avl_node *right = node->right;
+    node->right = right->left;
+    right->left = node;
+    avl_update_height(node);
+    avl_update_height(right);
+    return right;
+}
+
+/*
+ * avl_rebalance
+ * ----------
+ * Updates the height of node, whose subtrees are balanced and differ in height by
+ * at most two, and rotates it back into balance if needed (a double rotation when
+ * the taller child leans the other way). Returns the new root of the subtree.
+ */
+static struct avl_node *avl_rebalance(struct avl_node *node)
+{
+    avl_update_height(node);
+    int balance = avl_node_height(node->left) - avl_node_height(node->right);
+
+    if (balance > 1)
+    {
+        if (avl_node_height(node->left->left) < avl_node_height(node->left->right))
+            node->left = avl_rotate_left(node->left);
+        return avl_rotate_right(node);
+    }
+    if (balance < -1)
+    {
+        if (avl_node_height(node->right->right) < avl_node_height(node->right->left))
+            node->right = avl_rotate_right(node->right);
+        return avl_rotate_left(node);
+    }
+    return node;
+}
+
+/*
+ * avl_insert
+ * ----------
+ * Descends to the empty link where val belongs, hangs a new leaf there and
+ * rebalances the ancestors bottom-up. It stops at the first ancestor whose height
+ * doesn't change: an insert needs at most one (single or double) rotation.
+ */
+bool avl_insert(avl *tree, int val)
+{
+    if (tree == NULL)
+        return false;
+
+    struct avl_node **path[AVL_MAX_HEIGHT];
+    size_t depth = 0;
+    struct avl_node **link = &tree->root;
+    while (*link != NULL)
+    {
+        if (val == (*link)->val)
+            return true;
+        path[depth++] = link;
+        link = val < (*link)->val ? &(*link)->left : &(*link)->right;
+    }
+
+    struct avl_node *node = malloc(sizeof(struct avl_node));
+    if (node == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for new tree node.\n");
+        return false;
+    }
+    node->val = val;
+    node->height = 1;
+    node->left = node->right = NULL;
+    *link = node;
+    tree->length++;
+
+    while (depth > 0)
+    {
+        link = path[--depth];
+        int height = (*link)->height;
+        *link = avl_rebalance(*link);
+        if ((*link)->height == height)
+            break;
+    }
+    return true;
+}
+
+/*
+ * avl_contains
+ * ----------
+ * Plain binary search from the root.
+ */
+bool avl_contains(avl *tree, int val)
+{
+    if (tree == NULL)
+        return false;
+
+    const struct avl_node *node = tree->root;
+    while (node != NULL && node->val != val)
+        node = val < node->val ? node->left : node->right;
+    return node != NULL;
+}
+
+/*
+ * avl_remove
+ * ----------
+ * A node with two children takes the value of its in-order successor (the leftmost
+ * node of its right subtree), which is removed instead: the node actually unlinked
+ * always has at most one child, which takes its place. Every ancestor on the path
+ * is then rebalanced, as a removal may need a rotation at each level.
+ */
+bool avl_remove(avl *tree, int val)
+{
+    if (tree == NULL)
+        return false;
+
+    struct avl_node **path[AVL_MAX_HEIGHT];
+    size_t depth = 0;
+    struct avl_node **link = &tree->root;
+    while (*link != NULL && (*link)->val != val)
+    {
+        path[depth++] = link;
+        link = val < (*link)->val ? &(*link)->left : &(*link)->right;
+    }
+    if (*link == NULL)
+        return false;
+
+    struct avl_node *node = *link;
+    if (node->left != NULL && node->right != NULL)
+    {
+        path[depth++] = link;
+        struct avl_node **successor = &node->right;
+        while ((*successor)->left != NULL)
+        {
+            path[depth++] = successor;
+            successor = &(*successor)->left;
+        }
+        node->val = (*successor)->val;
+        link = successor;
+        node = *successor;
+    }
+
+    *link = node->left != NULL ? node->left : node->right;
+    free(node);
+    tree->length--;
+
+    while (depth > 0)
+    {
+        link = path[--depth];
+        *link = avl_rebalance(*link);
+    }
+    return true;
+}
+
+size_t avl_length(avl *tree)
+{
+    return tree != NULL ? tree->length : 0;
+}
+
+int avl_height(avl *tree)
+{
+    return tree != NULL ? avl_node_height(tree->root) : 0;
+}
+
+static void avl_walk_nodes(const struct avl_node *node, void (*visit)(int val, void *ctx), void *ctx)
+{
+    while (node != NULL)
+    {
+        avl_walk_nodes(node->left, visit, ctx);
+        visit(node->val, ctx);
+        node = node->right;
+    }
+}
+
+/*
+ * avl_walk
+ * ----------
+ * In-order traversal. Recursion is bounded by the tree's height.
+ */
+void avl_walk(avl *tree, void (*visit)(int val, void *ctx), void *ctx)
+{
+    if (tree != NULL && visit != NULL)
+        avl_walk_nodes(tree->root, visit, ctx);
+}
+
+static void avl_print_value(int val, void *ctx)
+{
+    (void)ctx;
+    printf("%d\n", val);
+}
+
+void avl_print_sorted(avl *tree)
+{
+    avl_walk(tree, avl_print_value, NULL);
+}
@@ -0,0 +1,45 @@
+#ifndef AVL_H
+#define AVL_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/*
+ * Balanced (AVL) binary search tree: an ordered set of ints.
+ * The heights of the two subtrees of every node differ by at most one,
+ * so the tree is never deeper than 1.44 log2(n) and every operation is O(log n),
+ * whatever order the values arrive in.
+ */
+
+typedef struct avl avl;
+
+/** Create an empty tree, or NULL if out of memory */
+avl *avl_create(void);
+
+/** Free the tree and all its nodes */
+void avl_destroy(avl *tree);
+
+/** Insert val. A value that is already in the tree is left as it is.
+ *  Return false if out of memory.
+ */
+bool avl_insert(avl *tree, int val);
+
+/** Return true if val is in the tree */
+bool avl_contains(avl *tree, int val);
+
+/** Remove val. Return true if it was in the tree. */
+bool avl_remove(avl *tree, int val);
+
+/** Number of values in the tree */
+size_t avl_length(avl *tree);
+
+/** Height of the tree: the number of nodes on its longest root-to-leaf path, 0 when empty */
+int avl_height(avl *tree);
+
+/** Call visit(val, ctx) on every value, in ascending order. visit must not modify the tree. */
+void avl_walk(avl *tree, void (*visit)(int val, void *ctx), void *ctx);
+
+/** Print every value in ascending order, one per line */
+void avl_print_sorted(avl *tree);
+
+#endif
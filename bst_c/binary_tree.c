@@ -1,30 +1,47 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include "binary_tree.h"
+#include "node_pool.h"
 
-// This code doesn't handle the free, since it's just a trivial example.
+/*
+ * Binary Search Tree
+ *
+ * Usage:
+ * struct node *root = NULL;
+ * root = add(root, 10);
+ * root = add(root, 5);
+ * if (!add_checked(&root, 7)) // same as add, but tells if out of memory
+ *     ...
+ * print_sorted(root); // 5, 7, 10
+ * free_tree(root);
+ */
 
-struct node
-{
-    int val;
-    struct node *left, *right;
-};
-
-/** Add a new node, if root is NULL return the new root
- * (the first inserted node) otherwise it just returns
- * the root passed by the user in input*/
-struct node *add(struct node *root, int val)
+/*
+ * link_node
+ * ----------
+ * Walks down from the root, left for smaller values and right for the others,
+ * and hangs the new node where the walk falls off the tree.
+ */
+static struct node *link_node(struct node *root, struct node *new)
 {
     struct node *saved_root = root;
-    struct node *new = malloc(sizeof(*new));
     new->left = new->right = NULL;
-    new->val = val;
 
     if (root == NULL)
         return new;
 
     while (1)
     {
-        if (val < root->val)
+        if (new->val < root->val)
+        {
+            if (root->left == NULL)
+            {
+                root->left = new;
+                return saved_root;
+            }
+            root = root->left;
+        }
+        else
         {
             if (root->right == NULL)
             {
@@ -33,40 +50,290 @@ struct node *add(struct node *root, int val)
             }
             root = root->right;
         }
+    }
+}
+
+/*
+ * add_checked
+ * ----------
+ * Links a new malloc'd node into *root, leaving the tree as it was if out of memory.
+ */
+bool add_checked(struct node **root, int val)
+{
+    struct node *new = malloc(sizeof(*new));
+    if (new == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for new node.\n");
+        return false;
+    }
+    new->val = val;
+    *root = link_node(*root, new);
+    return true;
+}
+
+struct node *add(struct node *root, int val)
+{
+    add_checked(&root, val);
+    return root;
+}
+
+/*
+ * add_pooled_checked
+ * ----------
+ * Same as add_checked, with the node taken from pool.
+ */
+bool add_pooled_checked(struct node_pool *pool, struct node **root, int val)
+{
+    struct node *new = node_pool_alloc(pool);
+    if (new == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for new node.\n");
+        return false;
+    }
+    new->val = val;
+    *root = link_node(*root, new);
+    return true;
+}
+
+struct node *add_pooled(struct node_pool *pool, struct node *root, int val)
+{
+    add_pooled_checked(pool, &root, val);
+    return root;
+}
+
+/*
+ * link_balanced
+ * ----------
+ * Fills nodes with the subtree of values[0..n-1], in pre-order: its root takes the middle
+ * value, then the left and right halves follow. Returns the subtree's root (nodes itself).
+ * The recursion is as deep as the tree, about log2(n).
+ */
+static struct node *link_balanced(struct node *nodes, const int *values, size_t n)
+{
+    size_t mid = n / 2;
+    nodes->val = values[mid];
+    nodes->left = mid > 0 ? link_balanced(nodes + 1, values, mid) : NULL;
+    nodes->right = n - mid - 1 > 0 ? link_balanced(nodes + 1 + mid, values + mid + 1, n - mid - 1) : NULL;
+    return nodes;
+}
+
+struct node *build_sorted(struct node_pool *pool, const int *values, size_t n)
+{
+    if (pool == NULL || values == NULL || n == 0)
+        return NULL;
+    for (size_t i = 1; i < n; i++)
+    {
+        if (values[i] < values[i - 1])
+        {
+            fprintf(stderr, "Error: build_sorted needs values in ascending order.\n");
+            return NULL;
+        }
+    }
+
+    struct node *nodes = node_pool_alloc_many(pool, n);
+    if (nodes == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for tree nodes.\n");
+        return NULL;
+    }
+    return link_balanced(nodes, values, n);
+}
+
+/*
+ * find
+ * ----------
+ * Returns the first node holding val on the way down, or NULL if there is none.
+ */
+struct node *find(struct node *root, int val)
+{
+    while (root != NULL && root->val != val)
+        root = val < root->val ? root->left : root->right;
+    return root;
+}
+
+/*
+ * find_lower_bound
+ * ----------
+ * Walks down as find does, remembering the last node at which it turned left:
+ * the smallest value seen that is not below val.
+ */
+struct node *find_lower_bound(struct node *root, int val)
+{
+    struct node *best = NULL;
+    while (root != NULL)
+    {
+        if (root->val >= val)
+        {
+            best = root;
+            root = root->left;
+        }
         else
         {
-            if (root->left == NULL)
+            root = root->right;
+        }
+    }
+    return best;
+}
+
+bst_it bst_iterator(struct node *root)
+{
+    bst_it it;
+    it.val = 0;
+    it._node = root;
+    it._stack = NULL;
+    it._depth = 0;
+    it._size = 0;
+    return it;
+}
+
+/*
+ * bst_next
+ * ----------
+ * Pushes the left spine of the pending subtree, then pops the smallest node pushed:
+ * its value comes next, and its right subtree is the one to descend into after it.
+ * The stack holds at most one node per level of the tree.
+ */
+bool bst_next(bst_it *it)
+{
+    if (it == NULL)
+        return false;
+
+    for (struct node *node = it->_node; node != NULL; node = node->left)
+    {
+        if (it->_depth == it->_size)
+        {
+            size_t size = it->_size > 0 ? it->_size * 2 : 64;
+            struct node **stack = realloc(it->_stack, size * sizeof(struct node *));
+            if (stack == NULL)
             {
-                root->left = new;
-                return saved_root;
+                fprintf(stderr, "Error: Failed to allocate memory for tree iterator.\n");
+                it->_node = node;
+                return false;
             }
-            root = root->left;
+            it->_stack = stack;
+            it->_size = size;
         }
+        it->_stack[it->_depth++] = node;
     }
+    it->_node = NULL;
+
+    if (it->_depth == 0)
+    {
+        bst_iterator_stop(it);
+        return false;
+    }
+    struct node *node = it->_stack[--it->_depth];
+    it->val = node->val;
+    it->_node = node->right;
+    return true;
 }
 
-void print_sorted(struct node *root)
+void bst_iterator_stop(bst_it *it)
 {
-    if (root == NULL)
+    if (it == NULL)
         return;
-    print_sorted(root->left);
-    printf("%d\n", root->val);
-    print_sorted(root->right);
+    free(it->_stack);
+    it->_stack = NULL;
+    it->_node = NULL;
+    it->_depth = it->_size = 0;
+}
+
+bool walk_sorted(struct node *root, void (*visit)(int val, void *ctx), void *ctx)
+{
+    bst_it it = bst_iterator(root);
+    while (bst_next(&it))
+        visit(it.val, ctx);
+
+    // Out of memory leaves nodes to visit, as at the end there are none
+    bool done = it._node == NULL && it._depth == 0;
+    bst_iterator_stop(&it);
+    return done;
 }
 
-int main(void)
+// --- Output Buffer ---
+// Large enough that writing millions of values takes a few hundred fwrite calls.
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+#define MAX_INT_CHARS 12 // "-2147483648\n"
+
+/*
+ * format_int
+ * ----------
+ * Writes val in decimal followed by a newline at dst, and returns the number of chars written.
+ */
+static size_t format_int(char *dst, int val)
 {
-    struct node *root = NULL;
+    char digits[MAX_INT_CHARS];
+    size_t count = 0, length = 0;
+    unsigned magnitude = val < 0 ? 0u - (unsigned)val : (unsigned)val;
+    do
+    {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
 
-    root = add(root, 10);
-    root = add(root, 5);
-    root = add(root, 120);
-    root = add(root, 40);
-    root = add(root, 33);
-    root = add(root, 2);
-    root = add(root, 11);
-    root = add(root, 23);
+    if (val < 0)
+        dst[length++] = '-';
+    while (count > 0)
+        dst[length++] = digits[--count];
+    dst[length++] = '\n';
+    return length;
+}
+
+bool write_sorted(struct node *root, FILE *out)
+{
+    char *buffer = malloc(OUTPUT_BUFFER_SIZE);
+    if (buffer == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for output buffer.\n");
+        return false;
+    }
 
-    print_sorted(root);
-    return 0;
+    bool ok = true;
+    size_t used = 0;
+    bst_it it = bst_iterator(root);
+    while (ok && bst_next(&it))
+    {
+        if (OUTPUT_BUFFER_SIZE - used < MAX_INT_CHARS)
+        {
+            ok = fwrite(buffer, 1, used, out) == used;
+            used = 0;
+        }
+        used += format_int(buffer + used, it.val);
+    }
+    ok = ok && it._node == NULL && it._depth == 0 && fwrite(buffer, 1, used, out) == used;
+    bst_iterator_stop(&it);
+    free(buffer);
+    return ok;
+}
+
+void print_sorted(struct node *root)
+{
+    if (!write_sorted(root, stdout))
+        fprintf(stderr, "Error: Failed to print the tree.\n");
+}
+
+/*
+ * free_tree
+ * ----------
+ * Rotates left children up until the root has none, then frees the root and
+ * continues with its right child: every node is freed once, in O(n), with no stack.
+ */
+void free_tree(struct node *root)
+{
+    while (root != NULL)
+    {
+        if (root->left != NULL)
+        {
+            struct node *left = root->left;
+            root->left = left->right;
+            left->right = root;
+            root = left;
+        }
+        else
+        {
+            struct node *right = root->right;
+            free(root);
+            root = right;
+        }
+    }
 }
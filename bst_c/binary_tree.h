@@ -0,0 +1,101 @@
+#ifndef BINARY_TREE_H
+#define BINARY_TREE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/*
+ * Plain (unbalanced) binary search tree of ints.
+ * Smaller values go left, so an in-order walk visits them in ascending order.
+ * No rebalancing: sorted input makes the tree a linked list (see avl.h for a balanced one).
+ */
+
+struct node
+{
+    int val;
+    struct node *left, *right;
+};
+
+/** Add a new node, if root is NULL return the new root
+ * (the first inserted node) otherwise it just returns
+ * the root passed by the user in input.
+ * Equal values are kept, to the right of the existing ones.
+ * If out of memory the value isn't added and root is returned unchanged,
+ * so root = add(root, val) never loses the tree: use add_checked to know. */
+struct node *add(struct node *root, int val);
+
+/** Same as add, but updates *root in place and returns false if out of memory,
+ *  in which case the tree is left as it was.
+ */
+bool add_checked(struct node **root, int val);
+
+/** Same as add, but the new node comes from pool (see node_pool.h) instead of malloc.
+ *  Every node of the tree must come from the same pool: node_pool_free releases
+ *  them all, and free_tree must not be called on the tree.
+ */
+struct node_pool;
+struct node *add_pooled(struct node_pool *pool, struct node *root, int val);
+
+/** Same as add_checked, but the new node comes from pool as in add_pooled */
+bool add_pooled_checked(struct node_pool *pool, struct node **root, int val);
+
+/** Build a perfectly balanced tree of the n values, which must be in ascending order,
+ *  in O(n): the nodes are one contiguous block taken from pool, in pre-order (the root
+ *  first, then its left subtree, then its right one). More values can be added with
+ *  add_pooled from the same pool. Equal values may end up on either side of each other,
+ *  which find and the in-order walks don't mind.
+ *  Return the root, or NULL if n is 0, the values aren't sorted, or out of memory.
+ */
+struct node *build_sorted(struct node_pool *pool, const int *values, size_t n);
+
+/** Find a node holding val, or NULL if there is none */
+struct node *find(struct node *root, int val);
+
+/** In-order iterator: create with bst_iterator, iterate with bst_next.
+ *  It keeps an explicit stack of the nodes still to visit on the heap, not on the C stack,
+ *  so it works on degenerate trees however deep they are.
+ */
+typedef struct
+{
+    int val;
+
+    // don't use these directly
+    struct node *_node;   // Next subtree to descend into, NULL when the stack top is next
+    struct node **_stack; // Nodes whose left subtree is being visited
+    size_t _depth, _size;
+} bst_it;
+
+/** Returns new in-order iterator over the tree */
+bst_it bst_iterator(struct node *root);
+
+/** Move the iterator to the next value in ascending order, update its val, and return true.
+ *  If there are no more values it frees the stack and returns false. It also returns false
+ *  when out of memory for the stack, which bst_iterator_stop must then free.
+ *  Don't add nodes to the tree during iteration.
+ */
+bool bst_next(bst_it *it);
+
+/** Free the iterator's stack when stopping before bst_next returned false */
+void bst_iterator_stop(bst_it *it);
+
+/** Find the node holding the smallest value >= val, or NULL if every value is smaller */
+struct node *find_lower_bound(struct node *root, int val);
+
+/** Call visit(val, ctx) on every value, in ascending order.
+ *  Return false if out of memory for the iterator's stack.
+ */
+bool walk_sorted(struct node *root, void (*visit)(int val, void *ctx), void *ctx);
+
+/** Write every value in ascending order to out, one per line, formatted into large
+ *  buffers written with one fwrite each rather than one printf per value.
+ *  Return false on write errors or out of memory.
+ */
+bool write_sorted(struct node *root, FILE *out);
+
+/** Print every value in ascending order, one per line (write_sorted to stdout) */
+void print_sorted(struct node *root);
+
+/** Free every node of the tree, without recursion (a degenerate tree may be very deep) */
+void free_tree(struct node *root);
+
+#endif
@@ -0,0 +1,557 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "bptree.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/*
+ * B+tree
+ *
+ * Usage:
+ * bptree *tree = bptree_create();
+ * bptree_insert(tree, 10);
+ * bool found = bptree_contains(tree, 10);
+ * size_t in_range = bptree_range(tree, 0, 100, visit, ctx);
+ * bptree_destroy(tree);
+ *
+ * Every slot past the last key of a node holds INT_MAX, so a node is searched by
+ * counting the keys smaller than the target over the whole key array, in fixed-size
+ * SIMD steps with no branch per key. In a leaf that count is the position of the
+ * target; in an inner node it is the child to descend into, as key i of an inner node
+ * is the largest value in the subtree of child i.
+ *
+ * A full node splits in two halves, except that a full rightmost leaf gaining a new
+ * largest value keeps all its keys and starts a new leaf with it, so ascending input
+ * (the worst case of the plain tree) packs the leaves full.
+ * There is no removal: the tree is meant for building and searching large sets.
+ */
+
+// --- Node Sizes ---
+// Multiples of 8 keys, for whole SIMD steps: 2 cache lines of inner keys, 4 of leaf keys.
+#define INNER_KEYS 32
+#define LEAF_KEYS 64
+
+// A tree of height h holds at least 2 * 17^(h - 2) leaves, so 32 levels never run out.
+#define MAX_HEIGHT 32
+
+// --- Node Layouts ---
+// Keys come first and are padded with INT_MAX; tree height tells leaves from inner nodes.
+typedef struct bpt_inner
+{
+    int keys[INNER_KEYS];
+    int count; // Keys in use: the node has count + 1 children
+    void *children[INNER_KEYS + 1];
+} bpt_inner;
+
+typedef struct bpt_leaf
+{
+    int keys[LEAF_KEYS];
+    int count;             // Keys in use
+    struct bpt_leaf *next; // Leaf with the next larger keys, NULL for the last one
+} bpt_leaf;
+
+// --- Tree Structure ---
+struct bptree
+{
+    void *root;      // Leaf when height is 1, inner node above that
+    bpt_leaf *first; // Leaf with the smallest keys, where walks start
+    int height;      // Levels of nodes, 0 for an empty tree
+    size_t length;   // Number of values stored
+};
+
+/*
+ * count_less
+ * ----------
+ * Returns the number of keys smaller than x among the size (a multiple of 8) keys at keys.
+ * Keys are sorted and padded with INT_MAX, so that is the position of x among them.
+ */
+#if defined(__SSE2__)
+
+static inline int count_less(const int *keys, int size, int x)
+{
+    __m128i target = _mm_set1_epi32(x), sum = _mm_setzero_si128();
+    for (int i = 0; i < size; i += 8)
+    {
+        __m128i low = _mm_loadu_si128((const __m128i *)(keys + i));
+        __m128i high = _mm_loadu_si128((const __m128i *)(keys + i + 4));
+        // Each compare is -1 for a smaller key: subtracting counts them per lane
+        sum = _mm_sub_epi32(sum, _mm_cmplt_epi32(low, target));
+        sum = _mm_sub_epi32(sum, _mm_cmplt_epi32(high, target));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+#elif defined(__ARM_NEON)
+
+static inline int count_less(const int *keys, int size, int x)
+{
+    int32x4_t target = vdupq_n_s32(x);
+    uint32x4_t sum = vdupq_n_u32(0);
+    for (int i = 0; i < size; i += 8)
+    {
+        sum = vsubq_u32(sum, vcltq_s32(vld1q_s32(keys + i), target));
+        sum = vsubq_u32(sum, vcltq_s32(vld1q_s32(keys + i + 4), target));
+    }
+    // Widen pairwise and add the two lanes: vaddvq_u32 is AArch64 only
+    uint64x2_t pairs = vpaddlq_u32(sum);
+    return (int)(vgetq_lane_u64(pairs, 0) + vgetq_lane_u64(pairs, 1));
+}
+
+#else
+
+static inline int count_less(const int *keys, int size, int x)
+{
+    int count = 0;
+    for (int i = 0; i < size; i++)
+        count += keys[i] < x;
+    return count;
+}
+
+#endif
+
+static bpt_leaf *bpt_new_leaf(void)
+{
+    bpt_leaf *leaf = malloc(sizeof(bpt_leaf));
+    if (leaf == NULL)
+        return NULL;
+    for (int i = 0; i < LEAF_KEYS; i++)
+        leaf->keys[i] = INT_MAX;
+    leaf->count = 0;
+    leaf->next = NULL;
+    return leaf;
+}
+
+static bpt_inner *bpt_new_inner(void)
+{
+    bpt_inner *inner = malloc(sizeof(bpt_inner));
+    if (inner == NULL)
+        return NULL;
+    for (int i = 0; i < INNER_KEYS; i++)
+        inner->keys[i] = INT_MAX;
+    inner->count = 0;
+    return inner;
+}
+
+bptree *bptree_create(void)
+{
+    bptree *tree = malloc(sizeof(bptree));
+    if (tree == NULL)
+        return NULL;
+    tree->root = NULL;
+    tree->first = NULL;
+    tree->height = 0;
+    tree->length = 0;
+    return tree;
+}
+
+/*
+ * bpt_free_nodes
+ * ----------
+ * Frees a subtree of the given height.
+ */
+static void bpt_free_nodes(void *node, int height)
+{
+    if (height > 1)
+    {
+        bpt_inner *inner = node;
+        for (int i = 0; i <= inner->count; i++)
+            bpt_free_nodes(inner->children[i], height - 1);
+    }
+    free(node);
+}
+
+void bptree_destroy(bptree *tree)
+{
+    if (tree == NULL)
+        return;
+    if (tree->root != NULL)
+        bpt_free_nodes(tree->root, tree->height);
+    free(tree);
+}
+
+/*
+ * bpt_build_level
+ * ----------
+ * Builds the inner nodes over the count nodes (of the given height) of the level below,
+ * whose largest keys are in maxima, with up to INNER_KEYS + 1 children each. The last node
+ * takes a child from the one before it rather than have a single child. Replaces nodes
+ * and maxima with those of the new level and returns its node count.
+ * If out of memory, frees every node of both levels and returns 0.
+ */
+static size_t bpt_build_level(void **nodes, int *maxima, size_t count, int height)
+{
+    size_t fanout = INNER_KEYS + 1, parents = (count + fanout - 1) / fanout, start = 0;
+    for (size_t p = 0; p < parents; p++)
+    {
+        size_t children = count - start < fanout ? count - start : fanout;
+        if (p + 2 == parents && count - start - fanout == 1)
+            children--;
+
+        bpt_inner *inner = bpt_new_inner();
+        if (inner == NULL)
+        {
+            for (size_t q = 0; q < p; q++)
+                bpt_free_nodes(nodes[q], height + 1);
+            for (size_t q = start; q < count; q++)
+                bpt_free_nodes(nodes[q], height);
+            return 0;
+        }
+        inner->count = (int)children - 1;
+        for (size_t c = 0; c < children; c++)
+        {
+            inner->children[c] = nodes[start + c];
+            if (c + 1 < children)
+                inner->keys[c] = maxima[start + c];
+        }
+        maxima[p] = maxima[start + children - 1];
+        nodes[p] = inner;
+        start += children;
+    }
+    return parents;
+}
+
+/*
+ * bptree_build
+ * ----------
+ * Packs the values into full leaves, linked in order, then builds inner levels
+ * bottom-up until a single node is left: the root. With a leaf per LEAF_KEYS values
+ * the node and maxima arrays of the leaf level are the largest needed.
+ */
+bptree *bptree_build(const int *values, size_t n)
+{
+    if (values == NULL && n > 0)
+        return NULL;
+    for (size_t i = 1; i < n; i++)
+    {
+        if (values[i] < values[i - 1])
+        {
+            fprintf(stderr, "Error: bptree_build needs values in ascending order.\n");
+            return NULL;
+        }
+    }
+
+    bptree *tree = bptree_create();
+    if (tree == NULL || n == 0)
+        return tree;
+
+    size_t leaves = (n + LEAF_KEYS - 1) / LEAF_KEYS;
+    void **nodes = malloc(leaves * sizeof(void *));
+    int *maxima = malloc(leaves * sizeof(int));
+    size_t count = 0;
+    bool ok = nodes != NULL && maxima != NULL;
+
+    bpt_leaf *previous = NULL;
+    for (size_t i = 0; i < n && ok; i++)
+    {
+        if (previous != NULL && previous->keys[previous->count - 1] == values[i])
+            continue;
+        if (previous == NULL || previous->count == LEAF_KEYS)
+        {
+            bpt_leaf *leaf = bpt_new_leaf();
+            if (leaf == NULL)
+            {
+                ok = false;
+                break;
+            }
+            if (previous != NULL)
+                previous->next = leaf;
+            else
+                tree->first = leaf;
+            nodes[count++] = leaf;
+            previous = leaf;
+        }
+        previous->keys[previous->count++] = values[i];
+        maxima[count - 1] = values[i];
+        tree->length++;
+    }
+
+    if (!ok)
+    {
+        for (size_t i = 0; i < count; i++)
+            free(nodes[i]);
+        count = 0;
+    }
+    int height = 1;
+    while (count > 1)
+    {
+        count = bpt_build_level(nodes, maxima, count, height);
+        height++;
+    }
+    if (count == 1)
+    {
+        tree->root = nodes[0];
+        tree->height = height;
+    }
+
+    free(nodes);
+    free(maxima);
+    if (count == 0)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for tree nodes.\n");
+        free(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+/*
+ * bpt_find_leaf
+ * ----------
+ * Descends from the root to the leaf where val is or belongs.
+ * If path is not NULL, the inner nodes passed and the child taken in each are stored
+ * in path and slots, root first.
+ */
+static bpt_leaf *bpt_find_leaf(const bptree *tree, int val, bpt_inner **path, int *slots)
+{
+    void *node = tree->root;
+    for (int level = 0; level < tree->height - 1; level++)
+    {
+        bpt_inner *inner = node;
+        int slot = count_less(inner->keys, INNER_KEYS, val);
+        if (path != NULL)
+        {
+            path[level] = inner;
+            slots[level] = slot;
+        }
+        node = inner->children[slot];
+    }
+    return node;
+}
+
+/*
+ * bpt_split_leaf
+ * ----------
+ * Splits a full leaf into itself and right, a new empty leaf that becomes its right
+ * neighbour, and inserts val at position pos of the keys they hold together.
+ */
+static void bpt_split_leaf(bpt_leaf *leaf, bpt_leaf *right, int pos, int val)
+{
+    int mid = pos == LEAF_KEYS && leaf->next == NULL ? LEAF_KEYS : LEAF_KEYS / 2;
+    right->count = LEAF_KEYS - mid;
+    memcpy(right->keys, leaf->keys + mid, (size_t)right->count * sizeof(int));
+    for (int i = mid; i < LEAF_KEYS; i++)
+        leaf->keys[i] = INT_MAX;
+    leaf->count = mid;
+    right->next = leaf->next;
+    leaf->next = right;
+
+    bpt_leaf *target = pos < mid ? leaf : right;
+    if (target == right)
+        pos -= mid;
+    memmove(target->keys + pos + 1, target->keys + pos, (size_t)(target->count - pos) * sizeof(int));
+    target->keys[pos] = val;
+    target->count++;
+}
+
+/*
+ * bpt_insert_child
+ * ----------
+ * Inserts separator *key and its right child right into inner at slot, right after
+ * the child it was split from. A full node splits: its upper half moves to sibling,
+ * a new empty node, and the key to insert above the two is left in *key.
+ */
+static void bpt_insert_child(bpt_inner *inner, int slot, int *key, void *right, bpt_inner *sibling)
+{
+    if (inner->count < INNER_KEYS)
+    {
+        memmove(inner->keys + slot + 1, inner->keys + slot, (size_t)(inner->count - slot) * sizeof(int));
+        memmove(inner->children + slot + 2, inner->children + slot + 1,
+                (size_t)(inner->count - slot) * sizeof(void *));
+        inner->keys[slot] = *key;
+        inner->children[slot + 1] = right;
+        inner->count++;
+        return;
+    }
+
+    // The node as it would be with one more key: INNER_KEYS + 1 keys, INNER_KEYS + 2 children
+    int keys[INNER_KEYS + 1];
+    void *children[INNER_KEYS + 2];
+    memcpy(keys, inner->keys, (size_t)slot * sizeof(int));
+    keys[slot] = *key;
+    memcpy(keys + slot + 1, inner->keys + slot, (size_t)(INNER_KEYS - slot) * sizeof(int));
+    memcpy(children, inner->children, (size_t)(slot + 1) * sizeof(void *));
+    children[slot + 1] = right;
+    memcpy(children + slot + 2, inner->children + slot + 1, (size_t)(INNER_KEYS - slot) * sizeof(void *));
+
+    // Keys below mid stay, key mid moves up, the ones above go to the sibling
+    int mid = (INNER_KEYS + 1) / 2;
+    memcpy(inner->keys, keys, (size_t)mid * sizeof(int));
+    for (int i = mid; i < INNER_KEYS; i++)
+        inner->keys[i] = INT_MAX;
+    memcpy(inner->children, children, (size_t)(mid + 1) * sizeof(void *));
+    inner->count = mid;
+
+    sibling->count = INNER_KEYS - mid;
+    memcpy(sibling->keys, keys + mid + 1, (size_t)sibling->count * sizeof(int));
+    memcpy(sibling->children, children + mid + 1, (size_t)(sibling->count + 1) * sizeof(void *));
+    *key = keys[mid];
+}
+
+/*
+ * bptree_insert
+ * ----------
+ * Inserts into the leaf holding val's range. A split leaf hands its largest key and
+ * new neighbour to its parent, which may split in turn, up to a new root.
+ * Every node a split needs is allocated before the tree is touched, so running
+ * out of memory leaves the tree as it was.
+ */
+bool bptree_insert(bptree *tree, int val)
+{
+    if (tree == NULL)
+        return false;
+
+    if (tree->root == NULL)
+    {
+        bpt_leaf *leaf = bpt_new_leaf();
+        if (leaf == NULL)
+        {
+            fprintf(stderr, "Error: Failed to allocate memory for new tree node.\n");
+            return false;
+        }
+        leaf->keys[0] = val;
+        leaf->count = 1;
+        tree->root = tree->first = leaf;
+        tree->height = 1;
+        tree->length = 1;
+        return true;
+    }
+
+    bpt_inner *path[MAX_HEIGHT];
+    int slots[MAX_HEIGHT];
+    bpt_leaf *leaf = bpt_find_leaf(tree, val, path, slots);
+    int pos = count_less(leaf->keys, LEAF_KEYS, val);
+    if (pos < leaf->count && leaf->keys[pos] == val)
+        return true;
+
+    if (leaf->count < LEAF_KEYS)
+    {
+        memmove(leaf->keys + pos + 1, leaf->keys + pos, (size_t)(leaf->count - pos) * sizeof(int));
+        leaf->keys[pos] = val;
+        leaf->count++;
+        tree->length++;
+        return true;
+    }
+
+    // One new leaf, one new inner node per full ancestor, and a new root if they all are
+    int level = tree->height - 2;
+    while (level >= 0 && path[level]->count == INNER_KEYS)
+        level--;
+    int spares = tree->height - 2 - level + (level < 0 ? 1 : 0);
+    bpt_inner *spare[MAX_HEIGHT + 1];
+    bpt_leaf *new_leaf = bpt_new_leaf();
+    bool ok = new_leaf != NULL;
+    for (int i = 0; i < spares; i++)
+    {
+        spare[i] = ok ? bpt_new_inner() : NULL;
+        ok = ok && spare[i] != NULL;
+    }
+    if (!ok)
+    {
+        free(new_leaf);
+        for (int i = 0; i < spares; i++)
+            free(spare[i]);
+        fprintf(stderr, "Error: Failed to allocate memory for new tree node.\n");
+        return false;
+    }
+
+    bpt_split_leaf(leaf, new_leaf, pos, val);
+    tree->length++;
+
+    int key = leaf->keys[leaf->count - 1];
+    void *right = new_leaf;
+    int used = 0;
+    for (level = tree->height - 2; level >= 0; level--)
+    {
+        bool full = path[level]->count == INNER_KEYS;
+        bpt_insert_child(path[level], slots[level], &key, right, full ? spare[used] : NULL);
+        if (!full)
+            return true;
+        right = spare[used++];
+    }
+
+    bpt_inner *root = spare[used];
+    root->keys[0] = key;
+    root->count = 1;
+    root->children[0] = tree->root;
+    root->children[1] = right;
+    tree->root = root;
+    tree->height++;
+    return true;
+}
+
+bool bptree_contains(bptree *tree, int val)
+{
+    if (tree == NULL || tree->root == NULL)
+        return false;
+
+    const bpt_leaf *leaf = bpt_find_leaf(tree, val, NULL, NULL);
+    int pos = count_less(leaf->keys, LEAF_KEYS, val);
+    return pos < leaf->count && leaf->keys[pos] == val;
+}
+
+/*
+ * bptree_range
+ * ----------
+ * Finds the leaf where lo belongs, then follows the leaf links until a key above hi.
+ */
+size_t bptree_range(bptree *tree, int lo, int hi, void (*visit)(int val, void *ctx), void *ctx)
+{
+    if (tree == NULL || tree->root == NULL || visit == NULL || lo > hi)
+        return 0;
+
+    const bpt_leaf *leaf = bpt_find_leaf(tree, lo, NULL, NULL);
+    size_t count = 0;
+    for (int pos = count_less(leaf->keys, LEAF_KEYS, lo); leaf != NULL; leaf = leaf->next, pos = 0)
+    {
+        for (; pos < leaf->count; pos++)
+        {
+            if (leaf->keys[pos] > hi)
+                return count;
+            visit(leaf->keys[pos], ctx);
+            count++;
+        }
+    }
+    return count;
+}
+
+void bptree_walk(bptree *tree, void (*visit)(int val, void *ctx), void *ctx)
+{
+    if (tree == NULL || visit == NULL)
+        return;
+
+    for (const bpt_leaf *leaf = tree->first; leaf != NULL; leaf = leaf->next)
+    {
+        for (int pos = 0; pos < leaf->count; pos++)
+            visit(leaf->keys[pos], ctx);
+    }
+}
+
+static void bpt_print_value(int val, void *ctx)
+{
+    (void)ctx;
+    printf("%d\n", val);
+}
+
+void bptree_print_sorted(bptree *tree)
+{
+    bptree_walk(tree, bpt_print_value, NULL);
+}
+
+size_t bptree_length(bptree *tree)
+{
+    return tree != NULL ? tree->length : 0;
+}
+
+int bptree_height(bptree *tree)
+{
+    return tree != NULL ? tree->height : 0;
+}
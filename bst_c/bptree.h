@@ -0,0 +1,55 @@
+#ifndef BPTREE_H
+#define BPTREE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/*
+ * B+tree of ints: an ordered set with wide nodes.
+ * Inner nodes hold up to 32 keys and leaves up to 64, so a lookup in millions of values
+ * visits 4 or 5 nodes instead of the 20+ of a binary tree, and searches each of them
+ * with SIMD compares. Values live in the leaves, which are linked in ascending order
+ * for in-order walks and range scans.
+ */
+
+typedef struct bptree bptree;
+
+/** Create an empty tree, or NULL if out of memory */
+bptree *bptree_create(void);
+
+/** Build a tree of the n values, which must be in ascending order (repeated values are
+ *  stored once), in O(n): leaves are filled completely from left to right, then each level
+ *  of inner nodes over the one below. More values can be inserted afterwards.
+ *  Return NULL if the values aren't sorted or out of memory.
+ */
+bptree *bptree_build(const int *values, size_t n);
+
+/** Free the tree and all its nodes */
+void bptree_destroy(bptree *tree);
+
+/** Insert val. A value that is already in the tree is left as it is.
+ *  Return false if out of memory.
+ */
+bool bptree_insert(bptree *tree, int val);
+
+/** Return true if val is in the tree */
+bool bptree_contains(bptree *tree, int val);
+
+/** Call visit(val, ctx) on every value in [lo, hi], in ascending order, and return
+ *  how many there were. visit must not modify the tree.
+ */
+size_t bptree_range(bptree *tree, int lo, int hi, void (*visit)(int val, void *ctx), void *ctx);
+
+/** Call visit(val, ctx) on every value, in ascending order. visit must not modify the tree. */
+void bptree_walk(bptree *tree, void (*visit)(int val, void *ctx), void *ctx);
+
+/** Print every value in ascending order, one per line */
+void bptree_print_sorted(bptree *tree);
+
+/** Number of values in the tree */
+size_t bptree_length(bptree *tree);
+
+/** Height of the tree: the number of nodes a lookup visits, leaf included, 0 when empty */
+int bptree_height(bptree *tree);
+
+#endif
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "bst32.h"
+
+/*
+ * Index-linked Binary Search Tree
+ *
+ * Usage:
+ * bst32 *tree = bst32_create(0);
+ * bst32_add(tree, 10);
+ * bool found = bst32_contains(tree, 10);
+ * bst32_destroy(tree);
+ *
+ * Nodes live in one array that doubles when full. Links are indexes into it rather
+ * than addresses, so growing it with realloc moves the nodes without breaking
+ * the tree. Index 0 is the null link: node 0 is never used and the root is node 1.
+ */
+
+// --- Initial Capacity ---
+#define INITIAL_CAPACITY 256
+#define MAX_NODES UINT32_MAX
+
+// --- Tree Node ---
+struct bst32_node
+{
+    int val;
+    uint32_t left, right; // Indexes of the children, 0 for none
+};
+
+// --- Tree Structure ---
+struct bst32
+{
+    struct bst32_node *nodes;
+    size_t capacity; // Nodes allocated, node 0 included
+    size_t used;     // Nodes in use, node 0 included
+};
+
+bst32 *bst32_create(size_t capacity)
+{
+    if (capacity >= MAX_NODES)
+    {
+        fprintf(stderr, "Error: Tree capacity overflow.\n");
+        return NULL;
+    }
+    capacity = capacity > 0 ? capacity + 1 : INITIAL_CAPACITY;
+
+    bst32 *tree = malloc(sizeof(bst32));
+    if (tree == NULL)
+        return NULL;
+    tree->nodes = malloc(capacity * sizeof(struct bst32_node));
+    if (tree->nodes == NULL)
+    {
+        free(tree);
+        return NULL;
+    }
+    tree->capacity = capacity;
+    tree->used = 1;
+    return tree;
+}
+
+void bst32_destroy(bst32 *tree)
+{
+    if (tree == NULL)
+        return;
+    free(tree->nodes);
+    free(tree);
+}
+
+/*
+ * bst32_grow
+ * ----------
+ * Doubles the node array, up to MAX_NODES nodes.
+ * Returns false if out of memory or the tree is full.
+ */
+static bool bst32_grow(bst32 *tree)
+{
+    size_t capacity = tree->capacity * 2;
+    if (capacity > MAX_NODES)
+        capacity = MAX_NODES;
+    if (capacity == tree->capacity)
+    {
+        fprintf(stderr, "Error: Tree is full.\n");
+        return false;
+    }
+
+    struct bst32_node *nodes = realloc(tree->nodes, capacity * sizeof(struct bst32_node));
+    if (nodes == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for tree nodes.\n");
+        return false;
+    }
+    tree->nodes = nodes;
+    tree->capacity = capacity;
+    return true;
+}
+
+/*
+ * bst32_add
+ * ----------
+ * Takes the next free node of the array and links it in as add does.
+ */
+bool bst32_add(bst32 *tree, int val)
+{
+    if (tree == NULL)
+        return false;
+    if (tree->used == tree->capacity && !bst32_grow(tree))
+        return false;
+
+    uint32_t index = (uint32_t)tree->used++;
+    struct bst32_node *nodes = tree->nodes;
+    nodes[index].val = val;
+    nodes[index].left = nodes[index].right = 0;
+    if (index == 1)
+        return true;
+
+    uint32_t *link;
+    uint32_t node = 1;
+    while (1)
+    {
+        link = val < nodes[node].val ? &nodes[node].left : &nodes[node].right;
+        if (*link == 0)
+            break;
+        node = *link;
+    }
+    *link = index;
+    return true;
+}
+
+bool bst32_contains(bst32 *tree, int val)
+{
+    if (tree == NULL || tree->used == 1)
+        return false;
+
+    const struct bst32_node *nodes = tree->nodes;
+    uint32_t node = 1;
+    while (node != 0 && nodes[node].val != val)
+        node = val < nodes[node].val ? nodes[node].left : nodes[node].right;
+    return node != 0;
+}
+
+size_t bst32_length(bst32 *tree)
+{
+    return tree != NULL ? tree->used - 1 : 0;
+}
+
+/*
+ * bst32_walk
+ * ----------
+ * In-order traversal with an explicit stack of the nodes whose left subtree is being
+ * walked. The stack starts small and doubles as needed: it only gets deep on degenerate trees.
+ */
+bool bst32_walk(bst32 *tree, void (*visit)(int val, void *ctx), void *ctx)
+{
+    if (tree == NULL || visit == NULL)
+        return false;
+
+    const struct bst32_node *nodes = tree->nodes;
+    size_t size = 64, depth = 0;
+    uint32_t *stack = malloc(size * sizeof(uint32_t));
+    if (stack == NULL)
+        return false;
+
+    uint32_t node = tree->used > 1 ? 1 : 0;
+    while (node != 0 || depth > 0)
+    {
+        while (node != 0)
+        {
+            if (depth == size)
+            {
+                uint32_t *larger = realloc(stack, size * 2 * sizeof(uint32_t));
+                if (larger == NULL)
+                {
+                    free(stack);
+                    return false;
+                }
+                stack = larger;
+                size *= 2;
+            }
+            stack[depth++] = node;
+            node = nodes[node].left;
+        }
+        node = stack[--depth];
+        visit(nodes[node].val, ctx);
+        node = nodes[node].right;
+    }
+    free(stack);
+    return true;
+}
+
+static void bst32_print_value(int val, void *ctx)
+{
+    (void)ctx;
+    printf("%d\n", val);
+}
+
+bool bst32_print_sorted(bst32 *tree)
+{
+    return bst32_walk(tree, bst32_print_value, NULL);
+}
@@ -0,0 +1,44 @@
+#ifndef BST32_H
+#define BST32_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Compact plain binary search tree of ints: the same tree as add builds (smaller values
+ * left, equal ones right, no rebalancing), with its nodes in one array linked by 32-bit
+ * indexes instead of pointers. A node takes 12 bytes instead of 24 (plus the malloc
+ * header of each separately allocated one), and the whole tree is freed at once.
+ * It holds up to UINT32_MAX - 1 values.
+ */
+
+typedef struct bst32 bst32;
+
+/** Create an empty tree with room for capacity values (0 for a default) before it grows,
+ *  or NULL if out of memory
+ */
+bst32 *bst32_create(size_t capacity);
+
+/** Free the tree: one array, whatever the number of values */
+void bst32_destroy(bst32 *tree);
+
+/** Add val. Return false if out of memory or full. */
+bool bst32_add(bst32 *tree, int val);
+
+/** Return true if val is in the tree */
+bool bst32_contains(bst32 *tree, int val);
+
+/** Number of values in the tree */
+size_t bst32_length(bst32 *tree);
+
+/** Call visit(val, ctx) on every value, in ascending order.
+ *  Uses an explicit stack, so degenerate (sorted input) trees are fine.
+ *  Return false if out of memory for the stack.
+ */
+bool bst32_walk(bst32 *tree, void (*visit)(int val, void *ctx), void *ctx);
+
+/** Print every value in ascending order, one per line */
+bool bst32_print_sorted(bst32 *tree);
+
+#endif
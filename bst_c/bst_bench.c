@@ -0,0 +1,448 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "binary_tree.h"
+#include "avl.h"
+#include "bst32.h"
+#include "bptree.h"
+#include "node_pool.h"
+
+/*
+ * Binary search tree benchmark
+ *
+ * Compares the plain tree (add), the AVL tree and the B+tree on sorted, reverse-sorted
+ * and random input:
+ * gcc -O2 -o bst_bench bst_bench.c binary_tree.c avl.c bst32.c bptree.c
+ *
+ * Usage: ./bst_bench [number of values] [plain tree limit]
+ * Defaults to 1000000 values. Sorted input makes the plain tree a linked list, where
+ * n inserts cost O(n^2): on sorted and reverse input it only gets the first
+ * [plain tree limit] values (20000 by default), and its per-insert cost still
+ * grows linearly with that limit.
+ * Each line reports the time per insert, per lookup (of every value inserted),
+ * and per removal for the AVL tree, along with the height of the tree built: the
+ * number of nodes the deepest lookup visits. The B+tree also reports range scans of
+ * 100 consecutive values starting at random positions, per value scanned.
+ * On sorted input, the "build" and "bpbuild" lines time the O(n) bulk loaders
+ * build_sorted and bptree_build instead of n inserts ("insert" is per value).
+ *
+ * The random values then go into the same plain tree built three ways: nodes from
+ * malloc (add), from a node_pool (add_pooled), and in a bst32 array of 12-byte
+ * index-linked nodes. Each line reports the time per insert, per value of an
+ * in-order walk, and per value to release the whole tree. Last, the tree is written
+ * out in order with one fprintf per value, then with the buffered write_sorted.
+ */
+
+typedef enum
+{
+    ORDER_SORTED,
+    ORDER_REVERSE,
+    ORDER_RANDOM
+} input_order;
+
+static const char *order_names[] = {"sorted", "reverse", "random"};
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: cheap reproducible random numbers
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/*
+ * make_values
+ * ----------
+ * Returns the values 0..n-1 in the given order (random: a seeded shuffle).
+ */
+static int *make_values(size_t n, input_order order)
+{
+    int *values = malloc(n * sizeof(int));
+    if (values == NULL)
+        return NULL;
+    for (size_t i = 0; i < n; i++)
+        values[i] = order == ORDER_REVERSE ? (int)(n - 1 - i) : (int)i;
+
+    if (order == ORDER_RANDOM)
+    {
+        uint64_t state = 0x9e3779b97f4a7c15ULL;
+        for (size_t i = n - 1; i > 0; i--)
+        {
+            size_t j = (size_t)(next_random(&state) % (i + 1));
+            int tmp = values[i];
+            values[i] = values[j];
+            values[j] = tmp;
+        }
+    }
+    return values;
+}
+
+/*
+ * plain_height
+ * ----------
+ * Height of a plain tree of n nodes, walked level by level (it may be n levels deep).
+ */
+static int plain_height(struct node *root, size_t n)
+{
+    struct node **level = malloc(n * sizeof(struct node *));
+    struct node **next = malloc(n * sizeof(struct node *));
+    int height = 0;
+    size_t count = root != NULL ? 1 : 0;
+    if (level == NULL || next == NULL)
+        count = 0;
+    else if (count > 0)
+        level[0] = root;
+
+    while (count > 0)
+    {
+        size_t next_count = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (level[i]->left != NULL)
+                next[next_count++] = level[i]->left;
+            if (level[i]->right != NULL)
+                next[next_count++] = level[i]->right;
+        }
+        struct node **tmp = level;
+        level = next;
+        next = tmp;
+        count = next_count;
+        height++;
+    }
+    free(level);
+    free(next);
+    return height;
+}
+
+static void report(const char *tree, input_order order, size_t n, double insert, double lookup, double removal,
+                   int height)
+{
+    printf("%-7s %-8s %10zu values  insert %9.1f ns  find %9.1f ns", tree, order_names[order], n, insert * 1e9 / (double)n,
+           lookup * 1e9 / (double)n);
+    if (removal >= 0)
+        printf("  remove %7.1f ns", removal * 1e9 / (double)n);
+    printf("  height %d\n", height);
+}
+
+static void sum_value(int val, void *ctx)
+{
+    *(uint64_t *)ctx += (uint64_t)val;
+}
+
+static bool run_plain(const int *values, size_t n, input_order order)
+{
+    struct node *root = NULL;
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!add_checked(&root, values[i]))
+        {
+            free_tree(root);
+            return false;
+        }
+    }
+    double insert = now_sec() - start;
+
+    size_t found = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        found += find(root, values[i]) != NULL;
+    double lookup = now_sec() - start;
+
+    report("plain", order, n, insert, lookup, -1, plain_height(root, n));
+    free_tree(root);
+    return found == n;
+}
+
+static bool run_avl(const int *values, size_t n, input_order order)
+{
+    avl *tree = avl_create();
+    if (tree == NULL)
+        return false;
+
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!avl_insert(tree, values[i]))
+            return false;
+    }
+    double insert = now_sec() - start;
+
+    size_t found = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        found += avl_contains(tree, values[i]);
+    double lookup = now_sec() - start;
+    int height = avl_height(tree);
+
+    size_t removed = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        removed += avl_remove(tree, values[i]);
+    double removal = now_sec() - start;
+
+    report("avl", order, n, insert, lookup, removal, height);
+    avl_destroy(tree);
+    return found == n && removed == n;
+}
+
+
+#define RANGE_WIDTH 100
+
+static bool run_bptree(const int *values, size_t n, input_order order)
+{
+    bptree *tree = bptree_create();
+    if (tree == NULL)
+        return false;
+
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!bptree_insert(tree, values[i]))
+            return false;
+    }
+    double insert = now_sec() - start;
+
+    size_t found = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        found += bptree_contains(tree, values[i]);
+    double lookup = now_sec() - start;
+    report("bptree", order, n, insert, lookup, -1, bptree_height(tree));
+
+    // The values are 0..n-1, so a range starting at a random value holds up to RANGE_WIDTH of them
+    size_t ranges = n < 100000 ? n : 100000, scanned = 0;
+    uint64_t sum = 0;
+    start = now_sec();
+    for (size_t i = 0; i < ranges; i++)
+        scanned += bptree_range(tree, values[i], values[i] + RANGE_WIDTH - 1, sum_value, &sum);
+    double scan = now_sec() - start;
+    printf("%-7s %-8s %10zu ranges  scan %7.2f ns/value  %.1f values/range\n", "bptree", order_names[order], ranges,
+           scan * 1e9 / (double)scanned, (double)scanned / (double)ranges);
+
+    bptree_destroy(tree);
+    return found == n && scanned > 0;
+}
+
+/*
+ * run_build
+ * ----------
+ * Builds trees of the n sorted values with the O(n) bulk loaders, build_sorted (plain
+ * tree in a node pool) and bptree_build, and looks every value up in them.
+ * Returns false if a build fails or a lookup misses.
+ */
+static bool run_build(const int *values, size_t n)
+{
+    node_pool pool = {0};
+    double start = now_sec();
+    struct node *root = build_sorted(&pool, values, n);
+    double build = now_sec() - start;
+    if (root == NULL)
+        return false;
+    size_t found = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        found += find(root, values[i]) != NULL;
+    report("build", ORDER_SORTED, n, build, now_sec() - start, -1, plain_height(root, n));
+    node_pool_free(&pool);
+
+    start = now_sec();
+    bptree *tree = bptree_build(values, n);
+    build = now_sec() - start;
+    if (tree == NULL)
+        return false;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        found += bptree_contains(tree, values[i]);
+    report("bpbuild", ORDER_SORTED, n, build, now_sec() - start, -1, bptree_height(tree));
+    bptree_destroy(tree);
+    return found == 2 * n;
+}
+
+static void report_allocator(const char *name, size_t n, double insert, double walk, double release)
+{
+    printf("%-7s %-8s %10zu values  insert %9.1f ns  walk %7.2f ns  release %7.2f ns\n", name,
+           order_names[ORDER_RANDOM], n, insert * 1e9 / (double)n, walk * 1e9 / (double)n, release * 1e9 / (double)n);
+}
+
+/*
+ * run_allocators
+ * ----------
+ * Builds the plain tree of the n values 0..n-1 (in random order) with malloc'ed nodes,
+ * pooled nodes and as a bst32, and walks and releases each one.
+ * Returns false if a build fails or a walk doesn't add up to the sum of the values.
+ */
+static bool run_allocators(const int *values, size_t n)
+{
+    uint64_t expected = (uint64_t)n * (n - 1) / 2, sum = 0;
+
+    struct node *root = NULL;
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!add_checked(&root, values[i]))
+        {
+            free_tree(root);
+            return false;
+        }
+    }
+    double insert = now_sec() - start;
+    start = now_sec();
+    walk_sorted(root, sum_value, &sum);
+    double walk = now_sec() - start;
+    start = now_sec();
+    free_tree(root);
+    report_allocator("malloc", n, insert, walk, now_sec() - start);
+    if (sum != expected)
+        return false;
+
+    node_pool pool = {0};
+    root = NULL;
+    sum = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!add_pooled_checked(&pool, &root, values[i]))
+        {
+            node_pool_free(&pool);
+            return false;
+        }
+    }
+    insert = now_sec() - start;
+    start = now_sec();
+    walk_sorted(root, sum_value, &sum);
+    walk = now_sec() - start;
+    start = now_sec();
+    node_pool_free(&pool);
+    report_allocator("pool", n, insert, walk, now_sec() - start);
+    if (sum != expected)
+        return false;
+
+    bst32 *tree = bst32_create(0);
+    sum = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!bst32_add(tree, values[i]))
+            return false;
+    }
+    insert = now_sec() - start;
+    start = now_sec();
+    bool walked = bst32_walk(tree, sum_value, &sum);
+    walk = now_sec() - start;
+    start = now_sec();
+    bst32_destroy(tree);
+    report_allocator("bst32", n, insert, walk, now_sec() - start);
+    return walked && sum == expected;
+}
+
+/*
+ * run_output
+ * ----------
+ * Builds the plain tree of the n values (in random order) and writes them out sorted to
+ * /dev/null (a temporary file where there is none): once with one fprintf per value
+ * through bst_next, as the old recursive print_sorted did with printf, then with write_sorted.
+ * Returns false if a build or a write fails.
+ */
+static bool run_output(const int *values, size_t n)
+{
+    FILE *sink = fopen("/dev/null", "w");
+    if (sink == NULL)
+        sink = tmpfile();
+    node_pool pool = {0};
+    struct node *root = NULL;
+    for (size_t i = 0; i < n && sink != NULL; i++)
+    {
+        if (!add_pooled_checked(&pool, &root, values[i]))
+        {
+            node_pool_free(&pool);
+            fclose(sink);
+            return false;
+        }
+    }
+    if (sink == NULL)
+        return false;
+
+    bool ok = true;
+    double start = now_sec();
+    bst_it it = bst_iterator(root);
+    while (bst_next(&it))
+        ok &= fprintf(sink, "%d\n", it.val) > 0;
+    double per_value = now_sec() - start;
+
+    start = now_sec();
+    ok &= write_sorted(root, sink);
+    double buffered = now_sec() - start;
+    printf("%-7s %-8s %10zu values  fprintf %7.2f ns/value  write_sorted %7.2f ns/value\n", "output",
+           order_names[ORDER_RANDOM], n, per_value * 1e9 / (double)n, buffered * 1e9 / (double)n);
+
+    fclose(sink);
+    node_pool_free(&pool);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    size_t plain_limit = argc > 2 ? strtoull(argv[2], NULL, 10) : 20000;
+    if (n == 0 || n > INT32_MAX)
+    {
+        fprintf(stderr, "Error: the number of values must be between 1 and %d.\n", INT32_MAX);
+        return 1;
+    }
+
+    for (input_order order = ORDER_SORTED; order <= ORDER_RANDOM; order++)
+    {
+        int *values = make_values(n, order);
+        if (values == NULL)
+        {
+            fprintf(stderr, "Error: out of memory.\n");
+            return 1;
+        }
+
+        size_t plain_n = order == ORDER_RANDOM || n < plain_limit ? n : plain_limit;
+        if (plain_n > 0 && !run_plain(values, plain_n, order))
+        {
+            fprintf(stderr, "Error: plain tree returned wrong results.\n");
+            return 1;
+        }
+        if (!run_avl(values, n, order))
+        {
+            fprintf(stderr, "Error: AVL tree returned wrong results.\n");
+            return 1;
+        }
+        if (!run_bptree(values, n, order))
+        {
+            fprintf(stderr, "Error: B+tree returned wrong results.\n");
+            return 1;
+        }
+        if (order == ORDER_SORTED && !run_build(values, n))
+        {
+            fprintf(stderr, "Error: bulk-built trees returned wrong results.\n");
+            return 1;
+        }
+        if (order == ORDER_RANDOM && !run_allocators(values, n))
+        {
+            fprintf(stderr, "Error: node allocator comparison returned wrong results.\n");
+            return 1;
+        }
+        if (order == ORDER_RANDOM && !run_output(values, n))
+        {
+            fprintf(stderr, "Error: sorted output failed.\n");
+            return 1;
+        }
+        free(values);
+    }
+    return 0;
+}
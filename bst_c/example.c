@@ -0,0 +1,28 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "binary_tree.h"
+
+/*
+ * Inserts a few values and prints them in sorted order:
+ * gcc -o example example.c binary_tree.c
+ */
+
+int main(void)
+{
+    const int values[] = {10, 5, 120, 40, 33, 2, 11, 23};
+    struct node *root = NULL;
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        // root = add(root, values[i]) works too, but wouldn't tell if a value was dropped
+        if (!add_checked(&root, values[i]))
+        {
+            free_tree(root);
+            return 1;
+        }
+    }
+
+    print_sorted(root);
+    free_tree(root);
+    return 0;
+}
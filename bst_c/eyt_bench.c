@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "binary_tree.h"
+#include "node_pool.h"
+#include "eytzinger.h"
+
+/*
+ * Lower-bound search benchmark
+ *
+ * Compares the Eytzinger index with binary search over the sorted array and with the
+ * pointer tree holding the same values:
+ * gcc -O2 -o eyt_bench eyt_bench.c eytzinger.c binary_tree.c
+ *
+ * Usage: ./eyt_bench [max=<values>] [tree=<values>] [queries=<count>]
+ * Runs sizes of 1000, 10000 ... up to max values (10000000 by default). The values are
+ * the even numbers 0, 2 ... 2(n - 1), and every size runs the same number of random
+ * lower-bound queries (2000000 by default) over [-1, 2n], so about half hit a value.
+ * The pointer tree is the balanced one build_sorted makes, its best shape and layout.
+ * At 24 bytes a node it is only built up to tree values (100000000 by default).
+ * max=1000000000 takes about 8 GB for the array and the index, with tree=0.
+ * Each line reports ns per query; the structures must agree on every answer.
+ */
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: cheap reproducible random numbers
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/*
+ * binary_lower_bound
+ * ----------
+ * Textbook binary search: returns the index of the first of the n sorted values >= x, or n.
+ */
+static size_t binary_lower_bound(const int *values, size_t n, int x)
+{
+    size_t lo = 0, hi = n;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (values[mid] < x)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void report(const char *name, size_t n, size_t queries, double seconds)
+{
+    printf("%-10s %12zu values %10.2f ns/query\n", name, n, seconds * 1e9 / (double)queries);
+}
+
+/*
+ * run_size
+ * ----------
+ * Times the queries against every structure holding the n values.
+ * Returns false if a build fails or the answers differ (compared through a checksum:
+ * the sum of the lower bounds found, with -1 for none).
+ */
+static bool run_size(const int *values, size_t n, const int *queries, size_t count, size_t tree_max)
+{
+    int64_t expected = 0, sum = 0;
+    double start = now_sec();
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t pos = binary_lower_bound(values, n, queries[i]);
+        expected += pos < n ? values[pos] : -1;
+    }
+    report("binary", n, count, now_sec() - start);
+
+    eyt *index = eyt_build(values, n);
+    if (index == NULL)
+        return false;
+    start = now_sec();
+    for (size_t i = 0; i < count; i++)
+    {
+        int found;
+        sum += eyt_lower_bound(index, queries[i], &found) ? found : -1;
+    }
+    report("eytzinger", n, count, now_sec() - start);
+    eyt_destroy(index);
+    if (sum != expected)
+        return false;
+
+    if (n > tree_max)
+        return true;
+    node_pool pool = {0};
+    struct node *root = build_sorted(&pool, values, n);
+    if (root == NULL)
+        return false;
+    sum = 0;
+    start = now_sec();
+    for (size_t i = 0; i < count; i++)
+    {
+        struct node *found = find_lower_bound(root, queries[i]);
+        sum += found != NULL ? found->val : -1;
+    }
+    report("tree", n, count, now_sec() - start);
+    node_pool_free(&pool);
+    return sum == expected;
+}
+
+int main(int argc, char **argv)
+{
+    size_t max = 10000000, tree_max = 100000000, count = 2000000;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "max=", 4) == 0)
+            max = strtoull(argv[i] + 4, NULL, 10);
+        else if (strncmp(argv[i], "tree=", 5) == 0)
+            tree_max = strtoull(argv[i] + 5, NULL, 10);
+        else if (strncmp(argv[i], "queries=", 8) == 0)
+            count = strtoull(argv[i] + 8, NULL, 10);
+        else
+        {
+            fprintf(stderr, "Error: unknown option '%s'.\n", argv[i]);
+            return 1;
+        }
+    }
+    if (max > INT32_MAX / 2 || count == 0)
+    {
+        fprintf(stderr, "Error: max must be at most %d and queries at least 1.\n", INT32_MAX / 2);
+        return 1;
+    }
+
+    int *values = malloc(max * sizeof(int));
+    int *queries = malloc(count * sizeof(int));
+    if (values == NULL || queries == NULL)
+    {
+        fprintf(stderr, "Error: out of memory.\n");
+        return 1;
+    }
+    for (size_t i = 0; i < max; i++)
+        values[i] = (int)(2 * i);
+
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    for (size_t n = 1000; n <= max; n *= 10)
+    {
+        for (size_t i = 0; i < count; i++)
+            queries[i] = (int)(next_random(&state) % (2 * n + 2)) - 1;
+        if (!run_size(values, n, queries, count, tree_max))
+        {
+            fprintf(stderr, "Error: searches at %zu values failed or disagree.\n", n);
+            return 1;
+        }
+    }
+
+    free(queries);
+    free(values);
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "eytzinger.h"
+
+/*
+ * Eytzinger Search Index
+ *
+ * Usage:
+ * eyt *index = eyt_build(sorted, n);
+ * int value;
+ * if (eyt_lower_bound(index, 42, &value)) ... // smallest value >= 42
+ * eyt_destroy(index);
+ *
+ * The array is 1-based (slot 0 is unused) and aligned to a cache line, so slots
+ * 16k .. 16k + 15, the descendants of slot k four levels down, fill exactly one line.
+ * A lookup moves from k to 2k + (slot k < x) without a branch, for as many levels
+ * as the tree has, then undoes the right turns taken after its last left turn to
+ * find the slot where it went left for the last time: the lower bound.
+ */
+
+// --- Cache Line ---
+#define CACHE_LINE 64
+#define SLOTS_PER_LINE (CACHE_LINE / (size_t)sizeof(int))
+
+#if defined(__GNUC__)
+#define EYT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define EYT_PREFETCH(addr) ((void)(addr))
+#endif
+
+// --- Index Structure ---
+struct eyt
+{
+    int *slots;    // slots[1..length] hold the values in breadth-first order
+    size_t length; // Number of values
+};
+
+/*
+ * eyt_fill
+ * ----------
+ * Stores values in the subtree of slot k by an in-order walk over it, taking the
+ * next of the sorted values at every slot: the array then holds them in search-tree order.
+ * The recursion is as deep as the tree, about log2(n).
+ */
+static const int *eyt_fill(int *slots, size_t length, size_t k, const int *values)
+{
+    if (k > length)
+        return values;
+    values = eyt_fill(slots, length, 2 * k, values);
+    slots[k] = *values++;
+    return eyt_fill(slots, length, 2 * k + 1, values);
+}
+
+eyt *eyt_build(const int *values, size_t n)
+{
+    if (values == NULL && n > 0)
+        return NULL;
+    for (size_t i = 1; i < n; i++)
+    {
+        if (values[i] < values[i - 1])
+        {
+            fprintf(stderr, "Error: eyt_build needs values in ascending order.\n");
+            return NULL;
+        }
+    }
+    if (n >= (SIZE_MAX - CACHE_LINE) / sizeof(int))
+    {
+        fprintf(stderr, "Error: Index size overflow.\n");
+        return NULL;
+    }
+
+    eyt *index = malloc(sizeof(eyt));
+    if (index == NULL)
+        return NULL;
+    // Round up to whole lines, as aligned_alloc requires, and so that prefetches stay inside
+    size_t bytes = ((n + 1) * sizeof(int) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    index->slots = aligned_alloc(CACHE_LINE, bytes);
+    if (index->slots == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for the index.\n");
+        free(index);
+        return NULL;
+    }
+    index->length = n;
+    eyt_fill(index->slots, n, 1, values);
+    return index;
+}
+
+typedef struct
+{
+    int *values;
+    size_t count, size;
+} eyt_collect;
+
+static void eyt_collect_value(int val, void *ctx)
+{
+    eyt_collect *collect = ctx;
+    if (collect->values == NULL)
+        return;
+    if (collect->count == collect->size)
+    {
+        size_t size = collect->size > 0 ? collect->size * 2 : 1024;
+        int *values = realloc(collect->values, size * sizeof(int));
+        if (values == NULL)
+        {
+            free(collect->values);
+            collect->values = NULL;
+            return;
+        }
+        collect->values = values;
+        collect->size = size;
+    }
+    collect->values[collect->count++] = val;
+}
+
+/*
+ * eyt_from_tree
+ * ----------
+ * Collects the tree's values with an in-order walk, which yields them sorted, and builds from them.
+ */
+eyt *eyt_from_tree(struct node *root)
+{
+    eyt_collect collect = {malloc(1024 * sizeof(int)), 0, 1024};
+    if (collect.values == NULL || !walk_sorted(root, eyt_collect_value, &collect) || collect.values == NULL)
+    {
+        free(collect.values);
+        fprintf(stderr, "Error: Failed to allocate memory for the index.\n");
+        return NULL;
+    }
+    eyt *index = eyt_build(collect.values, collect.count);
+    free(collect.values);
+    return index;
+}
+
+void eyt_destroy(eyt *index)
+{
+    if (index == NULL)
+        return;
+    free(index->slots);
+    free(index);
+}
+
+/*
+ * eyt_search
+ * ----------
+ * Returns the slot of the smallest value >= x, or 0 if there is none.
+ * The descent reads slot k and prefetches the line of its descendants four levels
+ * down (slot 16k), which the loop reaches four iterations later. Near the bottom,
+ * where that line would lie past the array, it prefetches slot 0 (already cached) instead.
+ * At the end k encodes the path taken, one bit per level with 1 for a right turn:
+ * shifting out the trailing right turns and the left turn before them gives the
+ * slot of that last left turn, the one holding the lower bound.
+ */
+static inline size_t eyt_search(const eyt *index, int x)
+{
+    const int *slots = index->slots;
+    size_t length = index->length, k = 1;
+    while (k <= length)
+    {
+        size_t ahead = SLOTS_PER_LINE * k;
+        EYT_PREFETCH(slots + (ahead <= length ? ahead : 0));
+        k = 2 * k + (size_t)(slots[k] < x);
+    }
+#if defined(__GNUC__)
+    k >>= __builtin_ctzll(~(unsigned long long)k) + 1;
+#else
+    while (k & 1)
+        k >>= 1;
+    k >>= 1;
+#endif
+    return k;
+}
+
+bool eyt_lower_bound(eyt *index, int x, int *result)
+{
+    if (index == NULL)
+        return false;
+    size_t k = eyt_search(index, x);
+    if (k == 0)
+        return false;
+    if (result != NULL)
+        *result = index->slots[k];
+    return true;
+}
+
+bool eyt_contains(eyt *index, int x)
+{
+    if (index == NULL)
+        return false;
+    size_t k = eyt_search(index, x);
+    return k != 0 && index->slots[k] == x;
+}
+
+size_t eyt_length(eyt *index)
+{
+    return index != NULL ? index->length : 0;
+}
@@ -0,0 +1,43 @@
+#ifndef EYTZINGER_H
+#define EYTZINGER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "binary_tree.h"
+
+/*
+ * Static search index of ints in Eytzinger (breadth-first) order.
+ * The values of a perfectly balanced search tree, stored level by level in one array with
+ * no pointers: the children of slot k are slots 2k and 2k + 1. A lookup reads one int per
+ * level, the top levels share a few cache lines that stay cached, and the descendants four
+ * levels down share one cache line, which is prefetched while the levels between are read.
+ * The index is read-only: rebuild it to change its values.
+ */
+
+typedef struct eyt eyt;
+
+/** Build an index of the n values, which must be in ascending order, in O(n).
+ *  Return NULL if the values aren't sorted or out of memory.
+ */
+eyt *eyt_build(const int *values, size_t n);
+
+/** Build an index of the values held by a plain tree (see binary_tree.h).
+ *  Return NULL if out of memory.
+ */
+eyt *eyt_from_tree(struct node *root);
+
+/** Free the index */
+void eyt_destroy(eyt *index);
+
+/** Find the smallest value >= x. Store it in *result and return true, or return false
+ *  if every value is smaller than x.
+ */
+bool eyt_lower_bound(eyt *index, int x, int *result);
+
+/** Return true if x is in the index */
+bool eyt_contains(eyt *index, int x);
+
+/** Number of values in the index */
+size_t eyt_length(eyt *index);
+
+#endif
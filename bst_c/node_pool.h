@@ -0,0 +1,137 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "binary_tree.h"
+
+/*
+ * Slab allocator for the nodes of a plain tree (see add_pooled).
+ * Nodes are handed out back to back from slabs that double in size, so a tree's
+ * nodes sit next to each other in memory and cost no malloc header each.
+ * Nothing is freed individually: node_pool_free releases every slab at once,
+ * so tearing down a tree costs one free per slab (a few dozen at most) instead of one per node.
+ *
+ * Usage:
+ * node_pool pool = {0};
+ * struct node *root = NULL;
+ * root = add_pooled(&pool, root, 10);
+ * node_pool_free(&pool); // the whole tree is gone
+ */
+
+// Nodes in the first slab; every following slab holds twice as many, up to the maximum.
+#define NODE_POOL_MIN_SLAB 256
+#define NODE_POOL_MAX_SLAB (1 << 20)
+
+typedef struct node_slab
+{
+    struct node_slab *next;
+    size_t used; // Nodes handed out from nodes
+    size_t size; // Nodes available in nodes
+    struct node nodes[];
+} node_slab;
+
+typedef struct node_pool
+{
+    node_slab *head; // Slab currently being filled, NULL until the first node
+    size_t count;    // Nodes handed out, for accounting
+} node_pool;
+
+/*
+ * node_pool_alloc
+ * ----------
+ * Hands out one uninitialized node from the pool.
+ * Returns its address, or NULL if a new slab can't be allocated.
+ */
+static inline struct node *node_pool_alloc(node_pool *pool)
+{
+    node_slab *slab = pool->head;
+    if (slab == NULL || slab->used == slab->size)
+    {
+        size_t size = slab == NULL ? NODE_POOL_MIN_SLAB : slab->size * 2;
+        if (size > NODE_POOL_MAX_SLAB)
+            size = NODE_POOL_MAX_SLAB;
+
+        node_slab *new_slab = malloc(sizeof(node_slab) + size * sizeof(struct node));
+        if (new_slab == NULL)
+            return NULL;
+        new_slab->next = slab;
+        new_slab->used = 0;
+        new_slab->size = size;
+        pool->head = slab = new_slab;
+    }
+
+    pool->count++;
+    return &slab->nodes[slab->used++];
+}
+
+/*
+ * node_pool_alloc_many
+ * ----------
+ * Hands out count contiguous uninitialized nodes from the pool.
+ * They come from the current slab if it has room, else from a new slab: a regular one
+ * when count fits in it, or a slab of exactly count nodes linked behind the current one,
+ * which then keeps serving node_pool_alloc.
+ * Returns the first node, or NULL if count is 0 or a new slab can't be allocated.
+ */
+static inline struct node *node_pool_alloc_many(node_pool *pool, size_t count)
+{
+    node_slab *slab = pool->head;
+    if (count == 0)
+        return NULL;
+
+    if (slab == NULL || slab->size - slab->used < count)
+    {
+        size_t size = slab == NULL ? NODE_POOL_MIN_SLAB : slab->size * 2;
+        if (size > NODE_POOL_MAX_SLAB)
+            size = NODE_POOL_MAX_SLAB;
+        bool dedicated = count > size;
+        if (dedicated)
+            size = count;
+        if (size > (SIZE_MAX - sizeof(node_slab)) / sizeof(struct node))
+            return NULL;
+
+        node_slab *new_slab = malloc(sizeof(node_slab) + size * sizeof(struct node));
+        if (new_slab == NULL)
+            return NULL;
+        new_slab->used = 0;
+        new_slab->size = size;
+        if (dedicated && slab != NULL)
+        {
+            new_slab->next = slab->next;
+            slab->next = new_slab;
+        }
+        else
+        {
+            new_slab->next = slab;
+            pool->head = new_slab;
+        }
+        slab = new_slab;
+    }
+
+    struct node *nodes = &slab->nodes[slab->used];
+    slab->used += count;
+    pool->count += count;
+    return nodes;
+}
+
+/*
+ * node_pool_free
+ * ----------
+ * Frees every slab of the pool, and with them every node handed out from it.
+ */
+static inline void node_pool_free(node_pool *pool)
+{
+    node_slab *slab = pool->head;
+    while (slab != NULL)
+    {
+        node_slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    pool->head = NULL;
+    pool->count = 0;
+}
+
+#endif
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "skiplist.h"
+
+/*
+ * Lock-free Skip List
+ *
+ * gcc -O2 -pthread -c skiplist.c
+ *
+ * Usage:
+ * skiplist *list = skiplist_create();
+ * skiplist_insert(list, 10);               // from any thread
+ * bool found = skiplist_contains(list, 10); // from any thread
+ * skiplist_destroy(list);
+ *
+ * Every node is on the bottom level, a sorted linked list, and on each level above
+ * with probability 1/4, so each level skips about three quarters of the one below
+ * and a search drops through O(log n) nodes. Links are atomic pointers.
+ *
+ * An insert finds, on every level, the last node before val (pred) and the one after.
+ * It then links the new node in bottom-up, each link one compare-and-swap on the
+ * pred's pointer, released so that the node's value and forward links are visible
+ * to any thread that follows the new pointer. The bottom link makes the value a
+ * member; if its CAS fails another thread got in between, so the insert searches
+ * again (and stops if that thread inserted val itself). The upper links are only
+ * shortcuts: a failed CAS there re-searches and retries that level.
+ * Nodes are never unlinked, so readers need no locks, retries, or reclamation.
+ */
+
+// --- Maximum Height ---
+// Levels thin out by 4 each, so 16 levels cover 4^16 values: more than there are ints.
+#define SL_MAX_HEIGHT 16
+
+// --- List Node ---
+// Allocated with room for height forward links.
+struct sl_node
+{
+    int val;
+    int height;
+    _Atomic(struct sl_node *) next[];
+};
+
+// --- List Structure ---
+struct skiplist
+{
+    struct sl_node *head; // Sentinel before every value, SL_MAX_HEIGHT levels tall
+    atomic_size_t length; // Number of values inserted
+};
+
+// --- Node Heights ---
+// xorshift64 state of the calling thread, seeded on its first insert.
+static _Thread_local uint64_t sl_random_state;
+static atomic_uint_fast64_t sl_seed_counter;
+
+/*
+ * sl_random_height
+ * ----------
+ * Returns a random height from 1 to SL_MAX_HEIGHT, each level 1/4 as likely as the one below.
+ */
+static int sl_random_height(void)
+{
+    uint64_t x = sl_random_state;
+    if (x == 0)
+        x = 0x9E3779B97F4A7C15ULL * (atomic_fetch_add_explicit(&sl_seed_counter, 1, memory_order_relaxed) + 1);
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    sl_random_state = x;
+
+    int height = 1;
+    while (height < SL_MAX_HEIGHT && (x & 3) == 0)
+    {
+        height++;
+        x >>= 2;
+    }
+    return height;
+}
+
+/*
+ * sl_new_node
+ * ----------
+ * Allocates a node holding val with height forward links, or returns NULL if out of memory.
+ */
+static struct sl_node *sl_new_node(int val, int height)
+{
+    struct sl_node *node = malloc(sizeof(struct sl_node) + (size_t)height * sizeof(node->next[0]));
+    if (node == NULL)
+        return NULL;
+    node->val = val;
+    node->height = height;
+    for (int level = 0; level < height; level++)
+        atomic_init(&node->next[level], NULL);
+    return node;
+}
+
+/*
+ * skiplist_create
+ * ----------
+ * Allocates an empty list: just the head sentinel.
+ */
+skiplist *skiplist_create(void)
+{
+    skiplist *list = malloc(sizeof(skiplist));
+    if (list == NULL)
+        return NULL;
+    list->head = sl_new_node(0, SL_MAX_HEIGHT);
+    if (list->head == NULL)
+    {
+        free(list);
+        return NULL;
+    }
+    atomic_init(&list->length, 0);
+    return list;
+}
+
+/*
+ * skiplist_destroy
+ * ----------
+ * Frees every node along the bottom level, then the list.
+ */
+void skiplist_destroy(skiplist *list)
+{
+    if (list == NULL)
+        return;
+
+    struct sl_node *node = list->head;
+    while (node != NULL)
+    {
+        struct sl_node *next = atomic_load_explicit(&node->next[0], memory_order_relaxed);
+        free(node);
+        node = next;
+    }
+    free(list);
+}
+
+/*
+ * sl_find
+ * ----------
+ * Fills preds[level] with the last node before val on every level, and succs[level]
+ * with the node after it (NULL at the end). Returns true if val is in the list.
+ */
+static bool sl_find(skiplist *list, int val, struct sl_node **preds, struct sl_node **succs)
+{
+    struct sl_node *pred = list->head;
+    for (int level = SL_MAX_HEIGHT - 1; level >= 0; level--)
+    {
+        struct sl_node *curr = atomic_load_explicit(&pred->next[level], memory_order_acquire);
+        while (curr != NULL && curr->val < val)
+        {
+            pred = curr;
+            curr = atomic_load_explicit(&curr->next[level], memory_order_acquire);
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+    return succs[0] != NULL && succs[0]->val == val;
+}
+
+/*
+ * skiplist_insert
+ * ----------
+ * Links a new node for val bottom-up, as described at the top of the file.
+ */
+bool skiplist_insert(skiplist *list, int val)
+{
+    if (list == NULL)
+        return false;
+
+    struct sl_node *preds[SL_MAX_HEIGHT], *succs[SL_MAX_HEIGHT];
+    if (sl_find(list, val, preds, succs))
+        return true;
+
+    int height = sl_random_height();
+    struct sl_node *node = sl_new_node(val, height);
+    if (node == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for new skip list node.\n");
+        return false;
+    }
+
+    // Bottom level: once this CAS succeeds, val is in the list
+    for (;;)
+    {
+        for (int level = 0; level < height; level++)
+            atomic_store_explicit(&node->next[level], succs[level], memory_order_relaxed);
+
+        struct sl_node *expected = succs[0];
+        if (atomic_compare_exchange_strong_explicit(&preds[0]->next[0], &expected, node, memory_order_release,
+                                                    memory_order_relaxed))
+            break;
+        if (sl_find(list, val, preds, succs))
+        {
+            // Another thread inserted val first; nobody has seen this node
+            free(node);
+            return true;
+        }
+    }
+    atomic_fetch_add_explicit(&list->length, 1, memory_order_relaxed);
+
+    // Upper levels: shortcuts to the node, linked one at a time
+    for (int level = 1; level < height; level++)
+    {
+        for (;;)
+        {
+            struct sl_node *expected = succs[level];
+            if (atomic_compare_exchange_strong_explicit(&preds[level]->next[level], &expected, node,
+                                                        memory_order_release, memory_order_relaxed))
+                break;
+
+            // Nothing follows this level's link of the node until the CAS publishes it
+            sl_find(list, val, preds, succs);
+            atomic_store_explicit(&node->next[level], succs[level], memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+/*
+ * skiplist_contains
+ * ----------
+ * Searches down from the top level, stopping as soon as a level reaches val.
+ */
+bool skiplist_contains(skiplist *list, int val)
+{
+    if (list == NULL)
+        return false;
+
+    struct sl_node *pred = list->head;
+    for (int level = SL_MAX_HEIGHT - 1; level >= 0; level--)
+    {
+        struct sl_node *curr = atomic_load_explicit(&pred->next[level], memory_order_acquire);
+        while (curr != NULL && curr->val < val)
+        {
+            pred = curr;
+            curr = atomic_load_explicit(&curr->next[level], memory_order_acquire);
+        }
+        if (curr != NULL && curr->val == val)
+            return true;
+    }
+    return false;
+}
+
+size_t skiplist_length(skiplist *list)
+{
+    return list != NULL ? atomic_load_explicit(&list->length, memory_order_relaxed) : 0;
+}
+
+/*
+ * skiplist_walk
+ * ----------
+ * Follows the bottom level, which holds every value in order.
+ */
+void skiplist_walk(skiplist *list, void (*visit)(int val, void *ctx), void *ctx)
+{
+    if (list == NULL)
+        return;
+
+    struct sl_node *node = atomic_load_explicit(&list->head->next[0], memory_order_acquire);
+    while (node != NULL)
+    {
+        visit(node->val, ctx);
+        node = atomic_load_explicit(&node->next[0], memory_order_acquire);
+    }
+}
+
+static void sl_print_value(int val, void *ctx)
+{
+    (void)ctx;
+    printf("%d\n", val);
+}
+
+void skiplist_print_sorted(skiplist *list)
+{
+    skiplist_walk(list, sl_print_value, NULL);
+}
@@ -0,0 +1,41 @@
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/*
+ * Concurrent ordered set of ints: a lock-free skip list.
+ * Any number of threads may insert, look up and walk it at the same time,
+ * without locks; only create and destroy need the list to themselves.
+ * Values are never removed, so a node, once linked, stays valid until skiplist_destroy.
+ */
+
+typedef struct skiplist skiplist;
+
+/** Create an empty list, or NULL if out of memory */
+skiplist *skiplist_create(void);
+
+/** Free the list and all its nodes. No other thread may be using it. */
+void skiplist_destroy(skiplist *list);
+
+/** Insert val. A value that is already in the list is left as it is.
+ *  Safe to call from several threads at once. Return false if out of memory.
+ */
+bool skiplist_insert(skiplist *list, int val);
+
+/** Return true if val is in the list. Never blocks, even while other threads insert. */
+bool skiplist_contains(skiplist *list, int val);
+
+/** Number of values in the list (inserts still in progress may or may not be counted) */
+size_t skiplist_length(skiplist *list);
+
+/** Call visit(val, ctx) on every value, in ascending order. Values inserted during the walk
+ *  may or may not be visited; every value inserted before it started is.
+ */
+void skiplist_walk(skiplist *list, void (*visit)(int val, void *ctx), void *ctx);
+
+/** Print every value in ascending order, one per line */
+void skiplist_print_sorted(skiplist *list);
+
+#endif
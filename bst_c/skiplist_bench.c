@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include "avl.h"
+#include "skiplist.h"
+
+/*
+ * Concurrent ordered set scaling benchmark
+ *
+ * Compares the lock-free skip list with an AVL tree behind one mutex:
+ * gcc -O2 -pthread -o skiplist_bench skiplist_bench.c skiplist.c avl.c
+ *
+ * Usage: ./skiplist_bench [number of values] [ops per thread] [max threads]
+ * Defaults to 1000000 values, 1000000 ops per thread and up to 16 threads.
+ * Both sets start with the same n random values out of [0, 2n). Each thread then
+ * runs random lookups and inserts of values from that range, about half of them
+ * present, in a read-heavy (95% lookup / 5% insert) and a write-heavy (50/50) mix
+ * at 1, 2, 4 ... threads. Every run starts from a freshly built set.
+ */
+
+typedef struct
+{
+    bool (*insert)(void *set, int val);
+    bool (*contains)(void *set, int val);
+} set_ops;
+
+typedef struct
+{
+    const set_ops *ops;
+    void *set;
+    size_t range;
+    size_t count;
+    unsigned write_percent;
+    uint64_t seed;
+} worker_args;
+
+// --- Global-lock Baseline ---
+typedef struct
+{
+    avl *tree;
+    pthread_mutex_t lock;
+} locked_avl;
+
+static bool locked_avl_insert(void *set, int val)
+{
+    locked_avl *locked = set;
+    pthread_mutex_lock(&locked->lock);
+    bool ok = avl_insert(locked->tree, val);
+    pthread_mutex_unlock(&locked->lock);
+    return ok;
+}
+
+static bool locked_avl_contains(void *set, int val)
+{
+    locked_avl *locked = set;
+    pthread_mutex_lock(&locked->lock);
+    bool found = avl_contains(locked->tree, val);
+    pthread_mutex_unlock(&locked->lock);
+    return found;
+}
+
+static bool skiplist_insert_any(void *set, int val)
+{
+    return skiplist_insert(set, val);
+}
+
+static bool skiplist_contains_any(void *set, int val)
+{
+    return skiplist_contains(set, val);
+}
+
+static const set_ops locked_avl_ops = {locked_avl_insert, locked_avl_contains};
+static const set_ops skiplist_ops = {skiplist_insert_any, skiplist_contains_any};
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: cheap per-thread random numbers
+static inline uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/*
+ * fill
+ * ----------
+ * Inserts n random values out of [0, range), the same ones for every set.
+ */
+static bool fill(const set_ops *ops, void *set, size_t n, size_t range)
+{
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (!ops->insert(set, (int)(next_random(&state) % range)))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * worker
+ * ----------
+ * Runs count random operations: an insert for write_percent of them, a lookup otherwise.
+ */
+static void *worker(void *arg)
+{
+    worker_args *args = arg;
+    uint64_t state = args->seed;
+    size_t found = 0;
+
+    for (size_t i = 0; i < args->count; i++)
+    {
+        uint64_t r = next_random(&state);
+        int val = (int)((r >> 8) % args->range);
+        if ((r & 0xFF) % 100 < args->write_percent)
+        {
+            if (!args->ops->insert(args->set, val))
+                fprintf(stderr, "Error: insert of %d failed.\n", val);
+        }
+        else
+            found += args->ops->contains(args->set, val);
+    }
+    return (void *)(uintptr_t)found;
+}
+
+/*
+ * run_mix
+ * ----------
+ * Times nthreads workers running the same mix concurrently on set.
+ * Returns the aggregate throughput in operations per second.
+ */
+static double run_mix(const set_ops *ops, void *set, size_t range, size_t count, unsigned write_percent,
+                      size_t nthreads)
+{
+    pthread_t *threads = malloc(nthreads * sizeof(pthread_t));
+    worker_args *args = malloc(nthreads * sizeof(worker_args));
+    if (threads == NULL || args == NULL)
+    {
+        free(threads);
+        free(args);
+        return 0;
+    }
+
+    double start = now_sec();
+    for (size_t t = 0; t < nthreads; t++)
+    {
+        args[t] = (worker_args){ops, set, range, count, write_percent, 0x9E3779B97F4A7C15ULL * (t + 1)};
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+    for (size_t t = 0; t < nthreads; t++)
+        pthread_join(threads[t], NULL);
+    double seconds = now_sec() - start;
+
+    free(threads);
+    free(args);
+    return (double)(count * nthreads) / seconds;
+}
+
+/*
+ * run_locked_avl, run_skiplist
+ * ----------
+ * Build a fresh set of n values and time one mix on it, or return 0 if out of memory.
+ */
+static double run_locked_avl(size_t n, size_t count, unsigned write_percent, size_t nthreads)
+{
+    locked_avl locked = {avl_create(), PTHREAD_MUTEX_INITIALIZER};
+    double rate = 0;
+    if (locked.tree != NULL && fill(&locked_avl_ops, &locked, n, 2 * n))
+        rate = run_mix(&locked_avl_ops, &locked, 2 * n, count, write_percent, nthreads);
+    avl_destroy(locked.tree);
+    return rate;
+}
+
+static double run_skiplist(size_t n, size_t count, unsigned write_percent, size_t nthreads)
+{
+    skiplist *list = skiplist_create();
+    double rate = 0;
+    if (list != NULL && fill(&skiplist_ops, list, n, 2 * n))
+        rate = run_mix(&skiplist_ops, list, 2 * n, count, write_percent, nthreads);
+    skiplist_destroy(list);
+    return rate;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    size_t count = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000;
+    size_t max_threads = argc > 3 ? strtoull(argv[3], NULL, 10) : 16;
+    if (n == 0 || n > INT32_MAX / 2)
+    {
+        fprintf(stderr, "Error: number of values must be between 1 and %d.\n", INT32_MAX / 2);
+        return 1;
+    }
+
+    printf("%zu values, %zu ops per thread\n", n, count);
+    printf("%8s %14s %14s %14s %14s\n", "", "95/5 Mops/s", "", "50/50 Mops/s", "");
+    printf("%8s %14s %14s %14s %14s\n", "threads", "avl+mutex", "skiplist", "avl+mutex", "skiplist");
+    for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+    {
+        double avl_read = run_locked_avl(n, count, 5, nthreads);
+        double list_read = run_skiplist(n, count, 5, nthreads);
+        double avl_write = run_locked_avl(n, count, 50, nthreads);
+        double list_write = run_skiplist(n, count, 50, nthreads);
+        printf("%8zu %14.2f %14.2f %14.2f %14.2f\n", nthreads, avl_read / 1e6, list_read / 1e6, avl_write / 1e6,
+               list_write / 1e6);
+    }
+    return 0;
+}
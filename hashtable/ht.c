@@ -4,7 +4,24 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <time.h>
 #include "ht.h"
+#include "ht_hash.h"
+#include "ht_arena.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HT_HAVE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__STDC_NO_ATOMICS__)
+#define HT_HAVE_THREADS 1
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
 
 /*
  * Simple Hashtable Implementation in C
@@ -12,8 +29,11 @@
  * This file provides a basic hash table (associative array) implementation
  * using open addressing and linear probing for collision resolution.
  * Keys are strings, and values are generic pointers (void *).
+ * The _n variants (ht_get_n, ht_set_n, ht_remove_n) take keys as bytes plus a length
+ * instead, so they can contain NUL bytes and needn't be copied out of a larger buffer.
  *
- * The hash function used is FNV-1a, which is fast and has good distribution.
+ * The hash function is FNV-1a by default, which is simple and has good distribution;
+ * ht_options.hash selects a faster or a seeded one from ht_hash.h per table.
  *
  * Usage:
  * ht *table = ht_create();
@@ -21,23 +41,72 @@
  * void *value = ht_get(table, "key");
  * ht_destroy(table);
  *
+ * Key storage is selected per table with ht_create_opts:
+ * by default every key is malloc'ed, HT_KEY_ARENA copies keys into chunks freed
+ * all at once by ht_destroy, HT_KEY_INLINE keeps short keys inside their slot.
+ *
+ * ht_remove uses backward-shift deletion: the entries following the removed one
+ * in its cluster are moved back, so no tombstones are left behind and lookups
+ * don't slow down after many insert/remove cycles.
+ *
+ * The starting capacity and the maximum load factor (50% by default) can be set
+ * per table, and ht_reserve makes room for a known number of keys up front.
+ *
+ * With HT_INCREMENTAL the table grows without a full rehash: the old and the new
+ * entries arrays coexist, and every ht_set/ht_get migrates a few old slots.
+ *
+ * With HT_ROBIN_HOOD an insert takes the slot of any entry that is closer to its own
+ * home slot than the new key would be, and moves that entry further along instead.
+ * Probe distances even out, and a lookup can stop as soon as it passes a key closer
+ * to home than it is, instead of scanning to the end of the cluster. ht_stats reports
+ * the resulting probe distances.
+ *
+ * ht_get_many and ht_set_many work through their keys in batches of HT_BATCH:
+ * every key of a batch is hashed and its home slot prefetched before any probe runs,
+ * so the cache misses of a batch overlap instead of being paid one after another.
+ *
+ * Built with -DHT_INSTRUMENT, the table also counts what its hot paths do (lookups,
+ * hits, probed slots, sets, expansions and the time they took, key bytes allocated)
+ * for ht_read_counters. Without it the counters and the code updating them are gone.
+ *
+ * ht_bulk_load builds a table from a whole set of keys on several threads: keys are
+ * grouped by the top bits of their home slot, so every thread fills its own region
+ * of the entries array, and ht_iterator_part splits iteration the same way.
+ * It uses POSIX threads where available (link with -pthread on older glibc).
+ *
+ * ht_save writes a table to a snapshot file, and ht_load maps one back read-only.
+ * The snapshot is the entries array itself, with key pointers replaced by offsets
+ * into a key blob that follows it, so a loaded table probes the mapped file
+ * directly and its pages are only read as lookups touch them.
+ *
  * Iterator Usage:
  * hti it = ht_iterator(table);
  * while (ht_next(&it)) {
  * printf("Key: %s, Value: %p\n", it.key, it.value);
  * }
+ *
+ * ht_swiss.c implements the same ht.h API with a Swiss-table layout, and ht_dense.c
+ * with a compact one that iterates in insertion order;
+ * link against one of them to swap implementations.
  */
 
-// --- Constants for FNV-1a Hash Function ---
-#define FNV_OFFSET 14695981039346656037UL
-#define FNV_PRIME 1099511628211UL
+// --- Inline Key Size ---
+// With HT_KEY_INLINE, keys shorter than this are stored in the slot itself.
+// It also pads entries to 32 bytes, so an entry never straddles a cache line.
+#define INLINE_KEY_SIZE 8
 
 // --- Hashtable Entry ---
-// Each entry holds a key-value pair.
+// Each entry holds a key-value pair, plus the key's length and the low half of its hash.
+// The cached hash and length let probes skip memcmp on mismatching keys, and
+// let ht_expand rehash without reading the keys again.
+// Half a hash is enough to place entries in up to MAX_CAPACITY slots.
 typedef struct
 {
-    const char *key;
+    const char *key; // NULL for an empty slot, points at inl for an inline key
     void *value;
+    uint32_t hash;
+    uint32_t length; // Key length in bytes, not counting the NUL the table appends
+    char inl[INLINE_KEY_SIZE];
 } ht_entry;
 
 // --- Hashtable Structure ---
@@ -45,17 +114,34 @@ typedef struct
 struct ht
 {
     ht_entry *entries;
-    size_t capacity; // Total number of slots in the table
-    size_t length;   // Number of key-value pairs stored
-};
+    size_t capacity;   // Total number of slots in the table
+    size_t length;     // Number of key-value pairs stored
+    size_t max_length; // Length at which the table expands: capacity * max_load
+    double max_load;   // Maximum load factor, in (0, 1)
+    unsigned flags;    // HT_KEY_*, HT_INCREMENTAL and HT_ROBIN_HOOD options given to ht_create_opts
+    ht_arena arena;    // Key storage for HT_KEY_ARENA
 
-// --- Hashtable Iterator Structure ---
-struct hti
-{
-    const ht *_table; // Pointer to the hash table being iterated
-    size_t _index;    // Current index in the table's entries array
-    const char *key;  // Key of the current entry (updated by ht_next)
-    void *value;      // Value of the current entry (updated by ht_next)
+    ht_hash_fn hash_fn; // Hash function selected by ht_options.hash
+    uint64_t seed;      // Seed passed to hash_fn
+    unsigned hash_kind; // ht_options.hash, recorded in snapshots
+
+    // ht_load: read-only mapping of a snapshot (NULL for a regular table).
+    // Entry keys of a mapped table are offsets from the start of the mapping, and
+    // key_base turns them back into addresses; it is 0 for a regular table.
+    void *map;
+    size_t map_size;
+    uintptr_t key_base;
+
+    // HT_INCREMENTAL: array still being migrated into entries (NULL when not resizing).
+    // Every key lives in exactly one of the two arrays.
+    ht_entry *old_entries;
+    size_t old_capacity;
+    size_t migrate_pos;  // Next old slot to migrate
+    size_t migrate_left; // Old slots not migrated yet
+
+#ifdef HT_INSTRUMENT
+    ht_counters counters; // Read with ht_read_counters
+#endif
 };
 
 // --- Initial Capacity ---
@@ -63,37 +149,140 @@ struct hti
 // A capacity with power of 2 is defined to help with performance
 #define INITIAL_CAPACITY 16
 
+// --- Maximum Capacity ---
+// Entries cache 32 hash bits, which index at most this many slots.
+#define MAX_CAPACITY ((uint64_t)1 << 32)
+
+// --- Maximum Key Length ---
+// Lengths are stored in 32 bits as well.
+#define MAX_KEY_LENGTH UINT32_MAX
+
+// --- Default Load Factor ---
+// Linear probe sequences grow quickly past half full.
+#define DEFAULT_MAX_LOAD 0.5
+
+// --- Incremental Migration Step ---
+// Old slots migrated by each ht_set/ht_get while an incremental resize is running.
+// A resize starts at load L, and the new array reaches L after L * old_capacity more
+// inserts, so anything above 1/L slots per insert finishes the migration in time
+// (2 at the default 50% load).
+#define MIGRATE_STEP 16
+
+// --- Batch Size ---
+// Keys hashed and prefetched together by ht_get_many/ht_set_many.
+// Enough misses in flight to keep the memory system busy, few enough that
+// the prefetched lines are still cached when their probe runs.
+#define HT_BATCH 16
+
+#if defined(__GNUC__)
+#define HT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define HT_PREFETCH(addr) ((void)(addr))
+#endif
+
+// --- Instrumentation ---
+// HT_COUNT(statement) updates a counter only in builds with -DHT_INSTRUMENT.
+#ifdef HT_INSTRUMENT
+#define HT_COUNT(statement) statement
+#else
+#define HT_COUNT(statement)
+#endif
+
 /*
- * hash_key
+ * ht_max_length
  * ----------
- * Computes the FNV-1a hash for a given string key.
- * Returns a 64-bit unsigned integer hash value.
+ * Returns how many entries a capacity holds before it must expand.
+ * It stays below capacity, so probe sequences always end at an empty slot.
  */
-static uint64_t hash_key(const char *key)
+static size_t ht_max_length(size_t capacity, double max_load)
 {
-    uint64_t hash = FNV_OFFSET;
-    for (const char *p = key; *p; p++)
-    {
-        hash ^= (uint64_t)(unsigned char)(*p);
-        hash *= FNV_PRIME;
-    }
-    return hash;
+    size_t max_length = (size_t)((double)capacity * max_load);
+    return max_length < capacity ? max_length : capacity - 1;
 }
 
 /*
- * ht_create
+ * ht_capacity_for
+ * ----------
+ * Returns the smallest power of 2 capacity (at least INITIAL_CAPACITY) that
+ * holds length entries without expanding, or 0 on overflow.
+ */
+static size_t ht_capacity_for(size_t length, double max_load)
+{
+    if ((double)length / max_load >= (double)(SIZE_MAX / 4))
+        return 0;
+
+    size_t capacity = INITIAL_CAPACITY;
+    while (ht_max_length(capacity, max_load) < length)
+        capacity *= 2;
+    return (uint64_t)capacity <= MAX_CAPACITY ? capacity : 0;
+}
+
+/*
+ * ht_set_capacity
+ * ----------
+ * Records a new capacity along with the length at which it must expand.
+ */
+static void ht_set_capacity(ht *table, size_t capacity)
+{
+    table->capacity = capacity;
+    table->max_length = ht_max_length(capacity, table->max_load);
+}
+
+/*
+ * ht_create_opts
  * ----------
- * Allocates and initializes a new hashtable.
+ * Allocates and initializes a new hashtable with the given options (NULL for defaults).
  * Returns a pointer to the new table, or NULL on failure.
  */
-ht *ht_create(void)
+ht *ht_create_opts(const ht_options *opts)
 {
+    double max_load = opts != NULL && opts->max_load != 0 ? opts->max_load : DEFAULT_MAX_LOAD;
+    if (!(max_load > 0 && max_load < 1))
+    {
+        fprintf(stderr, "Error: Hashtable max_load must be between 0 and 1.\n");
+        return NULL;
+    }
+
+    size_t capacity = ht_capacity_for(opts != NULL ? opts->capacity : 0, max_load);
+    if (capacity == 0)
+    {
+        fprintf(stderr, "Error: Hashtable capacity overflow.\n");
+        return NULL;
+    }
+
+    unsigned flags = opts != NULL ? opts->flags : 0;
+    if ((flags & HT_ROBIN_HOOD) && (flags & HT_INCREMENTAL))
+    {
+        fprintf(stderr, "Error: HT_ROBIN_HOOD can't be combined with HT_INCREMENTAL.\n");
+        return NULL;
+    }
+
+    ht_hash_fn hash_fn;
+    uint64_t seed;
+    if (!hash_select(opts, &hash_fn, &seed))
+        return NULL;
+
     ht *table = malloc(sizeof(ht));
     if (table == NULL)
         return NULL;
 
     table->length = 0;
-    table->capacity = INITIAL_CAPACITY;
+    table->hash_fn = hash_fn;
+    table->seed = seed;
+    table->hash_kind = opts != NULL ? opts->hash : HT_HASH_FNV1A;
+    table->map = NULL;
+    table->map_size = 0;
+    table->key_base = 0;
+    table->max_load = max_load;
+    ht_set_capacity(table, capacity);
+    table->flags = flags;
+    table->arena.head = NULL;
+    table->arena.bytes = 0;
+    table->old_entries = NULL;
+    table->old_capacity = 0;
+    table->migrate_pos = 0;
+    table->migrate_left = 0;
+    HT_COUNT(memset(&table->counters, 0, sizeof(table->counters)));
     table->entries = calloc(table->capacity, sizeof(ht_entry));
 
     if (table->entries == NULL)
@@ -104,6 +293,67 @@ ht *ht_create(void)
     return table;
 }
 
+/*
+ * ht_create
+ * ----------
+ * Allocates and initializes a new hashtable with default options.
+ * Returns a pointer to the new table, or NULL on failure.
+ */
+ht *ht_create(void)
+{
+    return ht_create_opts(NULL);
+}
+
+/*
+ * ht_create_capacity
+ * ----------
+ * Allocates a new hashtable with room for capacity keys before its first expansion.
+ * Returns a pointer to the new table, or NULL on failure.
+ */
+ht *ht_create_capacity(size_t capacity)
+{
+    ht_options opts = {0};
+    opts.capacity = capacity;
+    return ht_create_opts(&opts);
+}
+
+/*
+ * ht_free_keys
+ * ----------
+ * Frees the malloc'ed keys of an entries array.
+ */
+static void ht_free_keys(ht_entry *entries, size_t capacity)
+{
+    for (size_t i = 0; i < capacity; i++)
+    {
+        // Only free if a key exists at this slot and lives outside of it
+        const char *key = entries[i].key;
+        if (key != NULL && key != entries[i].inl)
+        {
+            free((void *)key); // Free each key allocated by ht_copy_key
+        }
+    }
+}
+
+#ifdef HT_INSTRUMENT
+/*
+ * ht_print_counters
+ * ----------
+ * Writes the counters of the table to out on one line.
+ */
+static void ht_print_counters(const ht *table, FILE *out)
+{
+    const ht_counters *c = &table->counters;
+    fprintf(out,
+            "ht %p: %zu keys, %llu gets (%llu hits, %.2f probes each), %llu sets (%llu inserts, %.2f probes each), "
+            "%llu expansions in %.3f ms, %llu key bytes\n",
+            (const void *)table, table->length, (unsigned long long)c->gets, (unsigned long long)c->get_hits,
+            c->gets > 0 ? (double)c->get_probes / (double)c->gets : 0.0, (unsigned long long)c->sets,
+            (unsigned long long)c->set_inserts, c->sets > 0 ? (double)c->set_probes / (double)c->sets : 0.0,
+            (unsigned long long)c->expansions, (double)c->expand_ns / 1e6, (unsigned long long)c->key_bytes);
+}
+#endif
+
 /*
  * ht_destroy
  * ----------
@@ -115,220 +365,1547 @@ void ht_destroy(ht *table)
     if (table == NULL)
         return;
 
-    for (size_t i = 0; i < table->capacity; i++)
+#ifdef HT_INSTRUMENT
+    // Last chance to see the counters of tables the program never asks about
+    if (getenv("HT_COUNTERS") != NULL)
+        ht_print_counters(table, stderr);
+#endif
+
+#ifdef HT_HAVE_MMAP
+    // Everything of a loaded snapshot lives in its mapping
+    if (table->map != NULL)
     {
-        // Only free if a key exists at this slot
-        if (table->entries[i].key != NULL)
-        {
-            free((void *)table->entries[i].key); // Free each key string allocated by strdup
-        }
+        munmap(table->map, table->map_size);
+        free(table);
+        return;
+    }
+#endif
+
+    // Arena keys go away with their chunks, no need to visit every slot
+    if (!(table->flags & HT_KEY_ARENA))
+    {
+        ht_free_keys(table->entries, table->capacity);
+        if (table->old_entries != NULL)
+            ht_free_keys(table->old_entries, table->old_capacity);
     }
 
+    arena_free(&table->arena);
+    free(table->old_entries);
     free(table->entries); // Free the entries array
     free(table);          // Free the table structure
 }
 
 /*
- * ht_get
+ * ht_hash
  * ----------
- * Looks up a key in the hashtable and returns its value.
- * Returns NULL if the key is not found.
- *
- * Uses linear probing to resolve collisions.
+ * Hashes a key of length bytes with the function and seed the table was created with.
  */
-void *ht_get(ht *table, const char *key)
+static inline uint64_t ht_hash(const ht *table, const char *key, size_t length)
 {
-    if (table == NULL || key == NULL)
-        return NULL;
+    return table->hash_fn(key, length, table->seed);
+}
+
+/*
+ * ht_distance
+ * ----------
+ * Returns how far the entry in slot index is from its home slot.
+ */
+static inline size_t ht_distance(const ht_entry *entry, size_t index, size_t mask)
+{
+    return (index - (size_t)(entry->hash & (uint64_t)mask)) & mask;
+}
+
+#ifdef HT_INSTRUMENT
+/*
+ * ht_probed
+ * ----------
+ * Returns how many slots ht_probe examined to return index for a key with the given hash.
+ */
+static inline uint64_t ht_probed(size_t index, uint64_t hash, size_t capacity)
+{
+    return (uint64_t)((index - (size_t)hash) & (capacity - 1)) + 1;
+}
+
+/*
+ * ht_now_ns
+ * ----------
+ * Returns a timestamp in nanoseconds, from the monotonic clock where there is one.
+ */
+static uint64_t ht_now_ns(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#else
+    // Plain C99: processor time, close enough to time an expansion
+    return (uint64_t)((double)clock() * 1e9 / CLOCKS_PER_SEC);
+#endif
+}
+#endif
 
-    uint64_t hash = hash_key(key);
-    size_t index = (size_t)(hash & (uint64_t)(table->capacity - 1)); // the bitwise & here works as a faster modulo operator.
+/*
+ * ht_probe
+ * ----------
+ * Walks the linear probe sequence of a key of length bytes in one of the table's entries arrays.
+ * Stored keys are at key_base plus the entry's key field (key_base is 0 except for snapshots).
+ * Returns the index of the slot holding key, setting *found, or clears *found and returns
+ * the slot where key would be inserted: the empty slot that ends the sequence or, with
+ * HT_ROBIN_HOOD, the first slot whose entry is closer to its home than key would be.
+ */
+static size_t ht_probe(const ht *table, const ht_entry *entries, size_t capacity, const char *key, size_t length,
+                       uint64_t hash, bool *found)
+{
+    size_t mask = capacity - 1;
+    size_t index = (size_t)(hash & (uint64_t)mask); // the bitwise & here works as a faster modulo operator.
+    bool robin_hood = table->flags & HT_ROBIN_HOOD;
 
     // Probe until we find the key or hit an empty slot
-    while (table->entries[index].key != NULL)
+    for (size_t distance = 0; entries[index].key != NULL; distance++)
     {
-        if (strcmp(key, table->entries[index].key) == 0)
-            return table->entries[index].value;
+        // Different hashes or lengths mean different keys, only the rest need a memcmp
+        if (entries[index].hash == (uint32_t)hash && entries[index].length == length &&
+            memcmp(key, (const char *)(table->key_base + (uintptr_t)entries[index].key), length) == 0)
+        {
+            *found = true;
+            return index;
+        }
+
+        // Robin Hood order: key would have displaced this entry, so it isn't stored further on
+        if (robin_hood && ht_distance(&entries[index], index, mask) < distance)
+            break;
 
-        index++;
-        if (index >= table->capacity)
-            index = 0; // Wrap around to the start
+        index = (index + 1) & mask; // Wrap around to the start
     }
-    return NULL; // Not found
+    *found = false;
+    return index;
 }
 
 /*
- * ht_set_entry
+ * ht_move_entry
+ * ----------
+ * Copies an entry into another slot.
+ * An inline key lives in its slot, so its pointer follows the entry to the new slot.
+ */
+static inline void ht_move_entry(ht_entry *dst, const ht_entry *src)
+{
+    *dst = *src;
+    if (src->key == src->inl)
+        dst->key = dst->inl;
+}
+
+/*
+ * ht_place
  * ----------
- * Helper function to set a new entry or update an existing one in a given array of entries.
- * This function is used by ht_set and ht_expand.
- * If plength is not NULL, it means a new unique key is being inserted,
- * so the key string is duplicated and the length counter is incremented.
- * Returns a pointer to the stored key string on success, NULL on failure (e.g., strdup fails).
+ * Inserts an entry whose key is known not to be in the array yet, starting from its home slot.
+ * Without Robin Hood ordering it goes into the first empty slot. With it, the entry swaps
+ * places with the first entry closer to home than it is, which then continues the walk.
  */
-static const char *ht_set_entry(ht_entry *entries, size_t capacity, const char *key, void *value, size_t *plength)
+static void ht_place(ht_entry *entries, size_t capacity, const ht_entry *entry, bool robin_hood)
 {
-    uint64_t hash = hash_key(key);
-    size_t index = (size_t)(hash & (uint64_t)(capacity - 1));
+    size_t mask = capacity - 1;
+    ht_entry carry;
+    ht_move_entry(&carry, entry);
 
-    while (entries[index].key != NULL)
+    size_t index = (size_t)(carry.hash & (uint64_t)mask);
+    for (size_t distance = 0; entries[index].key != NULL; distance++)
     {
-        if (strcmp(key, entries[index].key) == 0)
+        size_t resident = robin_hood ? ht_distance(&entries[index], index, mask) : SIZE_MAX;
+        if (resident < distance)
         {
-            entries[index].value = value;
-            return entries[index].key;
+            ht_entry displaced;
+            ht_move_entry(&displaced, &entries[index]);
+            ht_move_entry(&entries[index], &carry);
+            ht_move_entry(&carry, &displaced);
+            distance = resident;
         }
-
-        index++;
-        if (index >= capacity)
-            index = 0; // Wrap around to the start of the array
+        index = (index + 1) & mask;
     }
+    ht_move_entry(&entries[index], &carry);
+}
 
-    // If plength is not NULL, this is a new unique insertion (not a rehash during expansion)
-    if (plength != NULL)
-    {
-        // Duplicate the key string to ensure the table owns its memory
-        char *new_key_copy = strdup(key);
-        if (new_key_copy == NULL)
-            return NULL;
+/*
+ * ht_migrate
+ * ----------
+ * Moves up to budget slots of an incremental resize from old_entries into entries.
+ * Slots are migrated one whole cluster (run of occupied slots) at a time, starting
+ * from an empty slot: removing a complete cluster never breaks the probe sequence
+ * of a key that is still in the old array.
+ * Frees the old array once every slot has been migrated.
+ */
+static void ht_migrate(ht *table, size_t budget)
+{
+    ht_entry *old = table->old_entries;
+    size_t old_mask = table->old_capacity - 1;
 
-        key = new_key_copy;
+    while (budget > 0 && table->migrate_left > 0)
+    {
+        ht_entry *entry = &old[table->migrate_pos];
+        if (entry->key != NULL)
+        {
+            // Keys are unique and already owned, so it goes into the first empty slot
+            // (HT_INCREMENTAL excludes HT_ROBIN_HOOD)
+            ht_place(table->entries, table->capacity, entry, false);
+            entry->key = NULL;
+        }
+        table->migrate_pos = (table->migrate_pos + 1) & old_mask;
+        table->migrate_left--;
 
-        (*plength)++;
+        // Stop only between clusters, i.e. right before an empty old slot
+        if (old[table->migrate_pos].key == NULL)
+            budget--;
     }
 
-    entries[index].key = key;
-    entries[index].value = value;
-    return key;
+    if (table->migrate_left == 0)
+    {
+        free(table->old_entries);
+        table->old_entries = NULL;
+        table->old_capacity = 0;
+    }
 }
 
 /*
- * ht_expand
+ * ht_lookup
  * ----------
- * Doubles the capacity of the hashtable and rehashes all existing entries
- * into the new, larger array.
- * Returns true on success, false on failure (e.g., memory allocation fails).
+ * Returns the value stored with key, given its length and hash, or NULL if the key is not found.
  */
-static bool ht_expand(ht *table)
+static void *ht_lookup(ht *table, const char *key, size_t length, uint64_t hash)
 {
-    size_t new_capacity = table->capacity * 2;
-    if (new_capacity < table->capacity)
-    {
-        fprintf(stderr, "Error: Hashtable capacity overflow during expansion.\n");
-        return false;
-    }
+    HT_COUNT(table->counters.gets++);
 
-    ht_entry *new_entries = calloc(new_capacity, sizeof(ht_entry));
-    if (new_entries == NULL)
+    bool found;
+    size_t index = ht_probe(table, table->entries, table->capacity, key, length, hash, &found);
+    HT_COUNT(table->counters.get_probes += ht_probed(index, hash, table->capacity));
+    if (found)
     {
-        fprintf(stderr, "Error: Failed to allocate memory for new hashtable entries.\n");
-        return false;
+        HT_COUNT(table->counters.get_hits++);
+        return table->entries[index].value;
     }
 
-    // Rehash all existing entries from the old table into the new table
-    for (size_t i = 0; i < table->capacity; i++)
+    // During an incremental resize the key may not have been migrated yet
+    if (table->old_entries != NULL)
     {
-        ht_entry entry = table->entries[i];
-        if (entry.key != NULL)
+        index = ht_probe(table, table->old_entries, table->old_capacity, key, length, hash, &found);
+        HT_COUNT(table->counters.get_probes += ht_probed(index, hash, table->old_capacity));
+        if (found)
         {
-            // Reinsert the entry into the new array.
-            // Pass NULL for plength as we are not incrementing the length
-            // and not duplicating keys (they are already owned).
-            ht_set_entry(new_entries, new_capacity, entry.key, entry.value, NULL);
+            HT_COUNT(table->counters.get_hits++);
+            return table->old_entries[index].value;
         }
     }
+    return NULL; // Not found
+}
 
-    // Free the old entries array and update the table with the new array
-    free(table->entries);
-    table->entries = new_entries;
-    table->capacity = new_capacity;
-
-    return true;
+/*
+ * ht_get
+ * ----------
+ * Looks up a key in the hashtable and returns its value.
+ * Returns NULL if the key is not found.
+ *
+ * Uses linear probing to resolve collisions.
+ */
+void *ht_get(ht *table, const char *key)
+{
+    if (key == NULL)
+        return NULL;
+    return ht_get_n(table, key, strlen(key));
 }
 
-/** Set value in the table.
- * This function takes the table, the value to map to the key, and of course the key.
- * Its main function it's to check wheter the inserted value is valid.
- * After the insertion we check for the size of the table, and we decide wether to expand it or not.
- * Setting the value to the table is delegated to the ht_set_entry helper function.
- * The expansion of the table is delegated to the ht_expand function.
- * Returns a pointer to the stored key string on success, NULL on failure.
+/*
+ * ht_get_n
+ * ----------
+ * Looks up a key of length bytes, which may contain NUL bytes and needn't be NUL-terminated.
+ * Returns its value, or NULL if the key is not found.
  */
-const char *ht_set(ht *table, const char *key, void *value)
+void *ht_get_n(ht *table, const void *key, size_t length)
 {
-    assert(value != NULL); // (debug builds)
-    if (table == NULL || key == NULL || value == NULL)
+    if (table == NULL || key == NULL)
         return NULL;
 
-    // Check if the table needs to expand. Load factor is length / capacity.
-    // Expand when length reaches 50% of capacity to maintain good performance.
-    if (table->length >= table->capacity / 2)
-    {
-        if (!ht_expand(table))
-            return NULL;
-    }
+    if (table->old_entries != NULL)
+        ht_migrate(table, MIGRATE_STEP);
 
-    return (char *)ht_set_entry(table->entries, table->capacity, key, value, &table->length);
+    return ht_lookup(table, key, length, ht_hash(table, key, length));
 }
 
 /*
- * ht_length
+ * ht_get_many
  * ----------
- * Returns the current number of key-value pairs stored in the hashtable.
+ * Looks up n keys, storing each value (NULL if not found) in values.
+ * Each batch runs in three passes over its keys:
+ * hash and prefetch the home slot, then prefetch the key string of home slots
+ * whose cached hash matches, then probe. By the time a probe runs, the lines it
+ * needs were requested one or two passes earlier, together with the other keys'.
  */
-size_t ht_length(ht *table)
+void ht_get_many(ht *table, const char *const *keys, size_t n, void **values)
 {
-    if (table == NULL)
-        return 0;
-    return table->length;
+    if (table == NULL || keys == NULL || values == NULL)
+        return;
+
+    uint64_t hashes[HT_BATCH];
+    size_t lengths[HT_BATCH];
+    for (size_t base = 0; base < n; base += HT_BATCH)
+    {
+        size_t count = n - base < HT_BATCH ? n - base : HT_BATCH;
+        const char *const *batch = keys + base;
+
+        // One migration step per batch is enough: ht_set drives the resize to completion
+        if (table->old_entries != NULL)
+            ht_migrate(table, MIGRATE_STEP);
+
+        size_t mask = table->capacity - 1;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (batch[i] == NULL)
+                continue;
+            lengths[i] = strlen(batch[i]);
+            hashes[i] = ht_hash(table, batch[i], lengths[i]);
+            HT_PREFETCH(&table->entries[hashes[i] & mask]);
+        }
+
+        // Inline keys live in the slot itself, anything else is one more pointer to chase
+        for (size_t i = 0; i < count; i++)
+        {
+            if (batch[i] == NULL)
+                continue;
+            const ht_entry *home = &table->entries[hashes[i] & mask];
+            if (home->key != NULL && home->hash == (uint32_t)hashes[i] && home->key != home->inl)
+                HT_PREFETCH((const char *)(table->key_base + (uintptr_t)home->key));
+        }
+
+        for (size_t i = 0; i < count; i++)
+            values[base + i] = batch[i] != NULL ? ht_lookup(table, batch[i], lengths[i], hashes[i]) : NULL;
+    }
 }
 
 /*
- * ht_iterator
+ * ht_copy_key_to
  * ----------
- * Initializes and returns a new hashtable iterator.
+ * Copies a key for an entry as ht_copy_key does, with the table's flags, into the given
+ * arena (ht_bulk_load threads each fill their own).
+ * Returns the copy, or NULL if memory allocation fails.
  */
-hti ht_iterator(ht *table)
+static const char *ht_copy_key_to(unsigned flags, ht_arena *arena, ht_entry *entry, const char *key, size_t length)
 {
-    hti it;
-    it._table = table;
-    it._index = 0;
-    it.key = NULL;
-    it.value = NULL;
-    return it;
+    char *copy;
+    if ((flags & HT_KEY_INLINE) && length < INLINE_KEY_SIZE)
+        copy = entry->inl;
+    else if (flags & HT_KEY_ARENA)
+        copy = arena_alloc(arena, length + 1);
+    else
+        copy = malloc(length + 1);
+
+    if (copy == NULL)
+        return NULL;
+    memcpy(copy, key, length);
+    copy[length] = '\0';
+    return copy;
 }
 
 /*
- * ht_next
+ * ht_copy_key
  * ----------
- * Advances the iterator to the next entry in the hashtable.
- * Returns true if there is a next entry, false otherwise.
- * Updates the iterator's key and value fields.
+ * Makes the table's own copy of a new key of length bytes for the given entry, according to the
+ * table's key storage: inside the entry (HT_KEY_INLINE, short keys only), in the key arena
+ * (HT_KEY_ARENA), or with malloc. The copy is NUL-terminated, so string keys stay C strings.
+ * Returns the copy, or NULL if memory allocation fails.
  */
-bool ht_next(hti *it)
+static const char *ht_copy_key(ht *table, ht_entry *entry, const char *key, size_t length)
 {
-    if (it == NULL || it->_table == NULL)
-        return false;
+    const char *copy = ht_copy_key_to(table->flags, &table->arena, entry, key, length);
+    HT_COUNT(table->counters.key_bytes += copy != NULL && copy != entry->inl ? length + 1 : 0);
+    return copy;
+}
 
-    ht *table = (ht *)it->_table;
+/*
+ * ht_set_entry
+ * ----------
+ * Helper function to set a new entry or update an existing one in the table's entries.
+ * The caller passes the length and hash of key.
+ * When the key is new, it is copied with ht_copy_key and the length counter is incremented.
+ * Returns a pointer to the stored key string on success, NULL on failure (e.g., malloc fails).
+ */
+static const char *ht_set_entry(ht *table, const char *key, size_t length, uint64_t hash, void *value)
+{
+    HT_COUNT(table->counters.sets++);
+    bool found;
 
-    while (it->_index < table->capacity)
+    // A key that is still in the old array of an incremental resize is updated in place
+    if (table->old_entries != NULL)
     {
-        size_t i = it->_index;
-        it->_index++;
-
-        if (table->entries[i].key != NULL)
+        size_t old_index = ht_probe(table, table->old_entries, table->old_capacity, key, length, hash, &found);
+        HT_COUNT(table->counters.set_probes += ht_probed(old_index, hash, table->old_capacity));
+        if (found)
         {
-            ht_entry entry = table->entries[i];
-            it->key = entry.key;
-            it->value = entry.value;
-            return true;
+            table->old_entries[old_index].value = value;
+            return table->old_entries[old_index].key;
         }
     }
 
-    it->key = NULL; // No more entries, clear iterator's key and value
-    it->value = NULL;
-    return false;
-}
+    ht_entry *entries = table->entries;
+    size_t index = ht_probe(table, entries, table->capacity, key, length, hash, &found);
+    HT_COUNT(table->counters.set_probes += ht_probed(index, hash, table->capacity));
+    if (found)
+    {
+        entries[index].value = value;
+        return entries[index].key;
+    }
 
-int main(void) {}
\ No newline at end of file
+    // With HT_ROBIN_HOOD the slot may belong to an entry closer to home: move it out of the way first
+    ht_entry displaced;
+    bool displacing = entries[index].key != NULL;
+    if (displacing)
+    {
+        ht_move_entry(&displaced, &entries[index]);
+        entries[index].key = NULL;
+    }
+
+    // This is a new unique key: the table copies it to own its memory
+    const char *new_key_copy = ht_copy_key(table, &entries[index], key, length);
+    if (new_key_copy == NULL)
+    {
+        if (displacing)
+            ht_move_entry(&entries[index], &displaced);
+        return NULL;
+    }
+
+    table->length++;
+    HT_COUNT(table->counters.set_inserts++);
+
+    entries[index].key = new_key_copy;
+    entries[index].value = value;
+    entries[index].hash = (uint32_t)hash;
+    entries[index].length = (uint32_t)length;
+
+    // The displaced entry is closer to home than the new key, so it takes a later slot
+    if (displacing)
+        ht_place(entries, table->capacity, &displaced, true);
+    return new_key_copy;
+}
+
+/*
+ * ht_resize
+ * ----------
+ * Moves the table to a new, larger array of new_capacity slots.
+ * When incremental is false all existing entries are rehashed right away.
+ * Otherwise the old array is kept, and ht_migrate moves its entries over a little at a time.
+ * Returns true on success, false on failure (e.g., memory allocation fails).
+ */
+static bool ht_resize(ht *table, size_t new_capacity, bool incremental)
+{
+    ht_entry *new_entries = calloc(new_capacity, sizeof(ht_entry));
+    if (new_entries == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for new hashtable entries.\n");
+        return false;
+    }
+
+    // Only one resize at a time: finish the previous one if it hasn't caught up
+    if (table->old_entries != NULL)
+        ht_migrate(table, SIZE_MAX);
+
+    if (incremental)
+    {
+        // Start migrating at an empty slot so no cluster is split.
+        // There always is one, since max_length < capacity.
+        size_t start = 0;
+        while (table->entries[start].key != NULL)
+            start++;
+
+        table->old_entries = table->entries;
+        table->old_capacity = table->capacity;
+        table->migrate_pos = start;
+        table->migrate_left = table->capacity;
+        table->entries = new_entries;
+        ht_set_capacity(table, new_capacity);
+        return true;
+    }
+
+    // Rehash all existing entries from the old table into the new table
+    bool robin_hood = table->flags & HT_ROBIN_HOOD;
+    for (size_t i = 0; i < table->capacity; i++)
+    {
+        // Reinsert the entry into the new array using its cached hash.
+        // Keys are unique and already owned, so there is no need to look for them.
+        if (table->entries[i].key != NULL)
+            ht_place(new_entries, new_capacity, &table->entries[i], robin_hood);
+    }
+
+    // Free the old entries array and update the table with the new array
+    free(table->entries);
+    table->entries = new_entries;
+    ht_set_capacity(table, new_capacity);
+
+    return true;
+}
+
+/*
+ * ht_expand
+ * ----------
+ * Doubles the capacity of the hashtable, incrementally with HT_INCREMENTAL.
+ * Returns true on success, false on failure (e.g., memory allocation fails).
+ */
+static bool ht_expand(ht *table)
+{
+    size_t new_capacity = table->capacity * 2;
+    if (new_capacity < table->capacity || (uint64_t)new_capacity > MAX_CAPACITY)
+    {
+        fprintf(stderr, "Error: Hashtable capacity overflow during expansion.\n");
+        return false;
+    }
+
+#ifdef HT_INSTRUMENT
+    uint64_t start = ht_now_ns();
+    bool resized = ht_resize(table, new_capacity, table->flags & HT_INCREMENTAL);
+    table->counters.expand_ns += ht_now_ns() - start;
+    table->counters.expansions += resized;
+    return resized;
+#else
+    return ht_resize(table, new_capacity, table->flags & HT_INCREMENTAL);
+#endif
+}
+
+/*
+ * ht_reserve
+ * ----------
+ * Grows the table so that it holds length entries without expanding again.
+ * Always rehashes at once, even with HT_INCREMENTAL: reserving is meant to be done up front.
+ * Returns true on success, false on failure.
+ */
+bool ht_reserve(ht *table, size_t length)
+{
+    if (table == NULL)
+        return false;
+    if (table->map != NULL)
+    {
+        fprintf(stderr, "Error: Hashtable snapshots loaded with ht_load are read-only.\n");
+        return false;
+    }
+
+    size_t capacity = ht_capacity_for(length, table->max_load);
+    if (capacity == 0)
+    {
+        fprintf(stderr, "Error: Hashtable capacity overflow.\n");
+        return false;
+    }
+    if (capacity <= table->capacity)
+        return true;
+
+    return ht_resize(table, capacity, false);
+}
+
+/*
+ * ht_set_hashed
+ * ----------
+ * Sets a key whose length and hash are already known, migrating and expanding the table first as needed.
+ * Returns a pointer to the stored key string on success, NULL on failure.
+ */
+static const char *ht_set_hashed(ht *table, const char *key, size_t length, uint64_t hash, void *value)
+{
+    if (table->map != NULL)
+    {
+        fprintf(stderr, "Error: Hashtable snapshots loaded with ht_load are read-only.\n");
+        return NULL;
+    }
+    if (length > MAX_KEY_LENGTH)
+    {
+        fprintf(stderr, "Error: Hashtable key too long.\n");
+        return NULL;
+    }
+
+    if (table->old_entries != NULL)
+        ht_migrate(table, MIGRATE_STEP);
+
+    // Check if the table needs to expand. Load factor is length / capacity.
+    // Expand when length reaches max_load (50% by default) of capacity to maintain good performance.
+    if (table->length >= table->max_length)
+    {
+        if (!ht_expand(table))
+            return NULL;
+    }
+
+    return ht_set_entry(table, key, length, hash, value);
+}
+
+/** Set value in the table.
+ * This function takes the table, the value to map to the key, and of course the key.
+ * Its main function it's to check wheter the inserted value is valid.
+ * After the insertion we check for the size of the table, and we decide wether to expand it or not.
+ * Setting the value to the table is delegated to the ht_set_hashed helper function,
+ * which expands the table with ht_expand when needed.
+ * Returns a pointer to the stored key string on success, NULL on failure.
+ */
+const char *ht_set(ht *table, const char *key, void *value)
+{
+    if (key == NULL)
+        return NULL;
+    return ht_set_n(table, key, strlen(key), value);
+}
+
+/*
+ * ht_set_n
+ * ----------
+ * Sets a key of length bytes, which may contain NUL bytes and needn't be NUL-terminated.
+ * The table's copy gets a NUL appended, so it can still be used as a string when it is one.
+ * Returns a pointer to the stored key on success, NULL on failure.
+ */
+const char *ht_set_n(ht *table, const void *key, size_t length, void *value)
+{
+    assert(value != NULL); // (debug builds)
+    if (table == NULL || key == NULL || value == NULL)
+        return NULL;
+
+    return ht_set_hashed(table, key, length, ht_hash(table, key, length), value);
+}
+
+/*
+ * ht_set_many
+ * ----------
+ * Sets n keys to their values, in order, hashing and prefetching the home slots
+ * of each batch before inserting it.
+ * Returns the number of keys set: less than n if a key could not be stored
+ * (NULL key or value, or out of memory), in which case the following keys are not set.
+ */
+size_t ht_set_many(ht *table, const char *const *keys, void *const *values, size_t n)
+{
+    if (table == NULL || keys == NULL || values == NULL)
+        return 0;
+
+    uint64_t hashes[HT_BATCH];
+    size_t lengths[HT_BATCH];
+    for (size_t base = 0; base < n; base += HT_BATCH)
+    {
+        size_t count = n - base < HT_BATCH ? n - base : HT_BATCH;
+        const char *const *batch = keys + base;
+
+        // An expansion while inserting the batch only wastes the remaining prefetches
+        size_t mask = table->capacity - 1;
+        // Only the keys before a NULL key or value are set
+        size_t valid = 0;
+        while (valid < count && batch[valid] != NULL && values[base + valid] != NULL)
+            valid++;
+        assert(valid == count || batch[valid] == NULL); // NULL values: debug builds stop here, as in ht_set
+
+        for (size_t i = 0; i < valid; i++)
+        {
+            lengths[i] = strlen(batch[i]);
+            hashes[i] = ht_hash(table, batch[i], lengths[i]);
+            HT_PREFETCH(&table->entries[hashes[i] & mask]);
+        }
+
+        for (size_t i = 0; i < valid; i++)
+        {
+            if (ht_set_hashed(table, batch[i], lengths[i], hashes[i], values[base + i]) == NULL)
+                return base + i;
+        }
+        if (valid < count)
+            return base + valid;
+    }
+    return n;
+}
+
+// --- Bulk Load ---
+// Regions are the slices of the entries array filled by one ht_bulk_load thread at a time.
+// Keys homed near the end of a region may belong past it: those spill over and are inserted
+// after the threads are done, so regions must be large for spills to stay rare.
+#define BULK_MIN_REGION 4096
+#define BULK_REGIONS_PER_THREAD 8
+
+#ifdef HT_HAVE_THREADS
+typedef struct
+{
+    ht *table;
+    const char *const *keys;
+    void *const *values;
+    size_t n;
+    uint64_t *hashes;     // Hash of every key
+    size_t *order;        // Key indexes grouped by region, in input order within each region
+    size_t *counts;       // Per thread and region: keys counted, then scatter positions
+    size_t *region_start; // Region r holds order[region_start[r] .. region_start[r + 1])
+    size_t regions;
+    unsigned shift; // Home slot >> shift is the region
+    unsigned threads;
+    atomic_size_t next_region;
+    atomic_bool failed;
+} ht_bulk;
+
+typedef struct
+{
+    ht_bulk *bulk;
+    unsigned id;
+    pthread_t thread;
+    ht_arena arena;  // HT_KEY_ARENA copies made by this thread
+    size_t inserted; // New keys stored in the entries array
+    uint64_t key_bytes;
+
+    // Keys and displaced entries that ran into the end of their region.
+    // A spilled entry with an inline key has a NULL key, as it moves when the array grows.
+    size_t *spilled_keys;
+    size_t spilled_key_count, spilled_key_size;
+    ht_entry *spilled_entries;
+    size_t spilled_entry_count, spilled_entry_size;
+} ht_bulk_worker;
+
+// Region of the home slot of hash
+static inline size_t ht_bulk_region(const ht_bulk *bulk, uint64_t hash)
+{
+    return (size_t)(hash & (uint64_t)(bulk->table->capacity - 1)) >> bulk->shift;
+}
+
+/*
+ * ht_bulk_hash
+ * ----------
+ * Phase 1, on the thread's share of the keys: checks and hashes them, and counts
+ * how many fall into each region.
+ */
+static void *ht_bulk_hash(void *arg)
+{
+    ht_bulk_worker *worker = arg;
+    ht_bulk *bulk = worker->bulk;
+    size_t *counts = bulk->counts + (size_t)worker->id * bulk->regions;
+    size_t begin = bulk->n / bulk->threads * worker->id, end = bulk->n / bulk->threads * (worker->id + 1);
+    if (worker->id == bulk->threads - 1)
+        end = bulk->n;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        if (bulk->keys[i] == NULL || bulk->values[i] == NULL)
+        {
+            atomic_store(&bulk->failed, true);
+            return NULL;
+        }
+        size_t length = strlen(bulk->keys[i]);
+        if (length > MAX_KEY_LENGTH)
+        {
+            atomic_store(&bulk->failed, true);
+            return NULL;
+        }
+        bulk->hashes[i] = ht_hash(bulk->table, bulk->keys[i], length);
+        counts[ht_bulk_region(bulk, bulk->hashes[i])]++;
+    }
+    return NULL;
+}
+
+/*
+ * ht_bulk_scatter
+ * ----------
+ * Phase 2, on the same share of the keys: writes their indexes into order, starting
+ * at the positions the prefix sum of the counts gave this thread in each region.
+ */
+static void *ht_bulk_scatter(void *arg)
+{
+    ht_bulk_worker *worker = arg;
+    ht_bulk *bulk = worker->bulk;
+    size_t *positions = bulk->counts + (size_t)worker->id * bulk->regions;
+    size_t begin = bulk->n / bulk->threads * worker->id, end = bulk->n / bulk->threads * (worker->id + 1);
+    if (worker->id == bulk->threads - 1)
+        end = bulk->n;
+
+    for (size_t i = begin; i < end; i++)
+        bulk->order[positions[ht_bulk_region(bulk, bulk->hashes[i])]++] = i;
+    return NULL;
+}
+
+/*
+ * ht_bulk_spill_key / ht_bulk_spill_entry
+ * ----------
+ * Set a key (by index) or an owned entry aside for the final sequential pass.
+ * Return false if out of memory.
+ */
+static bool ht_bulk_spill_key(ht_bulk_worker *worker, size_t i)
+{
+    if (worker->spilled_key_count == worker->spilled_key_size)
+    {
+        size_t size = worker->spilled_key_size > 0 ? worker->spilled_key_size * 2 : 64;
+        size_t *keys = realloc(worker->spilled_keys, size * sizeof(size_t));
+        if (keys == NULL)
+            return false;
+        worker->spilled_keys = keys;
+        worker->spilled_key_size = size;
+    }
+    worker->spilled_keys[worker->spilled_key_count++] = i;
+    return true;
+}
+
+static bool ht_bulk_spill_entry(ht_bulk_worker *worker, const ht_entry *entry)
+{
+    if (worker->spilled_entry_count == worker->spilled_entry_size)
+    {
+        size_t size = worker->spilled_entry_size > 0 ? worker->spilled_entry_size * 2 : 64;
+        ht_entry *entries = realloc(worker->spilled_entries, size * sizeof(ht_entry));
+        if (entries == NULL)
+            return false;
+        worker->spilled_entries = entries;
+        worker->spilled_entry_size = size;
+    }
+    ht_entry *spilled = &worker->spilled_entries[worker->spilled_entry_count++];
+    *spilled = *entry;
+    if (entry->key == entry->inl)
+        spilled->key = NULL;
+    return true;
+}
+
+/*
+ * ht_bulk_carry
+ * ----------
+ * Robin Hood placement of an entry displaced from slot index - 1, as ht_place
+ * does, that stops at the end of the region and spills what it still carries.
+ * Returns false if out of memory.
+ */
+static bool ht_bulk_carry(ht_bulk_worker *worker, const ht_entry *entry, size_t index, size_t end)
+{
+    ht_entry *entries = worker->bulk->table->entries;
+    size_t mask = worker->bulk->table->capacity - 1;
+    ht_entry carry;
+    ht_move_entry(&carry, entry);
+
+    for (size_t distance = ht_distance(&carry, index, mask); index < end; index++, distance++)
+    {
+        if (entries[index].key == NULL)
+        {
+            ht_move_entry(&entries[index], &carry);
+            return true;
+        }
+        size_t resident = ht_distance(&entries[index], index, mask);
+        if (resident < distance)
+        {
+            ht_entry displaced;
+            ht_move_entry(&displaced, &entries[index]);
+            ht_move_entry(&entries[index], &carry);
+            ht_move_entry(&carry, &displaced);
+            distance = resident;
+        }
+    }
+    return ht_bulk_spill_entry(worker, &carry);
+}
+
+/*
+ * ht_bulk_insert
+ * ----------
+ * Inserts key i into its region as ht_set_entry would, never probing past the end
+ * of the region: a key that would is spilled instead. Later duplicates of a spilled
+ * key spill too (slots only fill up, and with HT_ROBIN_HOOD only get poorer entries),
+ * so the sequential pass applies them in order.
+ * Returns false if out of memory.
+ */
+static bool ht_bulk_insert(ht_bulk_worker *worker, size_t i, size_t end)
+{
+    ht *table = worker->bulk->table;
+    const char *key = worker->bulk->keys[i];
+    size_t length = strlen(key);
+    uint64_t hash = worker->bulk->hashes[i];
+    bool robin_hood = table->flags & HT_ROBIN_HOOD;
+    size_t mask = table->capacity - 1;
+    ht_entry *entries = table->entries;
+
+    size_t index = (size_t)(hash & (uint64_t)mask);
+    for (size_t distance = 0;; index++, distance++)
+    {
+        if (index == end)
+            return ht_bulk_spill_key(worker, i);
+        if (entries[index].key == NULL)
+            break;
+        if (entries[index].hash == (uint32_t)hash && entries[index].length == length &&
+            memcmp(key, entries[index].key, length) == 0)
+        {
+            entries[index].value = worker->bulk->values[i];
+            return true;
+        }
+        if (robin_hood && ht_distance(&entries[index], index, mask) < distance)
+            break;
+    }
+
+    ht_entry displaced;
+    bool displacing = entries[index].key != NULL;
+    if (displacing)
+    {
+        ht_move_entry(&displaced, &entries[index]);
+        entries[index].key = NULL;
+    }
+
+    const char *copy = ht_copy_key_to(table->flags, &worker->arena, &entries[index], key, length);
+    if (copy == NULL)
+    {
+        if (displacing)
+            ht_move_entry(&entries[index], &displaced);
+        return false;
+    }
+    worker->key_bytes += copy != entries[index].inl ? length + 1 : 0;
+    worker->inserted++;
+
+    entries[index].key = copy;
+    entries[index].value = worker->bulk->values[i];
+    entries[index].hash = (uint32_t)hash;
+    entries[index].length = (uint32_t)length;
+    return !displacing || ht_bulk_carry(worker, &displaced, index + 1, end);
+}
+
+/*
+ * ht_bulk_build
+ * ----------
+ * Phase 3: takes regions one at a time until none are left, and inserts their keys.
+ * Threads only ever write slots of the regions they took.
+ */
+static void *ht_bulk_build(void *arg)
+{
+    ht_bulk_worker *worker = arg;
+    ht_bulk *bulk = worker->bulk;
+
+    for (;;)
+    {
+        size_t region = atomic_fetch_add(&bulk->next_region, 1);
+        if (region >= bulk->regions || atomic_load(&bulk->failed))
+            return NULL;
+
+        size_t end = (region + 1) << bulk->shift;
+        for (size_t k = bulk->region_start[region]; k < bulk->region_start[region + 1]; k++)
+        {
+            if (!ht_bulk_insert(worker, bulk->order[k], end))
+            {
+                atomic_store(&bulk->failed, true);
+                return NULL;
+            }
+        }
+    }
+}
+
+/*
+ * ht_bulk_run
+ * ----------
+ * Runs a phase on every worker, the first one on the calling thread, and waits for all.
+ * A worker whose thread can't be started runs on the calling thread too.
+ */
+static void ht_bulk_run(ht_bulk_worker *workers, unsigned threads, void *(*phase)(void *))
+{
+    bool *started = calloc(threads, sizeof(bool));
+    if (started == NULL)
+    {
+        // No room to track threads: run every worker here, one after the other
+        for (unsigned t = 0; t < threads; t++)
+            phase(&workers[t]);
+        return;
+    }
+
+    for (unsigned t = 1; t < threads; t++)
+        started[t] = pthread_create(&workers[t].thread, NULL, phase, &workers[t]) == 0;
+
+    phase(&workers[0]);
+    for (unsigned t = 1; t < threads; t++)
+    {
+        if (started[t])
+            pthread_join(workers[t].thread, NULL);
+        else
+            phase(&workers[t]);
+    }
+    free(started);
+}
+
+/*
+ * ht_bulk_finish
+ * ----------
+ * Hands the threads' arenas and counts over to the table, places the spilled entries,
+ * then inserts the spilled keys in order with ht_set_entry (unless the build failed).
+ * Returns false if the build failed.
+ */
+static bool ht_bulk_finish(ht_bulk *bulk, ht_bulk_worker *workers)
+{
+    ht *table = bulk->table;
+    bool ok = !atomic_load(&bulk->failed);
+    size_t spilled = 0;
+
+    for (unsigned t = 0; t < bulk->threads; t++)
+    {
+        ht_bulk_worker *worker = &workers[t];
+        arena_merge(&table->arena, &worker->arena);
+        table->length += worker->inserted;
+        HT_COUNT(table->counters.set_inserts += worker->inserted; table->counters.key_bytes += worker->key_bytes);
+
+        for (size_t k = 0; k < worker->spilled_entry_count; k++)
+        {
+            ht_entry *entry = &worker->spilled_entries[k];
+            if (entry->key == NULL)
+                entry->key = entry->inl;
+            ht_place(table->entries, table->capacity, entry, table->flags & HT_ROBIN_HOOD);
+        }
+        spilled += worker->spilled_key_count;
+    }
+    HT_COUNT(table->counters.sets += bulk->n - spilled);
+
+    for (unsigned t = 0; t < bulk->threads && ok; t++)
+    {
+        for (size_t k = 0; k < workers[t].spilled_key_count && ok; k++)
+        {
+            size_t i = workers[t].spilled_keys[k];
+            ok = ht_set_entry(table, bulk->keys[i], strlen(bulk->keys[i]), bulk->hashes[i], bulk->values[i]) != NULL;
+        }
+    }
+    return ok;
+}
+#endif
+
+/*
+ * ht_bulk_load
+ * ----------
+ * Creates a table with the given options and room for n keys, and sets keys[i] to
+ * values[i] on up to threads threads (0 for one per online CPU).
+ * The keys are hashed in parallel, grouped by the region of the entries array their
+ * home slot falls in (the top bits of the home slot), and each thread then fills whole
+ * regions. Keys of a region are inserted in input order, so duplicates end up with
+ * their last value, as with ht_set_many. Small tables are built with ht_set_many.
+ * Returns the table, or NULL on failure (NULL key or value, options, out of memory).
+ */
+ht *ht_bulk_load(const ht_options *opts, const char *const *keys, void *const *values, size_t n, unsigned threads)
+{
+    if (keys == NULL || values == NULL)
+        return NULL;
+
+    ht_options sized = opts != NULL ? *opts : (ht_options){0};
+    if (sized.capacity < n)
+        sized.capacity = n;
+    ht *table = ht_create_opts(&sized);
+    if (table == NULL)
+        return NULL;
+
+#ifdef HT_HAVE_THREADS
+    if (threads == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned)online : 1;
+    }
+
+    // A few regions per thread, so that threads finishing early pick up more
+    size_t regions = 1;
+    while (regions < (size_t)threads * BULK_REGIONS_PER_THREAD && table->capacity / (regions * 2) >= BULK_MIN_REGION)
+        regions *= 2;
+    if (threads > regions)
+        threads = (unsigned)regions;
+
+    if (threads > 1)
+    {
+        ht_bulk bulk;
+        bulk.table = table;
+        bulk.keys = keys;
+        bulk.values = values;
+        bulk.n = n;
+        bulk.regions = regions;
+        bulk.shift = 0;
+        while (((size_t)1 << bulk.shift) < table->capacity / regions)
+            bulk.shift++;
+        bulk.threads = threads;
+        atomic_init(&bulk.next_region, 0);
+        atomic_init(&bulk.failed, false);
+        bulk.hashes = malloc(n * sizeof(uint64_t));
+        bulk.order = malloc(n * sizeof(size_t));
+        bulk.counts = calloc((size_t)threads * regions, sizeof(size_t));
+        bulk.region_start = malloc((regions + 1) * sizeof(size_t));
+        ht_bulk_worker *workers = calloc(threads, sizeof(ht_bulk_worker));
+
+        bool ok = bulk.hashes != NULL && bulk.order != NULL && bulk.counts != NULL && bulk.region_start != NULL &&
+                  workers != NULL;
+        if (ok)
+        {
+            for (unsigned t = 0; t < threads; t++)
+            {
+                workers[t].bulk = &bulk;
+                workers[t].id = t;
+            }
+
+            ht_bulk_run(workers, threads, ht_bulk_hash);
+            ok = !atomic_load(&bulk.failed);
+        }
+        if (ok)
+        {
+            // Prefix sum, region by region: each thread's keys of a region follow the previous thread's
+            size_t position = 0;
+            for (size_t r = 0; r < regions; r++)
+            {
+                bulk.region_start[r] = position;
+                for (unsigned t = 0; t < threads; t++)
+                {
+                    size_t count = bulk.counts[(size_t)t * regions + r];
+                    bulk.counts[(size_t)t * regions + r] = position;
+                    position += count;
+                }
+            }
+            bulk.region_start[regions] = position;
+
+            ht_bulk_run(workers, threads, ht_bulk_scatter);
+            ht_bulk_run(workers, threads, ht_bulk_build);
+            ok = ht_bulk_finish(&bulk, workers);
+        }
+
+        for (unsigned t = 0; workers != NULL && t < threads; t++)
+        {
+            arena_free(&workers[t].arena); // Empty unless the build never got to ht_bulk_finish
+            free(workers[t].spilled_keys);
+            free(workers[t].spilled_entries);
+        }
+        free(workers);
+        free(bulk.region_start);
+        free(bulk.counts);
+        free(bulk.order);
+        free(bulk.hashes);
+
+        if (!ok)
+        {
+            ht_destroy(table);
+            return NULL;
+        }
+        return table;
+    }
+#else
+    (void)threads;
+#endif
+
+    if (ht_set_many(table, keys, values, n) != n)
+    {
+        ht_destroy(table);
+        return NULL;
+    }
+    return table;
+}
+
+/*
+ * ht_remove_at
+ * ----------
+ * Empties slot index of an entries array with backward-shift deletion.
+ * Each following entry of the cluster moves back into the hole unless that would
+ * place it before its home slot, so every probe sequence stays unbroken.
+ */
+static void ht_remove_at(ht_entry *entries, size_t capacity, size_t index)
+{
+    size_t mask = capacity - 1;
+    size_t hole = index;
+
+    for (size_t next = (hole + 1) & mask; entries[next].key != NULL; next = (next + 1) & mask)
+    {
+        // Distance of the entry from its home slot, and from the hole
+        size_t home = (size_t)(entries[next].hash & (uint64_t)mask);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            ht_move_entry(&entries[hole], &entries[next]);
+            hole = next;
+        }
+    }
+
+    entries[hole].key = NULL;
+}
+
+/*
+ * ht_remove
+ * ----------
+ * Removes a key from the hashtable and frees its copy (arena keys stay allocated until ht_destroy).
+ * Returns the value that was stored with the key, or NULL if it was not found.
+ */
+void *ht_remove(ht *table, const char *key)
+{
+    if (key == NULL)
+        return NULL;
+    return ht_remove_n(table, key, strlen(key));
+}
+
+/*
+ * ht_remove_n
+ * ----------
+ * Removes a key of length bytes, like ht_remove.
+ * Returns the value that was stored with the key, or NULL if it was not found.
+ */
+void *ht_remove_n(ht *table, const void *key, size_t length)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+    if (table->map != NULL)
+    {
+        fprintf(stderr, "Error: Hashtable snapshots loaded with ht_load are read-only.\n");
+        return NULL;
+    }
+
+    if (table->old_entries != NULL)
+        ht_migrate(table, MIGRATE_STEP);
+
+    uint64_t hash = ht_hash(table, key, length);
+    ht_entry *entries = table->entries;
+    size_t capacity = table->capacity;
+    bool found;
+    size_t index = ht_probe(table, entries, capacity, key, length, hash, &found);
+
+    // During an incremental resize the key may not have been migrated yet.
+    // Shifting within the old array is safe: migrated slots are all empty.
+    if (!found && table->old_entries != NULL)
+    {
+        entries = table->old_entries;
+        capacity = table->old_capacity;
+        index = ht_probe(table, entries, capacity, key, length, hash, &found);
+    }
+    if (!found)
+        return NULL; // Not found
+
+    void *value = entries[index].value;
+    const char *stored_key = entries[index].key;
+    if (stored_key != entries[index].inl && !(table->flags & HT_KEY_ARENA))
+        free((void *)stored_key);
+
+    ht_remove_at(entries, capacity, index);
+    table->length--;
+    return value;
+}
+
+/*
+ * ht_length
+ * ----------
+ * Returns the current number of key-value pairs stored in the hashtable.
+ */
+size_t ht_length(ht *table)
+{
+    if (table == NULL)
+        return 0;
+    return table->length;
+}
+
+/*
+ * ht_read_counters
+ * ----------
+ * Copies the instrumentation counters of the table into *counters.
+ * Returns false, with *counters zeroed, in builds without HT_INSTRUMENT.
+ */
+bool ht_read_counters(ht *table, ht_counters *counters)
+{
+    if (counters == NULL)
+        return false;
+    memset(counters, 0, sizeof(*counters));
+    if (table == NULL)
+        return false;
+
+#ifdef HT_INSTRUMENT
+    *counters = table->counters;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+ * ht_stats_scan
+ * ----------
+ * Adds the probe distances of the keys in an entries array to *total and *longest.
+ */
+static void ht_stats_scan(const ht_entry *entries, size_t capacity, size_t *total, size_t *longest)
+{
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < capacity; i++)
+    {
+        if (entries[i].key == NULL)
+            continue;
+        size_t distance = ht_distance(&entries[i], i, mask);
+        *total += distance;
+        if (distance > *longest)
+            *longest = distance;
+    }
+}
+
+/*
+ * ht_stats
+ * ----------
+ * Computes the load factor and probe distances of the table with a scan of its slots.
+ * The probe distance of a key is the number of slots between its home slot and its own.
+ */
+ht_statistics ht_stats(ht *table)
+{
+    ht_statistics stats = {0};
+    if (table == NULL)
+        return stats;
+
+    size_t total = 0;
+    ht_stats_scan(table->entries, table->capacity, &total, &stats.max_probe);
+    stats.capacity = table->capacity;
+    if (table->old_entries != NULL)
+    {
+        ht_stats_scan(table->old_entries, table->old_capacity, &total, &stats.max_probe);
+        stats.capacity += table->old_capacity;
+    }
+
+    stats.length = table->length;
+    stats.load_factor = (double)table->length / (double)stats.capacity;
+    stats.mean_probe = table->length > 0 ? (double)total / (double)table->length : 0;
+    return stats;
+}
+
+// --- Snapshot Format ---
+// A header, the entries array at SNAPSHOT_ALIGN, then every key (NUL-terminated) back to back.
+// Entries are written as they are in memory, so snapshots only load on builds with the
+// same entry layout and byte order; the header records both to reject anything else.
+#define SNAPSHOT_MAGIC "HTSNAP2"
+#define SNAPSHOT_ALIGN 128
+#define SNAPSHOT_BYTE_ORDER 0x0102030405060708ULL
+
+typedef struct
+{
+    char magic[8];        // SNAPSHOT_MAGIC
+    uint32_t entry_size;  // sizeof(ht_entry)
+    uint32_t hash_kind;   // ht_options.hash of the saved table
+    uint32_t flags;       // HT_ROBIN_HOOD if the entries are in Robin Hood order, else 0
+    uint32_t reserved;    // 0
+    uint64_t byte_order;  // SNAPSHOT_BYTE_ORDER, as stored by the writer
+    uint64_t seed;        // Hash seed of the saved table
+    uint64_t capacity;    // Number of entries, a power of 2
+    uint64_t length;      // Number of keys
+    double max_load;      // Load factor of the saved table
+    uint64_t keys_offset; // File offset of the key blob
+    uint64_t file_size;
+} ht_snapshot_header;
+
+_Static_assert(sizeof(ht_snapshot_header) <= SNAPSHOT_ALIGN, "snapshot header must fit before the entries");
+
+/*
+ * ht_save
+ * ----------
+ * Writes the table as a snapshot: entries keep their slots, so the loaded table probes
+ * exactly like this one, and their key pointers become file offsets into the key blob.
+ * An incremental resize in progress is completed first, so there is a single array to write.
+ * Returns true on success, false on I/O errors.
+ */
+bool ht_save(ht *table, const char *path)
+{
+    if (table == NULL || path == NULL)
+        return false;
+
+    if (table->old_entries != NULL)
+        ht_migrate(table, SIZE_MAX);
+
+    // Key blob size, to lay out the file before writing anything
+    uint64_t key_bytes = 0;
+    for (size_t i = 0; i < table->capacity; i++)
+    {
+        if (table->entries[i].key != NULL)
+            key_bytes += (uint64_t)table->entries[i].length + 1;
+    }
+
+    ht_snapshot_header header = {0};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.entry_size = sizeof(ht_entry);
+    header.hash_kind = table->hash_kind;
+    header.flags = table->flags & HT_ROBIN_HOOD;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.seed = table->seed;
+    header.capacity = table->capacity;
+    header.length = table->length;
+    header.max_load = table->max_load;
+    header.keys_offset = SNAPSHOT_ALIGN + (uint64_t)table->capacity * sizeof(ht_entry);
+    header.file_size = header.keys_offset + key_bytes;
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: Failed to open snapshot file %s.\n", path);
+        return false;
+    }
+
+    char padding[SNAPSHOT_ALIGN] = {0};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(padding, SNAPSHOT_ALIGN - sizeof(header), 1, file) == 1;
+
+    // Entries, with keys turned into offsets (empty slots stay all zero)
+    uint64_t offset = header.keys_offset;
+    for (size_t i = 0; ok && i < table->capacity; i++)
+    {
+        const ht_entry *entry = &table->entries[i];
+        ht_entry saved = {0};
+        if (entry->key != NULL)
+        {
+            saved.key = (const char *)(uintptr_t)offset;
+            saved.value = entry->value;
+            saved.hash = entry->hash;
+            saved.length = entry->length;
+            offset += (uint64_t)entry->length + 1;
+        }
+        ok = fwrite(&saved, sizeof(saved), 1, file) == 1;
+    }
+
+    // Keys, in the same order, each with its NUL
+    for (size_t i = 0; ok && i < table->capacity; i++)
+    {
+        const ht_entry *entry = &table->entries[i];
+        if (entry->key != NULL)
+        {
+            const char *key = (const char *)(table->key_base + (uintptr_t)entry->key);
+            ok = fwrite(key, (size_t)entry->length + 1, 1, file) == 1;
+        }
+    }
+
+    if (fclose(file) != 0)
+        ok = false;
+    if (!ok)
+        fprintf(stderr, "Error: Failed to write snapshot file %s.\n", path);
+    return ok;
+}
+
+/*
+ * ht_load
+ * ----------
+ * Maps a snapshot file read-only and wraps it in a table: the mapped entries array is
+ * used as is, with key_base pointing at the mapping, so nothing is read up front.
+ * Only the header is validated; the rest of the file is trusted.
+ * Returns the table, or NULL if the file can't be mapped or isn't a compatible snapshot.
+ */
+ht *ht_load(const char *path)
+{
+#ifdef HT_HAVE_MMAP
+    if (path == NULL)
+        return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Error: Failed to open snapshot file %s.\n", path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < SNAPSHOT_ALIGN)
+    {
+        fprintf(stderr, "Error: %s is not a hashtable snapshot.\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid without the descriptor
+    if (map == MAP_FAILED)
+    {
+        fprintf(stderr, "Error: Failed to map snapshot file %s.\n", path);
+        return NULL;
+    }
+
+    ht_snapshot_header header;
+    memcpy(&header, map, sizeof(header));
+    bool valid = memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0 &&
+                 header.entry_size == sizeof(ht_entry) && header.byte_order == SNAPSHOT_BYTE_ORDER &&
+                 header.capacity >= INITIAL_CAPACITY && header.capacity <= MAX_CAPACITY &&
+                 (header.capacity & (header.capacity - 1)) == 0 && header.length < header.capacity &&
+                 header.max_load > 0 && header.max_load < 1 && (header.flags & ~HT_ROBIN_HOOD) == 0 &&
+                 header.keys_offset == SNAPSHOT_ALIGN + header.capacity * sizeof(ht_entry) &&
+                 header.file_size == (uint64_t)size && header.keys_offset <= header.file_size;
+
+    ht_options opts = {0};
+    opts.hash = header.hash_kind;
+    opts.seed = header.seed;
+    ht_hash_fn hash_fn;
+    uint64_t seed;
+    if (!valid || !hash_select(&opts, &hash_fn, &seed))
+    {
+        fprintf(stderr, "Error: %s is not a compatible hashtable snapshot.\n", path);
+        munmap(map, size);
+        return NULL;
+    }
+
+    ht *table = malloc(sizeof(ht));
+    if (table == NULL)
+    {
+        munmap(map, size);
+        return NULL;
+    }
+
+    table->entries = (ht_entry *)((char *)map + SNAPSHOT_ALIGN);
+    table->length = (size_t)header.length;
+    table->max_load = header.max_load;
+    ht_set_capacity(table, (size_t)header.capacity);
+    table->flags = header.flags; // Robin Hood order lets lookups on the mapping stop early too
+    table->arena.head = NULL;
+    table->arena.bytes = 0;
+    table->hash_fn = hash_fn;
+    table->seed = seed;
+    table->hash_kind = header.hash_kind;
+    table->map = map;
+    table->map_size = size;
+    table->key_base = (uintptr_t)map;
+    table->old_entries = NULL;
+    table->old_capacity = 0;
+    table->migrate_pos = 0;
+    table->migrate_left = 0;
+    HT_COUNT(memset(&table->counters, 0, sizeof(table->counters)));
+    return table;
+#else
+    (void)path;
+    fprintf(stderr, "Error: ht_load needs mmap, which this platform doesn't provide.\n");
+    return NULL;
+#endif
+}
+
+/*
+ * ht_iterator
+ * ----------
+ * Initializes and returns a new hashtable iterator.
+ */
+hti ht_iterator(ht *table)
+{
+    hti it;
+    it._table = table;
+    it._index = 0;
+    it._end = SIZE_MAX;
+    it.key = NULL;
+    it.value = NULL;
+    it.length = 0;
+    return it;
+}
+
+/*
+ * ht_iterator_part
+ * ----------
+ * Returns an iterator over part (0 to parts - 1) of the slots of both arrays.
+ */
+hti ht_iterator_part(ht *table, size_t part, size_t parts)
+{
+    hti it = ht_iterator(table);
+    if (table == NULL || parts == 0 || part >= parts)
+    {
+        it._end = 0;
+        return it;
+    }
+    size_t total = table->old_capacity + table->capacity, share = total / parts, extra = total % parts;
+    it._index = part * share + (part < extra ? part : extra);
+    it._end = it._index + share + (part < extra ? 1 : 0);
+    return it;
+}
+
+/*
+ * ht_next
+ * ----------
+ * Advances the iterator to the next entry in the hashtable.
+ * Returns true if there is a next entry, false otherwise.
+ * Updates the iterator's key and value fields.
+ * During an incremental resize the old array is visited first: indexes below
+ * old_capacity are old slots, the following ones are slots of entries.
+ */
+bool ht_next(hti *it)
+{
+    if (it == NULL || it->_table == NULL)
+        return false;
+
+    ht *table = (ht *)it->_table;
+
+    size_t end = table->old_capacity + table->capacity;
+    if (it->_end < end)
+        end = it->_end;
+
+    while (it->_index < end)
+    {
+        size_t i = it->_index;
+        it->_index++;
+
+        const ht_entry *entry = i < table->old_capacity ? &table->old_entries[i]
+                                                        : &table->entries[i - table->old_capacity];
+        if (entry->key != NULL)
+        {
+            it->key = (const char *)(table->key_base + (uintptr_t)entry->key);
+            it->value = entry->value;
+            it->length = entry->length;
+            return true;
+        }
+    }
+
+    it->key = NULL; // No more entries, clear iterator's key and value
+    it->value = NULL;
+    it->length = 0;
+    return false;
+}
@@ -1,9 +1,64 @@
+#ifndef HT_H
+#define HT_H
+
 #include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 typedef struct ht ht;
 
+/** Key storage flags for ht_options.flags */
+#define HT_KEY_ARENA 0x1  /* copy keys into table-owned chunks, all freed at once by ht_destroy */
+#define HT_KEY_INLINE 0x2 /* store short keys (up to 7 bytes) directly in their slot */
+
+/** Resize flag for ht_options.flags (linear-probing table only).
+ *  The table grows without a full rehash: each ht_set/ht_get migrates a few slots
+ *  of the old array, so no single insert pays for rehashing the whole table.
+ *  ht_get then modifies the table too, and must not be called during iteration.
+ */
+#define HT_INCREMENTAL 0x4
+
+/** Probing flag for ht_options.flags (linear-probing table only, not with HT_INCREMENTAL).
+ *  Robin Hood insertion: a new key takes the slot of an entry closer to its home slot,
+ *  which moves further along instead. Probe distances stay short and even, and lookups
+ *  of missing keys stop early, so the table holds up at load factors well above 0.5.
+ */
+#define HT_ROBIN_HOOD 0x8
+
+/** Hash functions for ht_options.hash (see ht_hash.h) */
+#define HT_HASH_FNV1A 0  /* byte-at-a-time FNV-1a, the default */
+#define HT_HASH_WY 1     /* word-at-a-time wyhash-style multiply-mix, fastest on long keys */
+#define HT_HASH_CRC32C 2 /* CRC32C, with the SSE4.2 or ARMv8 CRC instructions when built for them */
+#define HT_HASH_SEEDED 3 /* HT_HASH_WY with a random seed per table (unless seed is set), so
+                            an attacker can't choose keys that collide */
+
+/** Table options for ht_create_opts. A zeroed struct gives the same table as ht_create. */
+typedef struct
+{
+    unsigned flags;  // HT_KEY_*, HT_INCREMENTAL and HT_ROBIN_HOOD flags, 0 for the defaults
+    size_t capacity; // Number of keys to make room for up front, 0 for the minimum
+    double max_load; // Load factor at which the table expands, in (0, 1); 0 for the
+                     // layout default (0.5 for linear probing, 0.875 for the Swiss table)
+    unsigned hash;   // HT_HASH_* function, 0 for FNV-1a
+    uint64_t seed;   // Mixed into every hash, 0 for none (random with HT_HASH_SEEDED)
+} ht_options;
+
+/** Create an empty table with default options, or NULL if out of memory */
 ht *ht_create(void);
 
+/** Create an empty table with the given options (NULL for defaults).
+ *  Return NULL if out of memory or if the options are invalid for this layout.
+ */
+ht *ht_create_opts(const ht_options *opts);
+
+/** Create an empty table with room for capacity keys before its first expansion */
+ht *ht_create_capacity(size_t capacity);
+
+/** Grow the table so that length keys fit without further expansion.
+ *  Return false if out of memory.
+ */
+bool ht_reserve(ht *table, size_t length);
+
 /** Free memory allocated for the table, including allocated keys */
 void ht_destroy(ht *table);
 
@@ -15,27 +70,131 @@ void *ht_get(ht *table, const char *key);
 /** Set item with given key to value (which must not be NULL).
  *  The key is copied to newly allocated memory.
  *  Return the adress of the newly copied key, or NULL if out of memory.
+ *  With HT_KEY_INLINE a short key is copied into its slot, so the returned
+ *  address is only valid until the next call that modifies the table.
  */
 const char *ht_set(ht *table, const char *key, void *value);
 
+/** Remove item with given key from hash table, freeing the table's copy of the key.
+ *  Return value: data that was stored with ht_set, or NULL if not found.
+ */
+void *ht_remove(ht *table, const char *key);
+
+/** Binary-safe variants of ht_get, ht_set and ht_remove: the key is the length bytes at key,
+ *  which may include NUL bytes and needn't be NUL-terminated (e.g. a slice of a network
+ *  buffer, or a 16-byte UUID). A string key set with ht_set is found by ht_get_n with its
+ *  strlen, and the other way round. ht_set_n appends a NUL to the table's copy of the key.
+ *  Keys longer than UINT32_MAX bytes are rejected.
+ */
+void *ht_get_n(ht *table, const void *key, size_t length);
+const char *ht_set_n(ht *table, const void *key, size_t length, void *value);
+void *ht_remove_n(ht *table, const void *key, size_t length);
+
+/** Look up n keys at once, storing the value of keys[i] (or NULL if not found) in values[i].
+ *  Same results as calling ht_get on every key, but the memory accesses of a batch
+ *  of keys are issued together, which pays off on tables much larger than the cache.
+ */
+void ht_get_many(ht *table, const char *const *keys, size_t n, void **values);
+
+/** Set keys[i] to values[i] for i in 0..n-1, in order, as n calls to ht_set would.
+ *  Return the number of keys set: if a key can't be stored (NULL key or value,
+ *  out of memory) the following ones are left out. Call ht_reserve first when
+ *  the number of new keys is known, so the table doesn't expand along the way.
+ */
+size_t ht_set_many(ht *table, const char *const *keys, void *const *values, size_t n);
+
+/** Create a table with the given options (NULL for defaults) holding keys[i] set to values[i]
+ *  for i in 0..n-1, built on up to threads threads, 0 for one per online CPU.
+ *  The result is the same as ht_set_many on a table with room for n keys: when a key
+ *  appears more than once, its last value wins. The linear-probing table splits its
+ *  entries array into regions filled by different threads; other layouts, small tables
+ *  and platforms without threads build it on the calling thread.
+ *  Return NULL if a key or value is NULL, the options are invalid, or out of memory.
+ */
+ht *ht_bulk_load(const ht_options *opts, const char *const *keys, void *const *values, size_t n, unsigned threads);
+
 size_t ht_length(ht *table);
 
+/** Table statistics, as returned by ht_stats */
+typedef struct
+{
+    size_t length;      // Number of keys
+    size_t capacity;    // Number of slots (of both arrays during an incremental resize)
+    double load_factor; // length / capacity
+    double mean_probe;  // Mean probe distance of the stored keys: slots (linear probing) or
+                        // groups (Swiss table) visited past the home one to find the key
+    size_t max_probe;   // Longest probe distance
+} ht_statistics;
+
+/** Compute the statistics of the table. Scans every slot, so it costs as much as iterating. */
+ht_statistics ht_stats(ht *table);
+
+/** Hot-path counters, as returned by ht_read_counters. They are only collected when the
+ *  table layout is compiled with -DHT_INSTRUMENT: other builds have no counters to update.
+ *  Probes count slots (linear probing) or groups (Swiss table) examined.
+ */
+typedef struct
+{
+    uint64_t gets;        // Lookups: ht_get, ht_get_n and every key of ht_get_many
+    uint64_t get_hits;    // Lookups that found their key
+    uint64_t get_probes;  // Probes of all lookups
+    uint64_t sets;        // Sets, inserts and updates: ht_set, ht_set_n and every key of ht_set_many
+    uint64_t set_inserts; // Sets that added a new key
+    uint64_t set_probes;  // Probes of all sets to find the key or the slot for it
+    uint64_t expansions;  // Times the table grew when full
+    uint64_t expand_ns;   // Time spent growing it, in nanoseconds (with HT_INCREMENTAL the
+                          // migration is spread over later calls and not included)
+    uint64_t key_bytes;   // Bytes allocated for key copies, NULs included (inline keys take none)
+} ht_counters;
+
+/** Copy the counters of the table into *counters and return true, or zero them and return
+ *  false if the layout was compiled without HT_INSTRUMENT.
+ *  Instrumented builds also print the counters of every table to stderr when it is
+ *  destroyed, if the HT_COUNTERS environment variable is set.
+ */
+bool ht_read_counters(ht *table, ht_counters *counters);
+
+/** Write the table to a snapshot file at path (linear-probing table only).
+ *  Values are saved as their pointer bits, so only values that don't point into memory
+ *  (integers or indexes cast to void *) mean anything once loaded.
+ *  Return false on I/O errors.
+ */
+bool ht_save(ht *table, const char *path);
+
+/** Map a snapshot written by ht_save read-only, and return it as a table that ht_get,
+ *  ht_get_many and ht_next work on right away: its pages are read as lookups touch them.
+ *  ht_set, ht_remove and ht_reserve fail on it, and ht_destroy unmaps it.
+ *  The file must come from a build with the same entry layout and byte order, and be trusted.
+ *  Return NULL if the file can't be mapped or isn't a compatible snapshot.
+ */
+ht *ht_load(const char *path);
+
 /** Hash Table Iterator: create with ht_iterator, iterate with ht_next */
 typedef struct
 {
     const char *key;
     void *value;
+    size_t length; // Key length in bytes, for keys set with ht_set_n
 
     // don't use these directly
     ht *_table;
     size_t _index;
+    size_t _end;
 } hti;
 
 /** Returns new HT Iterator */
 hti ht_iterator(ht *table);
 
+/** Returns an iterator over part (0 to parts - 1) of the table: the iterators of all parts
+ *  together visit every item once, so parts threads can each walk one of them at the same
+ *  time. Parts are slices of equal size of the slots (or entries), not of the items.
+ */
+hti ht_iterator_part(ht *table, size_t part, size_t parts);
+
 /** Moves iterator to next item in hash table, update iterator's key and value to current item, and return true.
  *  If there are no more items it will return false.
- *  Don't call ht_set during iteration.
+ *  Don't call ht_set or ht_remove during iteration.
  */
 bool ht_next(hti *it);
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef HT_ARENA_H
+#define HT_ARENA_H
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Bump allocator for hashtable keys (HT_KEY_ARENA), shared by the table layouts.
+ * Keys are copied back to back into large chunks owned by the table.
+ * Nothing is freed individually: arena_free releases every chunk at once,
+ * so tearing down a table costs one free per chunk instead of one per key.
+ */
+
+// Size of a regular chunk; keys larger than this get a chunk of their own.
+#define ARENA_CHUNK_SIZE (1 << 20)
+
+typedef struct ht_arena_chunk
+{
+    struct ht_arena_chunk *next;
+    size_t used; // Bytes handed out from data
+    size_t size; // Bytes available in data
+    char data[];
+} ht_arena_chunk;
+
+typedef struct
+{
+    ht_arena_chunk *head; // Chunk currently being filled, NULL until the first copy
+    size_t bytes;         // Total bytes held in chunks, for accounting
+} ht_arena;
+
+/*
+ * arena_new_chunk
+ * ----------
+ * Allocates a chunk with room for at least size bytes.
+ * A regular chunk becomes the new head; an oversized one is linked behind the head,
+ * so the free space left in the head is still used by the following keys.
+ */
+static inline ht_arena_chunk *arena_new_chunk(ht_arena *arena, size_t size)
+{
+    size_t chunk_size = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+    ht_arena_chunk *chunk = malloc(sizeof(ht_arena_chunk) + chunk_size);
+    if (chunk == NULL)
+        return NULL;
+
+    chunk->used = 0;
+    chunk->size = chunk_size;
+    arena->bytes += chunk_size;
+
+    if (chunk_size > ARENA_CHUNK_SIZE && arena->head != NULL)
+    {
+        chunk->next = arena->head->next;
+        arena->head->next = chunk;
+    }
+    else
+    {
+        chunk->next = arena->head;
+        arena->head = chunk;
+    }
+    return chunk;
+}
+
+/*
+ * arena_alloc
+ * ----------
+ * Hands out size bytes (unaligned) from the arena.
+ * Returns their address, or NULL if a new chunk can't be allocated.
+ */
+static inline char *arena_alloc(ht_arena *arena, size_t size)
+{
+    ht_arena_chunk *chunk = arena->head;
+    if (chunk == NULL || chunk->size - chunk->used < size)
+    {
+        chunk = arena_new_chunk(arena, size);
+        if (chunk == NULL)
+            return NULL;
+    }
+
+    char *dst = chunk->data + chunk->used;
+    chunk->used += size;
+    return dst;
+}
+
+/*
+ * arena_copy
+ * ----------
+ * Copies size bytes from src into the arena.
+ * Returns the address of the copy, or NULL if a new chunk can't be allocated.
+ */
+static inline char *arena_copy(ht_arena *arena, const void *src, size_t size)
+{
+    char *dst = arena_alloc(arena, size);
+    if (dst != NULL)
+        memcpy(dst, src, size);
+    return dst;
+}
+
+/*
+ * arena_merge
+ * ----------
+ * Moves every chunk of src into arena, leaving src empty.
+ * The chunks go behind the head of arena, which stays the one being filled.
+ */
+static inline void arena_merge(ht_arena *arena, ht_arena *src)
+{
+    if (src->head == NULL)
+        return;
+
+    if (arena->head == NULL)
+    {
+        arena->head = src->head;
+    }
+    else
+    {
+        ht_arena_chunk *tail = src->head;
+        while (tail->next != NULL)
+            tail = tail->next;
+        tail->next = arena->head->next;
+        arena->head->next = src->head;
+    }
+    arena->bytes += src->bytes;
+    src->head = NULL;
+    src->bytes = 0;
+}
+
+/*
+ * arena_free
+ * ----------
+ * Frees every chunk of the arena, invalidating all copies made from it.
+ */
+static inline void arena_free(ht_arena *arena)
+{
+    ht_arena_chunk *chunk = arena->head;
+    while (chunk != NULL)
+    {
+        ht_arena_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->head = NULL;
+    arena->bytes = 0;
+}
+
+#endif
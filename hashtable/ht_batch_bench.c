@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "ht.h"
+
+/*
+ * Batched lookup benchmark
+ *
+ * Compares ht_get_many against a plain ht_get loop, with either table layout:
+ * gcc -O2 -o ht_batch_bench ht_batch_bench.c ht.c
+ * gcc -O2 -o ht_batch_bench_swiss ht_batch_bench.c ht_swiss.c
+ *
+ * Usage: ./ht_batch_bench [number of keys] [number of lookups]
+ * Defaults to 4000000 keys and 4000000 lookups of random existing keys.
+ * Prefetching only helps when lookups miss the cache, so pick a number of keys
+ * whose table (entries plus key strings) is well beyond the last level cache.
+ * Also compares building the table with ht_set_many and with an ht_set loop.
+ */
+
+#define KEY_SIZE 24
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: cheap random numbers for the lookup order
+static inline uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/*
+ * build_scalar / build_batched
+ * ----------
+ * Create a table holding the n keys, with ht_set one key at a time or with ht_set_many.
+ * Return the table, or NULL on failure.
+ */
+static ht *build_scalar(const char **keys, void **values, size_t n)
+{
+    ht *table = ht_create();
+    if (table == NULL)
+        return NULL;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (ht_set(table, keys[i], values[i]) == NULL)
+        {
+            ht_destroy(table);
+            return NULL;
+        }
+    }
+    return table;
+}
+
+static ht *build_batched(const char **keys, void **values, size_t n)
+{
+    ht *table = ht_create();
+    if (table != NULL && ht_set_many(table, keys, values, n) != n)
+    {
+        ht_destroy(table);
+        return NULL;
+    }
+    return table;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 4000000;
+    size_t lookups = argc > 2 ? strtoull(argv[2], NULL, 10) : 4000000;
+    if (n == 0 || lookups == 0)
+    {
+        fprintf(stderr, "Error: need at least one key and one lookup.\n");
+        return 1;
+    }
+
+    char *buffer = malloc(n * KEY_SIZE);
+    const char **keys = malloc(n * sizeof(char *));
+    void **values = malloc(n * sizeof(void *));
+    const char **order = malloc(lookups * sizeof(char *));
+    void **results = malloc(lookups * sizeof(void *));
+    if (buffer == NULL || keys == NULL || values == NULL || order == NULL || results == NULL)
+    {
+        fprintf(stderr, "Error: out of memory.\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        snprintf(buffer + i * KEY_SIZE, KEY_SIZE, "key%zu", i);
+        keys[i] = buffer + i * KEY_SIZE;
+        values[i] = (void *)(uintptr_t)(i + 1);
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < lookups; i++)
+        order[i] = keys[next_random(&state) % n];
+
+    double start = now_sec();
+    ht *table = build_scalar(keys, values, n);
+    double scalar_build = now_sec() - start;
+    ht_destroy(table);
+
+    start = now_sec();
+    table = build_batched(keys, values, n);
+    double batched_build = now_sec() - start;
+    if (table == NULL)
+    {
+        fprintf(stderr, "Error: failed to build the table.\n");
+        return 1;
+    }
+
+    printf("%zu keys, %zu random lookups\n", n, lookups);
+    printf("build: ht_set %.2f ns/key, ht_set_many %.2f ns/key\n",
+           scalar_build * 1e9 / (double)n, batched_build * 1e9 / (double)n);
+
+    // The scalar loop doesn't depend on the batch size, time it once
+    start = now_sec();
+    size_t found = 0;
+    for (size_t i = 0; i < lookups; i++)
+        found += ht_get(table, order[i]) != NULL;
+    double scalar = now_sec() - start;
+    if (found != lookups)
+        fprintf(stderr, "Error: %zu keys missing.\n", lookups - found);
+
+    printf("%8s %14s %14s %10s\n", "batch", "ht_get ns", "get_many ns", "speedup");
+    for (size_t batch = 8; batch <= 1024; batch *= 2)
+    {
+        start = now_sec();
+        for (size_t i = 0; i < lookups; i += batch)
+            ht_get_many(table, order + i, lookups - i < batch ? lookups - i : batch, results + i);
+        double batched = now_sec() - start;
+
+        for (size_t i = 0; i < lookups; i++)
+        {
+            if (results[i] == NULL)
+            {
+                fprintf(stderr, "Error: key %s missing from ht_get_many.\n", order[i]);
+                break;
+            }
+        }
+
+        printf("%8zu %14.2f %14.2f %9.2fx\n", batch, scalar * 1e9 / (double)lookups,
+               batched * 1e9 / (double)lookups, scalar / batched);
+    }
+
+    ht_destroy(table);
+    free(results);
+    free(order);
+    free(values);
+    free(keys);
+    free(buffer);
+    return 0;
+}
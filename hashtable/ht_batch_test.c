@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "ht.h"
+
+/*
+ * ht_set_many test
+ *
+ * Checks that a batch stopping at a NULL key sets exactly the keys before it, with each layout:
+ * gcc -o ht_batch_test ht_batch_test.c ht.c && ./ht_batch_test
+ * gcc -o ht_batch_test_swiss ht_batch_test.c ht_swiss.c && ./ht_batch_test_swiss
+ * gcc -o ht_batch_test_dense ht_batch_test.c ht_dense.c && ./ht_batch_test_dense
+ *
+ * Exits with 0 if every check passes, 1 otherwise.
+ */
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    if (!ok)
+    {
+        fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    // NULL in the middle of the first batch
+    const char *keys[] = {"a", "b", "c", NULL, "d"};
+    void *values[] = {(void *)1, (void *)2, (void *)3, (void *)4, (void *)5};
+    ht *table = ht_create();
+    check(table != NULL, "ht_create");
+    check(ht_set_many(table, keys, values, 5) == 3, "ht_set_many returns the keys before the NULL");
+    check(ht_length(table) == 3, "the keys before the NULL are set");
+    check(ht_get(table, "a") == (void *)1 && ht_get(table, "c") == (void *)3, "their values are stored");
+    check(ht_get(table, "d") == NULL, "the keys after the NULL are left out");
+    ht_destroy(table);
+
+    // NULL in the middle of a later batch: every key of the earlier batches is set
+    enum { N = 100, BAD = 57 };
+    const char *many[N];
+    void *many_values[N];
+    char names[N][8];
+    for (int i = 0; i < N; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "k%d", i);
+        many[i] = i == BAD ? NULL : names[i];
+        many_values[i] = (void *)(uintptr_t)(i + 1);
+    }
+    table = ht_create();
+    check(ht_set_many(table, many, many_values, N) == BAD, "ht_set_many stops at the NULL of a later batch");
+    check(ht_length(table) == BAD, "all keys before it are set");
+    check(ht_get(table, names[BAD - 1]) == (void *)(uintptr_t)BAD, "the last key before it is set");
+    check(ht_get(table, names[BAD + 1]) == NULL, "the first key after it is left out");
+    ht_destroy(table);
+
+    if (failures == 0)
+        printf("ht_set_many: all checks passed\n");
+    return failures == 0 ? 0 : 1;
+}
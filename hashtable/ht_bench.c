@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "ht.h"
+
+/*
+ * Hashtable benchmark
+ *
+ * Links against either table layout, so the same workload can be compared:
+ * gcc -O2 -o ht_bench ht_bench.c ht.c
+ * gcc -O2 -o ht_bench_swiss ht_bench.c ht_swiss.c
+ * gcc -O2 -o ht_bench_dense ht_bench.c ht_dense.c
+ *
+ * Usage: ./ht_bench [number of keys] [arena] [inline] [incremental] [robin] [reserve] [load=<factor>]
+ *                   [churn=<rounds>] [hash=fnv1a|wy|crc32c|seeded] [snapshot=<path>] [bulk=<threads>]
+ * Defaults to 1000000 keys stored with strdup, growing from the minimum capacity
+ * at the layout's default load factor and resized all at once.
+ * The insert workload also reports per-insert latency percentiles, where
+ * a full ht_expand shows up as the max (and p999 on small tables), followed by
+ * the ht_stats of the full table. robin sets HT_ROBIN_HOOD: compare it with the
+ * default at load=0.8 or 0.9, where plain linear probing clusters badly.
+ *
+ * churn=<rounds> then keeps the table at a steady size: every round removes the
+ * oldest n keys and inserts n new ones, and reports the lookup cost afterwards,
+ * which should stay flat however many rounds run.
+ *
+ * Built with -DHT_INSTRUMENT, it also prints the table's hot-path counters after the lookups.
+ *
+ * snapshot=<path> saves the table there with ht_save, then times ht_load and a first
+ * round of lookups on the mapped table (which fault its pages in), to compare with
+ * the time it took to build the table with ht_set.
+ *
+ * bulk=<threads> builds the same keys with ht_bulk_load, on 1 thread and then on <threads>
+ * (0 for one per CPU), and checks them with a 4-part ht_iterator_part walk. Link with -pthread.
+ */
+
+#define KEY_SIZE 24
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*
+ * make_keys
+ * ----------
+ * Formats n keys "<prefix><i>" into one contiguous buffer of KEY_SIZE bytes per key.
+ */
+static char *make_keys(size_t n, const char *prefix)
+{
+    char *keys = malloc(n * KEY_SIZE);
+    if (keys == NULL)
+        return NULL;
+    for (size_t i = 0; i < n; i++)
+        snprintf(keys + i * KEY_SIZE, KEY_SIZE, "%s%zu", prefix, i);
+    return keys;
+}
+
+static void report(const char *name, size_t ops, double seconds)
+{
+    printf("%-16s %12zu ops %10.2f ns/op %10.2f Mops/s\n",
+           name, ops, seconds * 1e9 / (double)ops, (double)ops / seconds / 1e6);
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * report_latency
+ * ----------
+ * Sorts n per-operation latencies (in ns) and prints their percentiles.
+ */
+static void report_latency(const char *name, uint64_t *ns, size_t n)
+{
+    qsort(ns, n, sizeof(uint64_t), compare_u64);
+    printf("%-16s p50 %llu ns  p99 %llu ns  p999 %llu ns  max %llu ns\n", name,
+           (unsigned long long)ns[n / 2], (unsigned long long)ns[n * 99 / 100],
+           (unsigned long long)ns[n * 999 / 1000], (unsigned long long)ns[n - 1]);
+}
+
+/*
+ * run_churn
+ * ----------
+ * Slides a window of n live keys "key<i>" forward by n keys per round, starting with
+ * keys 0..n-1 already in the table, and times a sample of lookups after each round.
+ */
+static bool run_churn(ht *table, size_t n, size_t rounds)
+{
+    char key[KEY_SIZE];
+    size_t sample = n < 100000 ? n : 100000;
+
+    for (size_t round = 0; round < rounds; round++)
+    {
+        size_t base = round * n;
+        double start = now_sec();
+        for (size_t i = base; i < base + n; i++)
+        {
+            snprintf(key, KEY_SIZE, "key%zu", i);
+            if (ht_remove(table, key) == NULL)
+                return false;
+            snprintf(key, KEY_SIZE, "key%zu", i + n);
+            if (ht_set(table, key, (void *)(uintptr_t)(i + n + 1)) == NULL)
+                return false;
+        }
+        double churn = now_sec() - start;
+
+        size_t found = 0;
+        start = now_sec();
+        for (size_t i = 0; i < sample; i++)
+        {
+            snprintf(key, KEY_SIZE, "key%zu", base + n + i * (n / sample));
+            found += ht_get(table, key) != NULL;
+        }
+        double lookup = now_sec() - start;
+        if (found != sample || ht_length(table) != n)
+            return false;
+
+        printf("churn round %-6zu remove+insert %8.2f ns/op   lookup %8.2f ns/op\n",
+               round + 1, churn * 1e9 / (double)n, lookup * 1e9 / (double)sample);
+    }
+    return true;
+}
+
+/*
+ * run_snapshot
+ * ----------
+ * Saves the table holding keys 0..n-1 to path, loads it back and looks every key up in it.
+ * Returns false if any step fails or a lookup returns a different value.
+ */
+static bool run_snapshot(ht *table, const char *keys, size_t n, const char *path)
+{
+    double start = now_sec();
+    if (!ht_save(table, path))
+        return false;
+    report("snapshot save", n, now_sec() - start);
+
+    start = now_sec();
+    ht *loaded = ht_load(path);
+    if (loaded == NULL)
+        return false;
+    printf("%-16s %12.3f ms\n", "snapshot load", (now_sec() - start) * 1e3);
+
+    bool ok = true;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        ok &= ht_get(loaded, keys + i * KEY_SIZE) == (void *)(uintptr_t)(i + 1);
+    report("cold lookup", n, now_sec() - start);
+
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        ok &= ht_get(loaded, keys + i * KEY_SIZE) == (void *)(uintptr_t)(i + 1);
+    report("warm lookup", n, now_sec() - start);
+
+    ht_destroy(loaded);
+    return ok;
+}
+
+/*
+ * run_bulk
+ * ----------
+ * Builds a table of keys 0..n-1 with ht_bulk_load, on one thread and then on the given
+ * number of threads (0 for one per CPU), and checks every key of the last one.
+ * Returns false if a build fails or a lookup returns a different value.
+ */
+static bool run_bulk(const ht_options *opts, const char *keys, size_t n, unsigned threads)
+{
+    const char **key_list = malloc(n * sizeof(char *));
+    void **values = malloc(n * sizeof(void *));
+    if (key_list == NULL || values == NULL)
+        return false;
+    for (size_t i = 0; i < n; i++)
+    {
+        key_list[i] = keys + i * KEY_SIZE;
+        values[i] = (void *)(uintptr_t)(i + 1);
+    }
+
+    ht_options bulk_opts = *opts;
+    bulk_opts.capacity = 0;
+    bool ok = true;
+    unsigned runs[2] = {1, threads};
+    for (int run = 0; run < 2 && ok; run++)
+    {
+        double start = now_sec();
+        ht *table = ht_bulk_load(&bulk_opts, key_list, values, n, runs[run]);
+        double seconds = now_sec() - start;
+        if (table == NULL)
+        {
+            ok = false;
+            break;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), runs[run] > 0 ? "bulk load x%u" : "bulk load xCPU", runs[run]);
+        report(name, n, seconds);
+
+        // Walk the table in 4 parts, as 4 threads would, and check each part's keys
+        size_t visited = 0;
+        for (size_t part = 0; part < 4; part++)
+        {
+            hti it = ht_iterator_part(table, part, 4);
+            while (ht_next(&it))
+            {
+                visited++;
+                ok &= ht_get(table, it.key) == it.value;
+            }
+        }
+        ok &= visited == n && ht_length(table) == n;
+        ht_destroy(table);
+    }
+
+    free(values);
+    free(key_list);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+
+    ht_options opts = {0};
+    bool reserve = false;
+    size_t churn_rounds = 0;
+    long bulk_threads = -1;
+    const char *snapshot = NULL;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "arena") == 0)
+            opts.flags |= HT_KEY_ARENA;
+        else if (strcmp(argv[i], "inline") == 0)
+            opts.flags |= HT_KEY_INLINE;
+        else if (strcmp(argv[i], "incremental") == 0)
+            opts.flags |= HT_INCREMENTAL;
+        else if (strcmp(argv[i], "robin") == 0)
+            opts.flags |= HT_ROBIN_HOOD;
+        else if (strcmp(argv[i], "reserve") == 0)
+            reserve = true;
+        else if (strncmp(argv[i], "load=", 5) == 0)
+            opts.max_load = strtod(argv[i] + 5, NULL);
+        else if (strncmp(argv[i], "churn=", 6) == 0)
+            churn_rounds = strtoull(argv[i] + 6, NULL, 10);
+        else if (strncmp(argv[i], "bulk=", 5) == 0)
+            bulk_threads = strtol(argv[i] + 5, NULL, 10);
+        else if (strncmp(argv[i], "snapshot=", 9) == 0)
+            snapshot = argv[i] + 9;
+        else if (strcmp(argv[i], "hash=fnv1a") == 0)
+            opts.hash = HT_HASH_FNV1A;
+        else if (strcmp(argv[i], "hash=wy") == 0)
+            opts.hash = HT_HASH_WY;
+        else if (strcmp(argv[i], "hash=crc32c") == 0)
+            opts.hash = HT_HASH_CRC32C;
+        else if (strcmp(argv[i], "hash=seeded") == 0)
+            opts.hash = HT_HASH_SEEDED;
+        else
+        {
+            fprintf(stderr, "Error: unknown option '%s'.\n", argv[i]);
+            return 1;
+        }
+    }
+
+    char *keys = make_keys(n, "key");
+    char *absent = make_keys(n, "absent");
+    uint64_t *latency = malloc(n * sizeof(uint64_t));
+    if (reserve)
+        opts.capacity = n;
+    ht *table = ht_create_opts(&opts);
+    if (keys == NULL || absent == NULL || latency == NULL || table == NULL)
+    {
+        fprintf(stderr, "Error: out of memory or unsupported options.\n");
+        return 1;
+    }
+
+    double start = now_sec();
+    for (size_t i = 0; i < n; i++)
+    {
+        double op_start = now_sec();
+        // Values must be non-NULL, so store index + 1
+        if (ht_set(table, keys + i * KEY_SIZE, (void *)(uintptr_t)(i + 1)) == NULL)
+        {
+            fprintf(stderr, "Error: ht_set failed at key %zu.\n", i);
+            return 1;
+        }
+        latency[i] = (uint64_t)((now_sec() - op_start) * 1e9);
+    }
+    report("insert", n, now_sec() - start);
+    report_latency("insert latency", latency, n);
+
+    ht_statistics stats = ht_stats(table);
+    printf("%-16s load %.3f, probe mean %.2f max %zu\n", "table stats", stats.load_factor, stats.mean_probe,
+           stats.max_probe);
+
+    size_t found = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        found += ht_get(table, keys + i * KEY_SIZE) != NULL;
+    report("lookup hit", n, now_sec() - start);
+
+    size_t missed = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        missed += ht_get(table, absent + i * KEY_SIZE) == NULL;
+    report("lookup miss", n, now_sec() - start);
+
+    if (found != n || missed != n || ht_length(table) != n)
+    {
+        fprintf(stderr, "Error: lookups returned wrong results.\n");
+        return 1;
+    }
+
+    ht_counters counters;
+    if (ht_read_counters(table, &counters))
+        printf("%-16s %.2f probes/get, %.2f probes/set, %llu expansions in %.2f ms\n", "counters",
+               (double)counters.get_probes / (double)counters.gets, (double)counters.set_probes / (double)counters.sets,
+               (unsigned long long)counters.expansions, (double)counters.expand_ns / 1e6);
+
+    if (snapshot != NULL && !run_snapshot(table, keys, n, snapshot))
+    {
+        fprintf(stderr, "Error: snapshot workload failed.\n");
+        return 1;
+    }
+
+    if (bulk_threads >= 0 && !run_bulk(&opts, keys, n, (unsigned)bulk_threads))
+    {
+        fprintf(stderr, "Error: bulk load workload failed.\n");
+        return 1;
+    }
+
+    if (churn_rounds > 0 && !run_churn(table, n, churn_rounds))
+    {
+        fprintf(stderr, "Error: churn workload returned wrong results.\n");
+        return 1;
+    }
+
+    start = now_sec();
+    ht_destroy(table);
+    report("destroy", n, now_sec() - start);
+
+    free(latency);
+    free(keys);
+    free(absent);
+    return 0;
+}
@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ht_cache.h"
+
+/*
+ * Bounded CLOCK Cache
+ *
+ * Builds on any ht.h layout (ht.c, ht_swiss.c or ht_dense.c):
+ * gcc -O2 -c ht_cache.c ht.c
+ *
+ * Usage:
+ * htc *cache = htc_create(&(htc_options){.max_entries = 10000});
+ * if (htc_get(cache, "key") == NULL)
+ *     htc_set(cache, "key", value, value_size);
+ * htc_statistics stats = htc_stats(cache);
+ * htc_destroy(cache);
+ *
+ * Every entry lives in a slot of the cache's side arrays: its key (the table's copy),
+ * value, charged size and referenced bit. The table maps each key to its slot number + 1,
+ * so that a lookup is one ht_get and one byte store. Slots are stable: the table's own
+ * slots move as it shifts entries on removal or grows, the cache's never do.
+ *
+ * CLOCK eviction: a hand sweeps the slots in a circle. An entry that was looked up since
+ * the hand last passed has its referenced bit set: the hand clears it and moves on (a
+ * second chance). The first entry found without the bit is evicted. New entries start
+ * with the bit clear, so keys set once and never read again are the first to go.
+ * Each bit the hand clears was set by a lookup, so eviction is O(1) amortized, and the
+ * sweep reads one byte per entry.
+ */
+
+// --- Initial Capacity ---
+// Slots allocated up front when there is no entry limit to size the arrays with.
+#define INITIAL_SLOTS 16
+
+// --- Cache Structure ---
+struct htc
+{
+    ht *table; // Key -> slot + 1
+
+    // Side arrays, one element per slot
+    const char **keys;    // Table's copy of the key
+    void **values;        // NULL for a free slot
+    size_t *costs;        // Bytes charged for the entry
+    uint8_t *referenced;  // Looked up since the hand last passed
+    size_t *free_slots;   // Stack of free slots below used
+    size_t free_count;
+    size_t used;          // Slots handed out so far: later ones have never been used
+    size_t slots;         // Allocated slots
+
+    size_t hand;          // Next slot the clock hand looks at
+    size_t length;
+    size_t bytes;
+    size_t max_entries;   // SIZE_MAX for no limit
+    size_t max_bytes;     // SIZE_MAX for no limit
+
+    void (*evict)(const char *key, void *value, void *ctx);
+    void *ctx;
+
+    uint64_t hits, misses, inserts, evictions;
+};
+
+static void htc_free_arrays(htc *cache)
+{
+    free(cache->keys);
+    free(cache->values);
+    free(cache->costs);
+    free(cache->referenced);
+    free(cache->free_slots);
+}
+
+/*
+ * htc_grow
+ * ----------
+ * Reallocates the side arrays to hold slots slots. On failure the arrays are
+ * left as they were (some possibly larger), and it returns false.
+ */
+static bool htc_grow(htc *cache, size_t slots)
+{
+    if (slots > SIZE_MAX / sizeof(size_t))
+        return false;
+
+    const char **keys = realloc(cache->keys, slots * sizeof(const char *));
+    if (keys != NULL)
+        cache->keys = keys;
+    void **values = realloc(cache->values, slots * sizeof(void *));
+    if (values != NULL)
+        cache->values = values;
+    size_t *costs = realloc(cache->costs, slots * sizeof(size_t));
+    if (costs != NULL)
+        cache->costs = costs;
+    uint8_t *referenced = realloc(cache->referenced, slots);
+    if (referenced != NULL)
+        cache->referenced = referenced;
+    size_t *free_slots = realloc(cache->free_slots, slots * sizeof(size_t));
+    if (free_slots != NULL)
+        cache->free_slots = free_slots;
+
+    if (keys == NULL || values == NULL || costs == NULL || referenced == NULL || free_slots == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for cache slots.\n");
+        return false;
+    }
+    cache->slots = slots;
+    return true;
+}
+
+/*
+ * htc_create
+ * ----------
+ * Allocates the table and the side arrays: all the slots max_entries needs when it is set,
+ * so a cache bounded by entries never reallocates them.
+ */
+htc *htc_create(const htc_options *opts)
+{
+    if (opts == NULL || (opts->max_entries == 0 && opts->max_bytes == 0) ||
+        (opts->table.flags & (HT_KEY_ARENA | HT_KEY_INLINE)))
+        return NULL;
+
+    htc *cache = calloc(1, sizeof(htc));
+    if (cache == NULL)
+        return NULL;
+    cache->max_entries = opts->max_entries > 0 ? opts->max_entries : SIZE_MAX;
+    cache->max_bytes = opts->max_bytes > 0 ? opts->max_bytes : SIZE_MAX;
+    cache->evict = opts->evict;
+    cache->ctx = opts->ctx;
+
+    // The table never holds more than max_entries keys: make room for them now
+    ht_options table_opts = opts->table;
+    if (opts->max_entries > 0 && table_opts.capacity < opts->max_entries)
+        table_opts.capacity = opts->max_entries;
+    cache->table = ht_create_opts(&table_opts);
+
+    if (cache->table == NULL || !htc_grow(cache, opts->max_entries > 0 ? opts->max_entries : INITIAL_SLOTS))
+    {
+        ht_destroy(cache->table);
+        htc_free_arrays(cache);
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+/*
+ * htc_destroy
+ * ----------
+ * Hands every cached entry to the evict callback, then frees the table and the cache.
+ */
+void htc_destroy(htc *cache)
+{
+    if (cache == NULL)
+        return;
+    if (cache->evict != NULL)
+    {
+        for (size_t slot = 0; slot < cache->used; slot++)
+        {
+            if (cache->values[slot] != NULL)
+                cache->evict(cache->keys[slot], cache->values[slot], cache->ctx);
+        }
+    }
+    ht_destroy(cache->table);
+    htc_free_arrays(cache);
+    free(cache);
+}
+
+/*
+ * htc_release
+ * ----------
+ * Removes the entry in slot from the table and frees the slot, returning its value.
+ */
+static void *htc_release(htc *cache, size_t slot)
+{
+    void *value = cache->values[slot];
+    ht_remove(cache->table, cache->keys[slot]);
+    cache->values[slot] = NULL;
+    cache->keys[slot] = NULL;
+    cache->free_slots[cache->free_count++] = slot;
+    cache->bytes -= cache->costs[slot];
+    cache->length--;
+    return value;
+}
+
+/*
+ * htc_evict_one
+ * ----------
+ * Advances the clock hand to the first entry without its referenced bit, clearing the
+ * bits it passes, and evicts that entry. The entry in slot keep (SIZE_MAX for none) is
+ * passed over: the caller must make sure the cache holds at least one other entry.
+ */
+static void htc_evict_one(htc *cache, size_t keep)
+{
+    for (;;)
+    {
+        size_t slot = cache->hand;
+        cache->hand = slot + 1 < cache->used ? slot + 1 : 0;
+        if (cache->values[slot] == NULL || slot == keep)
+            continue;
+        if (cache->referenced[slot])
+        {
+            cache->referenced[slot] = 0;
+            continue;
+        }
+
+        if (cache->evict != NULL)
+            cache->evict(cache->keys[slot], cache->values[slot], cache->ctx);
+        htc_release(cache, slot);
+        cache->evictions++;
+        return;
+    }
+}
+
+/*
+ * htc_get
+ * ----------
+ * Looks the key's slot up in the table and sets its referenced bit.
+ */
+void *htc_get(htc *cache, const char *key)
+{
+    if (cache == NULL)
+        return NULL;
+    void *found = ht_get(cache->table, key);
+    if (found == NULL)
+    {
+        cache->misses++;
+        return NULL;
+    }
+    size_t slot = (uintptr_t)found - 1;
+    cache->referenced[slot] = 1;
+    cache->hits++;
+    return cache->values[slot];
+}
+
+/*
+ * htc_over
+ * ----------
+ * Returns true if the cache holding length entries charged bytes bytes is over its limits.
+ */
+static inline bool htc_over(htc *cache, size_t length, size_t bytes)
+{
+    return length > cache->max_entries || bytes > cache->max_bytes;
+}
+
+/*
+ * htc_set
+ * ----------
+ * Replaces the value of a cached key in place, evicting others if it grew past max_bytes.
+ * Otherwise evicts until the new entry fits, takes a free slot (or the next unused one),
+ * and maps the key to it.
+ */
+bool htc_set(htc *cache, const char *key, void *value, size_t bytes)
+{
+    if (cache == NULL || key == NULL || value == NULL)
+        return false;
+
+    size_t key_size = strlen(key) + 1;
+    if (bytes > SIZE_MAX - key_size - HTC_ENTRY_OVERHEAD)
+        return false;
+    size_t cost = bytes + key_size + HTC_ENTRY_OVERHEAD;
+    if (cost > cache->max_bytes)
+        return false;
+
+    void *found = ht_get(cache->table, key);
+    if (found != NULL)
+    {
+        size_t slot = (uintptr_t)found - 1;
+        void *old = cache->values[slot];
+        cache->values[slot] = value;
+        cache->bytes = cache->bytes - cache->costs[slot] + cost;
+        cache->costs[slot] = cost;
+        cache->referenced[slot] = 1;
+        if (cache->evict != NULL && old != value)
+            cache->evict(cache->keys[slot], old, cache->ctx);
+        while (htc_over(cache, cache->length, cache->bytes))
+            htc_evict_one(cache, slot);
+        return true;
+    }
+
+    while (cache->length > 0 && htc_over(cache, cache->length + 1, cache->bytes + cost))
+        htc_evict_one(cache, SIZE_MAX);
+
+    size_t slot;
+    if (cache->free_count > 0)
+        slot = cache->free_slots[--cache->free_count];
+    else
+    {
+        if (cache->used == cache->slots && !htc_grow(cache, cache->slots * 2))
+            return false;
+        slot = cache->used++;
+    }
+
+    const char *copy = ht_set(cache->table, key, (void *)(uintptr_t)(slot + 1));
+    if (copy == NULL)
+    {
+        cache->free_slots[cache->free_count++] = slot;
+        return false;
+    }
+    cache->keys[slot] = copy;
+    cache->values[slot] = value;
+    cache->costs[slot] = cost;
+    cache->referenced[slot] = 0;
+    cache->length++;
+    cache->bytes += cost;
+    cache->inserts++;
+    return true;
+}
+
+/*
+ * htc_remove
+ * ----------
+ * Looks the key's slot up and frees it, without calling the evict callback.
+ * Returns the value cached with the key, or NULL if it was not cached.
+ */
+void *htc_remove(htc *cache, const char *key)
+{
+    if (cache == NULL)
+        return NULL;
+    void *found = ht_get(cache->table, key);
+    if (found == NULL)
+        return NULL;
+    return htc_release(cache, (uintptr_t)found - 1);
+}
+
+/*
+ * htc_length
+ * ----------
+ * Returns the number of entries in the cache.
+ */
+size_t htc_length(htc *cache)
+{
+    return cache != NULL ? cache->length : 0;
+}
+
+/*
+ * htc_stats
+ * ----------
+ * Copies the counters and sizes of the cache, and computes its hit rate.
+ */
+htc_statistics htc_stats(htc *cache)
+{
+    htc_statistics stats = {0};
+    if (cache == NULL)
+        return stats;
+    stats.hits = cache->hits;
+    stats.misses = cache->misses;
+    stats.inserts = cache->inserts;
+    stats.evictions = cache->evictions;
+    stats.length = cache->length;
+    stats.bytes = cache->bytes;
+    if (cache->hits + cache->misses > 0)
+        stats.hit_rate = (double)cache->hits / (double)(cache->hits + cache->misses);
+    return stats;
+}
@@ -0,0 +1,81 @@
+#ifndef HT_CACHE_H
+#define HT_CACHE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "ht.h"
+
+/*
+ * Bounded cache built on top of ht.
+ * Holds at most a given number of entries and/or bytes: setting a key into a full cache
+ * evicts others, chosen by the CLOCK algorithm (an approximation of least recently used).
+ * Recency is one byte per entry in a side array indexed by entry slot, swept by a clock
+ * hand, rather than a linked list that every lookup would have to relink.
+ * Not thread-safe, like ht.
+ */
+
+typedef struct htc htc;
+
+/** Fixed number of bytes charged for every entry on top of its key and value sizes:
+ *  the cache's side arrays, and about two slots of the table at its default load.
+ */
+#define HTC_ENTRY_OVERHEAD 96
+
+/** Cache options for htc_create. Set max_entries, max_bytes or both. */
+typedef struct
+{
+    size_t max_entries; // Most entries held at once, 0 for no limit
+    size_t max_bytes;   // Most bytes charged at once (see htc_set), 0 for no limit
+    ht_options table;   // Options of the underlying table, zeroed for defaults. The key
+                        // storage flags are rejected: keys must stay put and be freed on eviction.
+
+    // Called with every entry the cache drops by itself: evicted, replaced by htc_set,
+    // or still cached when it is destroyed. NULL if values need no cleanup.
+    void (*evict)(const char *key, void *value, void *ctx);
+    void *ctx;
+} htc_options;
+
+/** Create an empty cache. Return NULL if out of memory or if the options are invalid
+ *  (no limit at all, or key storage flags).
+ */
+htc *htc_create(const htc_options *opts);
+
+/** Free the cache, passing every entry still in it to the evict callback */
+void htc_destroy(htc *cache);
+
+/** Get the value cached with key and mark it recently used, or NULL if not cached */
+void *htc_get(htc *cache, const char *key);
+
+/** Cache value (which must not be NULL) with key, charging bytes (the size of the value)
+ *  plus the key's length + 1 plus HTC_ENTRY_OVERHEAD against max_bytes.
+ *  Entries are evicted until the new one fits. A key that is already cached gets the new
+ *  value, and the old one goes to the evict callback.
+ *  Return false if out of memory, or if the entry alone is larger than max_bytes.
+ */
+bool htc_set(htc *cache, const char *key, void *value, size_t bytes);
+
+/** Remove key from the cache. Return the value cached with it (which is not passed to
+ *  the evict callback), or NULL if not cached.
+ */
+void *htc_remove(htc *cache, const char *key);
+
+/** Number of entries in the cache */
+size_t htc_length(htc *cache);
+
+/** Cache statistics, as returned by htc_stats */
+typedef struct
+{
+    uint64_t hits;      // htc_get calls that found their key
+    uint64_t misses;    // htc_get calls that didn't
+    uint64_t inserts;   // htc_set calls that added a new key
+    uint64_t evictions; // Entries evicted to make room
+    size_t length;      // Number of entries
+    size_t bytes;       // Bytes charged by the entries, overhead included
+    double hit_rate;    // hits / (hits + misses), 0 before any lookup
+} htc_statistics;
+
+/** Return the statistics of the cache */
+htc_statistics htc_stats(htc *cache);
+
+#endif
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include "ht_cache.h"
+
+/*
+ * Bounded cache benchmark
+ *
+ * Read-through caching of a Zipfian key stream with htc, at several cache sizes:
+ * gcc -O2 -o ht_cache_bench ht_cache_bench.c ht_cache.c ht.c -lm
+ *
+ * Usage: ./ht_cache_bench [number of keys] [ops] [zipf theta]
+ * Defaults to 1000000 distinct keys, 10000000 lookups and theta 0.99. Every lookup that
+ * misses sets the key, charged VALUE_BYTES bytes, as a read-through cache does.
+ * The cache is bounded to 1%, 5%, 10%, 25% and 50% of the keys by entries, then by
+ * bytes (the same entries' worth of bytes). Each line reports the hit rate, the number
+ * of evictions, the bytes charged at the end, and the throughput of the whole loop.
+ */
+
+#define KEY_SIZE 16
+#define VALUE_BYTES 100
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: cheap random numbers
+static inline uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// Spreads Zipfian ranks over key indexes (the MurmurHash3 finalizer)
+static inline uint64_t scramble(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/*
+ * fill_zipf
+ * ----------
+ * Fill count key indexes in [0, n) following a Zipfian distribution of parameter theta,
+ * with the generator of ht_workload_bench.c (Gray et al., as YCSB uses).
+ */
+static void fill_zipf(uint32_t *indexes, size_t count, size_t n, double theta, uint64_t seed)
+{
+    double zetan = 0;
+    for (size_t i = 1; i <= n; i++)
+        zetan += 1.0 / pow((double)i, theta);
+    double zeta2 = 1.0 + 1.0 / pow(2.0, theta);
+    double alpha = 1.0 / (1.0 - theta);
+    double eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+
+    uint64_t state = seed;
+    for (size_t i = 0; i < count; i++)
+    {
+        double u = (double)(next_random(&state) >> 11) * 0x1.0p-53;
+        double uz = u * zetan;
+        uint64_t rank;
+        if (uz < 1.0)
+            rank = 0;
+        else if (uz < zeta2)
+            rank = 1;
+        else
+            rank = (uint64_t)((double)n * pow(eta * u - eta + 1.0, alpha));
+        indexes[i] = (uint32_t)(scramble(rank) % n);
+    }
+}
+
+/*
+ * run
+ * ----------
+ * Runs the read-through loop on a cache created with opts, and prints its line.
+ */
+static bool run(const char *bound, size_t percent, const htc_options *opts, const char *keys,
+                const uint32_t *indexes, size_t ops)
+{
+    htc *cache = htc_create(opts);
+    if (cache == NULL)
+    {
+        fprintf(stderr, "Error: htc_create failed.\n");
+        return false;
+    }
+
+    double start = now_sec();
+    for (size_t i = 0; i < ops; i++)
+    {
+        const char *key = keys + (size_t)indexes[i] * KEY_SIZE;
+        if (htc_get(cache, key) == NULL && !htc_set(cache, key, (void *)(uintptr_t)(indexes[i] + 1), VALUE_BYTES))
+        {
+            fprintf(stderr, "Error: htc_set failed.\n");
+            htc_destroy(cache);
+            return false;
+        }
+    }
+    double seconds = now_sec() - start;
+
+    htc_statistics stats = htc_stats(cache);
+    printf("%-8s %7zu%% %10zu %9.2f%% %12llu %12.1f %10.2f\n", bound, percent, stats.length, stats.hit_rate * 100,
+           (unsigned long long)stats.evictions, (double)stats.bytes / (1 << 20), (double)ops / seconds / 1e6);
+    htc_destroy(cache);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    size_t ops = argc > 2 ? strtoull(argv[2], NULL, 10) : 10000000;
+    double theta = argc > 3 ? strtod(argv[3], NULL) : 0.99;
+    if (n < 100 || n > UINT32_MAX || theta <= 0 || theta >= 1)
+    {
+        fprintf(stderr, "Error: need at least 100 keys and a zipf theta between 0 and 1.\n");
+        return 1;
+    }
+
+    char *keys = malloc(n * KEY_SIZE);
+    uint32_t *indexes = malloc(ops * sizeof(uint32_t));
+    if (keys == NULL || indexes == NULL)
+    {
+        fprintf(stderr, "Error: out of memory.\n");
+        return 1;
+    }
+    for (size_t i = 0; i < n; i++)
+        snprintf(keys + i * KEY_SIZE, KEY_SIZE, "key%zu", i);
+    fill_zipf(indexes, ops, n, theta, 0x9E3779B97F4A7C15ULL);
+
+    static const size_t percents[] = {1, 5, 10, 25, 50};
+    printf("%zu keys, %zu lookups, zipf %.2f\n", n, ops, theta);
+    printf("%-8s %8s %10s %10s %12s %12s %10s\n", "bound", "size", "entries", "hit rate", "evictions", "MB charged",
+           "Mops/s");
+    for (int by_bytes = 0; by_bytes < 2; by_bytes++)
+    {
+        for (size_t p = 0; p < sizeof(percents) / sizeof(percents[0]); p++)
+        {
+            size_t entries = n * percents[p] / 100;
+            htc_options opts = {0};
+            if (by_bytes)
+                opts.max_bytes = entries * (VALUE_BYTES + KEY_SIZE / 2 + HTC_ENTRY_OVERHEAD);
+            else
+                opts.max_entries = entries;
+            if (!run(by_bytes ? "bytes" : "entries", percents[p], &opts, keys, indexes, ops))
+                return 1;
+        }
+    }
+
+    free(keys);
+    free(indexes);
+    return 0;
+}
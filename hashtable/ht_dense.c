@@ -0,0 +1,898 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <time.h>
+#include "ht.h"
+#include "ht_hash.h"
+#include "ht_arena.h"
+
+/*
+ * Dense (compact) Hashtable Implementation in C
+ *
+ * Drop-in alternative to ht.c implementing the same ht.h API, laid out like a
+ * compact dict: the entries (key, value, hash, length) are packed in insertion order
+ * in their own array, and the open addressing slots only hold the position of an
+ * entry plus the low half of its hash, 8 bytes instead of ht.c's 32.
+ * Link against it instead of ht.c:
+ * gcc -O2 -o ht_bench_dense ht_bench.c ht_dense.c
+ *
+ * Slots are probed linearly, as in ht.c, and the cached hash in the slot lets a
+ * probe skip entries whose hash differs without touching the entries array.
+ *
+ * The entries array is only as long as the table's maximum length, and ht_next
+ * walks it from the start: iteration reads live data back to back, in insertion
+ * order, whatever the load factor or the reserved capacity.
+ *
+ * ht_remove empties the slot with backward-shift deletion, like ht.c, and leaves a
+ * hole in the entries array (removing the last entry just shortens it). Holes are
+ * squeezed out when the entries array fills up: at the same capacity when most of
+ * it is holes, while growing otherwise, so they never take up more than the array.
+ *
+ * Keys are malloc'ed or, with HT_KEY_ARENA, copied into the key arena.
+ * HT_KEY_INLINE, HT_INCREMENTAL, HT_ROBIN_HOOD and snapshots are not supported.
+ */
+
+// --- Hashtable Slot ---
+// Position of an entry plus one (0 for an empty slot), and the low half of its hash.
+typedef struct
+{
+    uint32_t index;
+    uint32_t hash;
+} ht_slot;
+
+// --- Hashtable Entry ---
+typedef struct
+{
+    const char *key; // NULL for a removed entry
+    void *value;
+    uint32_t hash;
+    uint32_t length; // Key length in bytes, not counting the NUL the table appends
+} ht_entry;
+
+// --- Hashtable Structure ---
+struct ht
+{
+    ht_slot *slots;     // Hash index into entries
+    size_t capacity;    // Total number of slots, a power of 2
+    ht_entry *entries;  // Entries in insertion order, max_length of them allocated
+    size_t used;        // Entries appended and not squeezed out yet, removed ones included
+    size_t length;      // Number of key-value pairs stored
+    size_t max_length;  // Length at which the table expands: capacity * max_load
+    double max_load;    // Maximum load factor, in (0, 1)
+    unsigned flags;     // HT_KEY_* options given to ht_create_opts
+    ht_arena arena;     // Key storage for HT_KEY_ARENA
+    ht_hash_fn hash_fn; // Hash function selected by ht_options.hash
+    uint64_t seed;      // Seed passed to hash_fn
+
+#ifdef HT_INSTRUMENT
+    ht_counters counters; // Read with ht_read_counters
+#endif
+};
+
+// Same starting size as ht.c.
+#define INITIAL_CAPACITY 16
+
+// Slots cache 32 hash bits and entry positions fit in 32 bits below this many slots.
+#define MAX_CAPACITY ((uint64_t)1 << 32)
+#define MAX_KEY_LENGTH UINT32_MAX
+
+// Same default as ht.c: with 8-byte slots a sparse index is cheap, and probes stay short.
+#define DEFAULT_MAX_LOAD 0.5
+
+// Keys hashed and prefetched together by ht_get_many/ht_set_many, as in ht.c.
+#define HT_BATCH 16
+
+#if defined(__GNUC__)
+#define HT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define HT_PREFETCH(addr) ((void)(addr))
+#endif
+
+// HT_COUNT(statement) updates a counter only in builds with -DHT_INSTRUMENT, as in ht.c.
+#ifdef HT_INSTRUMENT
+#define HT_COUNT(statement) statement
+#else
+#define HT_COUNT(statement)
+#endif
+
+/*
+ * ht_max_length
+ * ----------
+ * Returns how many entries a capacity holds before it must expand.
+ * It stays below capacity, so probe sequences always end at an empty slot.
+ */
+static size_t ht_max_length(size_t capacity, double max_load)
+{
+    size_t max_length = (size_t)((double)capacity * max_load);
+    return max_length < capacity ? max_length : capacity - 1;
+}
+
+/*
+ * ht_capacity_for
+ * ----------
+ * Returns the smallest power of 2 capacity (at least INITIAL_CAPACITY) that
+ * holds length entries without expanding, or 0 on overflow.
+ */
+static size_t ht_capacity_for(size_t length, double max_load)
+{
+    if ((double)length / max_load >= (double)(SIZE_MAX / 4))
+        return 0;
+
+    size_t capacity = INITIAL_CAPACITY;
+    while (ht_max_length(capacity, max_load) < length)
+        capacity *= 2;
+    return (uint64_t)capacity <= MAX_CAPACITY ? capacity : 0;
+}
+
+/*
+ * ht_create_opts
+ * ----------
+ * Allocates and initializes a new hashtable with the given options (NULL for defaults).
+ * Returns a pointer to the new table, or NULL on failure or unsupported options.
+ */
+ht *ht_create_opts(const ht_options *opts)
+{
+    unsigned flags = opts != NULL ? opts->flags : 0;
+    if (flags & (HT_KEY_INLINE | HT_INCREMENTAL | HT_ROBIN_HOOD))
+    {
+        fprintf(stderr, "Error: HT_KEY_INLINE, HT_INCREMENTAL and HT_ROBIN_HOOD are not supported by the dense "
+                        "layout.\n");
+        return NULL;
+    }
+
+    double max_load = opts != NULL && opts->max_load != 0 ? opts->max_load : DEFAULT_MAX_LOAD;
+    if (!(max_load > 0 && max_load < 1))
+    {
+        fprintf(stderr, "Error: Hashtable max_load must be between 0 and 1.\n");
+        return NULL;
+    }
+
+    size_t capacity = ht_capacity_for(opts != NULL ? opts->capacity : 0, max_load);
+    if (capacity == 0)
+    {
+        fprintf(stderr, "Error: Hashtable capacity overflow.\n");
+        return NULL;
+    }
+
+    ht_hash_fn hash_fn;
+    uint64_t seed;
+    if (!hash_select(opts, &hash_fn, &seed))
+        return NULL;
+
+    ht *table = malloc(sizeof(ht));
+    if (table == NULL)
+        return NULL;
+
+    table->capacity = capacity;
+    table->used = 0;
+    table->length = 0;
+    table->max_load = max_load;
+    table->max_length = ht_max_length(capacity, max_load);
+    table->flags = flags;
+    table->arena.head = NULL;
+    table->arena.bytes = 0;
+    table->hash_fn = hash_fn;
+    table->seed = seed;
+    HT_COUNT(memset(&table->counters, 0, sizeof(table->counters)));
+
+    table->slots = calloc(capacity, sizeof(ht_slot));
+    table->entries = malloc(table->max_length * sizeof(ht_entry));
+    if (table->slots == NULL || table->entries == NULL)
+    {
+        free(table->slots);
+        free(table->entries);
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+/*
+ * ht_create
+ * ----------
+ * Allocates and initializes a new hashtable with default options.
+ * Returns a pointer to the new table, or NULL on failure.
+ */
+ht *ht_create(void)
+{
+    return ht_create_opts(NULL);
+}
+
+/*
+ * ht_create_capacity
+ * ----------
+ * Allocates a new hashtable with room for capacity keys before its first expansion.
+ * Returns a pointer to the new table, or NULL on failure.
+ */
+ht *ht_create_capacity(size_t capacity)
+{
+    ht_options opts = {0};
+    opts.capacity = capacity;
+    return ht_create_opts(&opts);
+}
+
+#ifdef HT_INSTRUMENT
+/*
+ * ht_now_ns
+ * ----------
+ * Returns a timestamp in nanoseconds, from the monotonic clock where there is one.
+ */
+static uint64_t ht_now_ns(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#else
+    // Plain C99: processor time, close enough to time an expansion
+    return (uint64_t)((double)clock() * 1e9 / CLOCKS_PER_SEC);
+#endif
+}
+
+/*
+ * ht_print_counters
+ * ----------
+ * Writes the counters of the table to out on one line.
+ */
+static void ht_print_counters(const ht *table, FILE *out)
+{
+    const ht_counters *c = &table->counters;
+    fprintf(out,
+            "ht %p: %zu keys, %llu gets (%llu hits, %.2f probes each), %llu sets (%llu inserts, %.2f probes each), "
+            "%llu expansions in %.3f ms, %llu key bytes\n",
+            (const void *)table, table->length, (unsigned long long)c->gets, (unsigned long long)c->get_hits,
+            c->gets > 0 ? (double)c->get_probes / (double)c->gets : 0.0, (unsigned long long)c->sets,
+            (unsigned long long)c->set_inserts, c->sets > 0 ? (double)c->set_probes / (double)c->sets : 0.0,
+            (unsigned long long)c->expansions, (double)c->expand_ns / 1e6, (unsigned long long)c->key_bytes);
+}
+#endif
+
+/*
+ * ht_destroy
+ * ----------
+ * Frees all memory used by the hashtable, including keys and entries.
+ * After calling this, the table pointer is invalid.
+ */
+void ht_destroy(ht *table)
+{
+    if (table == NULL)
+        return;
+
+#ifdef HT_INSTRUMENT
+    if (getenv("HT_COUNTERS") != NULL)
+        ht_print_counters(table, stderr);
+#endif
+
+    // Arena keys go away with their chunks, no need to visit every entry
+    if (!(table->flags & HT_KEY_ARENA))
+    {
+        for (size_t i = 0; i < table->used; i++)
+            free((void *)table->entries[i].key); // NULL for removed entries
+    }
+
+    arena_free(&table->arena);
+    free(table->slots);
+    free(table->entries);
+    free(table);
+}
+
+/*
+ * ht_hash
+ * ----------
+ * Hashes a key of length bytes with the function and seed the table was created with.
+ */
+static inline uint64_t ht_hash(const ht *table, const char *key, size_t length)
+{
+    return table->hash_fn(key, length, table->seed);
+}
+
+/*
+ * ht_probe
+ * ----------
+ * Walks the linear probe sequence of a key of length bytes.
+ * Returns the index of the slot naming key, setting *found, or clears *found and
+ * returns the empty slot that ends the sequence.
+ */
+static size_t ht_probe(const ht *table, const char *key, size_t length, uint64_t hash, bool *found)
+{
+    size_t mask = table->capacity - 1;
+    size_t index = (size_t)(hash & (uint64_t)mask);
+
+    while (table->slots[index].index != 0)
+    {
+        // The hash in the slot rules out most other keys before their entry is read
+        if (table->slots[index].hash == (uint32_t)hash)
+        {
+            const ht_entry *entry = &table->entries[table->slots[index].index - 1];
+            if (entry->length == length && memcmp(key, entry->key, length) == 0)
+            {
+                *found = true;
+                return index;
+            }
+        }
+        index = (index + 1) & mask;
+    }
+    *found = false;
+    return index;
+}
+
+#ifdef HT_INSTRUMENT
+// Slots ht_probe examined to return index for a key with the given hash
+static inline uint64_t ht_probed(size_t index, uint64_t hash, size_t capacity)
+{
+    return (uint64_t)((index - (size_t)hash) & (capacity - 1)) + 1;
+}
+#endif
+
+/*
+ * ht_lookup
+ * ----------
+ * Returns the value stored with key, given its length and hash, or NULL if the key is not found.
+ */
+static void *ht_lookup(ht *table, const char *key, size_t length, uint64_t hash)
+{
+    bool found;
+    size_t index = ht_probe(table, key, length, hash, &found);
+    HT_COUNT(table->counters.gets++; table->counters.get_probes += ht_probed(index, hash, table->capacity);
+             table->counters.get_hits += found);
+    return found ? table->entries[table->slots[index].index - 1].value : NULL;
+}
+
+/*
+ * ht_get
+ * ----------
+ * Looks up a key in the hashtable and returns its value.
+ * Returns NULL if the key is not found.
+ */
+void *ht_get(ht *table, const char *key)
+{
+    if (key == NULL)
+        return NULL;
+    return ht_get_n(table, key, strlen(key));
+}
+
+/*
+ * ht_get_n
+ * ----------
+ * Looks up a key of length bytes, which may contain NUL bytes and needn't be NUL-terminated.
+ * Returns its value, or NULL if the key is not found.
+ */
+void *ht_get_n(ht *table, const void *key, size_t length)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+    return ht_lookup(table, key, length, ht_hash(table, key, length));
+}
+
+/*
+ * ht_get_many
+ * ----------
+ * Looks up n keys, storing each value (NULL if not found) in values.
+ * Each batch runs in three passes over its keys: hash and prefetch the home slot,
+ * then prefetch the entry named by home slots whose cached hash matches, then probe.
+ */
+void ht_get_many(ht *table, const char *const *keys, size_t n, void **values)
+{
+    if (table == NULL || keys == NULL || values == NULL)
+        return;
+
+    uint64_t hashes[HT_BATCH];
+    size_t lengths[HT_BATCH];
+    size_t mask = table->capacity - 1;
+    for (size_t base = 0; base < n; base += HT_BATCH)
+    {
+        size_t count = n - base < HT_BATCH ? n - base : HT_BATCH;
+        const char *const *batch = keys + base;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (batch[i] == NULL)
+                continue;
+            lengths[i] = strlen(batch[i]);
+            hashes[i] = ht_hash(table, batch[i], lengths[i]);
+            HT_PREFETCH(&table->slots[hashes[i] & mask]);
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (batch[i] == NULL)
+                continue;
+            const ht_slot *home = &table->slots[hashes[i] & mask];
+            if (home->index != 0 && home->hash == (uint32_t)hashes[i])
+                HT_PREFETCH(&table->entries[home->index - 1]);
+        }
+
+        for (size_t i = 0; i < count; i++)
+            values[base + i] = batch[i] != NULL ? ht_lookup(table, batch[i], lengths[i], hashes[i]) : NULL;
+    }
+}
+
+/*
+ * ht_rebuild
+ * ----------
+ * Squeezes the removed entries out of the entries array, keeping the others in order,
+ * and rebuilds the slots for new_capacity (which may be the current one).
+ * Returns true on success, false on failure (e.g., memory allocation fails).
+ */
+static bool ht_rebuild(ht *table, size_t new_capacity)
+{
+    size_t new_max_length = ht_max_length(new_capacity, table->max_load);
+    ht_slot *new_slots = calloc(new_capacity, sizeof(ht_slot));
+    if (new_slots == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for new hashtable slots.\n");
+        return false;
+    }
+    if (new_max_length > table->max_length)
+    {
+        ht_entry *new_entries = realloc(table->entries, new_max_length * sizeof(ht_entry));
+        if (new_entries == NULL)
+        {
+            fprintf(stderr, "Error: Failed to allocate memory for new hashtable entries.\n");
+            free(new_slots);
+            return false;
+        }
+        table->entries = new_entries;
+    }
+
+    // Entries only move towards the front, so the squeeze can run in place
+    size_t mask = new_capacity - 1;
+    size_t used = 0;
+    for (size_t i = 0; i < table->used; i++)
+    {
+        if (table->entries[i].key == NULL)
+            continue;
+        table->entries[used] = table->entries[i];
+
+        // Keys are unique, so the entry goes into the first empty slot
+        size_t index = table->entries[used].hash & mask;
+        while (new_slots[index].index != 0)
+            index = (index + 1) & mask;
+        new_slots[index].index = (uint32_t)(used + 1);
+        new_slots[index].hash = table->entries[used].hash;
+        used++;
+    }
+
+    free(table->slots);
+    table->slots = new_slots;
+    table->capacity = new_capacity;
+    table->max_length = new_max_length;
+    table->used = used;
+    return true;
+}
+
+/*
+ * ht_expand
+ * ----------
+ * Doubles the capacity of the hashtable.
+ * Returns true on success, false on failure (e.g., memory allocation fails).
+ */
+static bool ht_expand(ht *table)
+{
+    size_t new_capacity = table->capacity * 2;
+    if (new_capacity < table->capacity || (uint64_t)new_capacity > MAX_CAPACITY)
+    {
+        fprintf(stderr, "Error: Hashtable capacity overflow during expansion.\n");
+        return false;
+    }
+
+#ifdef HT_INSTRUMENT
+    uint64_t start = ht_now_ns();
+    bool resized = ht_rebuild(table, new_capacity);
+    table->counters.expand_ns += ht_now_ns() - start;
+    table->counters.expansions += resized;
+    return resized;
+#else
+    return ht_rebuild(table, new_capacity);
+#endif
+}
+
+/*
+ * ht_reserve
+ * ----------
+ * Grows the table so that it holds length entries without expanding again.
+ * Returns true on success, false on failure.
+ */
+bool ht_reserve(ht *table, size_t length)
+{
+    if (table == NULL)
+        return false;
+
+    size_t capacity = ht_capacity_for(length, table->max_load);
+    if (capacity == 0)
+    {
+        fprintf(stderr, "Error: Hashtable capacity overflow.\n");
+        return false;
+    }
+    if (capacity <= table->capacity)
+        return true;
+
+    return ht_rebuild(table, capacity);
+}
+
+/*
+ * ht_copy_key
+ * ----------
+ * Makes the table's own copy of a new key of length bytes, in the key arena (HT_KEY_ARENA)
+ * or with malloc. The copy is NUL-terminated, so string keys stay C strings.
+ * Returns the copy, or NULL if memory allocation fails.
+ */
+static const char *ht_copy_key(ht *table, const char *key, size_t length)
+{
+    char *copy = (table->flags & HT_KEY_ARENA) ? arena_alloc(&table->arena, length + 1) : malloc(length + 1);
+    if (copy == NULL)
+        return NULL;
+    HT_COUNT(table->counters.key_bytes += length + 1);
+    memcpy(copy, key, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+/*
+ * ht_set_hashed
+ * ----------
+ * Updates the value in place if the key is already stored, otherwise appends a new
+ * entry and points the empty slot ending the key's probe sequence at it. When the
+ * entries array is full, removed entries are squeezed out first, and the table
+ * expands unless that left enough room. The caller passes the length and hash of key.
+ * Returns a pointer to the stored key string on success, NULL on failure.
+ */
+static const char *ht_set_hashed(ht *table, const char *key, size_t length, uint64_t hash, void *value)
+{
+    if (length > MAX_KEY_LENGTH)
+    {
+        fprintf(stderr, "Error: Hashtable key too long.\n");
+        return NULL;
+    }
+
+    bool found;
+    size_t index = ht_probe(table, key, length, hash, &found);
+    HT_COUNT(table->counters.sets++; table->counters.set_probes += ht_probed(index, hash, table->capacity));
+    if (found)
+    {
+        ht_entry *entry = &table->entries[table->slots[index].index - 1];
+        entry->value = value;
+        return entry->key;
+    }
+
+    if (table->used == table->max_length)
+    {
+        // When removed entries took up most of the array, squeezing them out is enough
+        bool mostly_removed = table->length < table->max_length / 2;
+        if (!(mostly_removed ? ht_rebuild(table, table->capacity) : ht_expand(table)))
+            return NULL;
+        index = ht_probe(table, key, length, hash, &found);
+    }
+
+    const char *new_key_copy = ht_copy_key(table, key, length);
+    if (new_key_copy == NULL)
+        return NULL;
+
+    ht_entry *entry = &table->entries[table->used];
+    entry->key = new_key_copy;
+    entry->value = value;
+    entry->hash = (uint32_t)hash;
+    entry->length = (uint32_t)length;
+    table->used++;
+    table->slots[index].index = (uint32_t)table->used;
+    table->slots[index].hash = (uint32_t)hash;
+    table->length++;
+    HT_COUNT(table->counters.set_inserts++);
+    return new_key_copy;
+}
+
+/** Set value in the table.
+ * Checks the arguments and delegates to ht_set_hashed.
+ * Returns a pointer to the stored key string on success, NULL on failure.
+ */
+const char *ht_set(ht *table, const char *key, void *value)
+{
+    if (key == NULL)
+        return NULL;
+    return ht_set_n(table, key, strlen(key), value);
+}
+
+/*
+ * ht_set_n
+ * ----------
+ * Sets a key of length bytes, which may contain NUL bytes and needn't be NUL-terminated.
+ * Returns a pointer to the stored (NUL-terminated) key on success, NULL on failure.
+ */
+const char *ht_set_n(ht *table, const void *key, size_t length, void *value)
+{
+    assert(value != NULL); // (debug builds)
+    if (table == NULL || key == NULL || value == NULL)
+        return NULL;
+
+    return ht_set_hashed(table, key, length, ht_hash(table, key, length), value);
+}
+
+/*
+ * ht_set_many
+ * ----------
+ * Sets n keys to their values, in order, hashing and prefetching the home slot
+ * of each key of a batch before inserting it.
+ * Returns the number of keys set: less than n if a key could not be stored
+ * (NULL key or value, or out of memory), in which case the following keys are not set.
+ */
+size_t ht_set_many(ht *table, const char *const *keys, void *const *values, size_t n)
+{
+    if (table == NULL || keys == NULL || values == NULL)
+        return 0;
+
+    uint64_t hashes[HT_BATCH];
+    size_t lengths[HT_BATCH];
+    for (size_t base = 0; base < n; base += HT_BATCH)
+    {
+        size_t count = n - base < HT_BATCH ? n - base : HT_BATCH;
+        const char *const *batch = keys + base;
+
+        // An expansion while inserting the batch only wastes the remaining prefetches
+        size_t mask = table->capacity - 1;
+        // Only the keys before a NULL key or value are set
+        size_t valid = 0;
+        while (valid < count && batch[valid] != NULL && values[base + valid] != NULL)
+            valid++;
+        assert(valid == count || batch[valid] == NULL); // NULL values: debug builds stop here, as in ht_set
+
+        for (size_t i = 0; i < valid; i++)
+        {
+            lengths[i] = strlen(batch[i]);
+            hashes[i] = ht_hash(table, batch[i], lengths[i]);
+            HT_PREFETCH(&table->slots[hashes[i] & mask]);
+        }
+
+        for (size_t i = 0; i < valid; i++)
+        {
+            if (ht_set_hashed(table, batch[i], lengths[i], hashes[i], values[base + i]) == NULL)
+                return base + i;
+        }
+        if (valid < count)
+            return base + valid;
+    }
+    return n;
+}
+
+/*
+ * ht_bulk_load
+ * ----------
+ * Creates a table with the given options and room for n keys, and sets keys[i] to values[i].
+ * Entries are appended in insertion order, which a parallel build can't split up, so
+ * threads is ignored and the keys are set with ht_set_many.
+ * Returns the table, or NULL on failure (NULL key or value, options, out of memory).
+ */
+ht *ht_bulk_load(const ht_options *opts, const char *const *keys, void *const *values, size_t n, unsigned threads)
+{
+    (void)threads;
+    if (keys == NULL || values == NULL)
+        return NULL;
+
+    ht_options sized = opts != NULL ? *opts : (ht_options){0};
+    if (sized.capacity < n)
+        sized.capacity = n;
+    ht *table = ht_create_opts(&sized);
+    if (table != NULL && ht_set_many(table, keys, values, n) != n)
+    {
+        ht_destroy(table);
+        return NULL;
+    }
+    return table;
+}
+
+/*
+ * ht_remove
+ * ----------
+ * Removes a key from the hashtable and frees its copy (arena keys stay allocated until ht_destroy).
+ * Returns the value that was stored with the key, or NULL if it was not found.
+ */
+void *ht_remove(ht *table, const char *key)
+{
+    if (key == NULL)
+        return NULL;
+    return ht_remove_n(table, key, strlen(key));
+}
+
+/*
+ * ht_remove_n
+ * ----------
+ * Removes a key of length bytes, like ht_remove. Its slot is emptied with backward-shift
+ * deletion, as in ht.c, and its entry becomes a hole until the next ht_rebuild.
+ * Returns the value that was stored with the key, or NULL if it was not found.
+ */
+void *ht_remove_n(ht *table, const void *key, size_t length)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+
+    bool found;
+    size_t hole = ht_probe(table, key, length, ht_hash(table, key, length), &found);
+    if (!found)
+        return NULL;
+
+    ht_entry *entry = &table->entries[table->slots[hole].index - 1];
+    void *value = entry->value;
+    if (!(table->flags & HT_KEY_ARENA))
+        free((void *)entry->key);
+    entry->key = NULL;
+
+    // Trailing holes are simply dropped, so a table used as a stack never fills up with them
+    while (table->used > 0 && table->entries[table->used - 1].key == NULL)
+        table->used--;
+
+    size_t mask = table->capacity - 1;
+    for (size_t next = (hole + 1) & mask; table->slots[next].index != 0; next = (next + 1) & mask)
+    {
+        // Distance of the slot from its home slot, and from the hole
+        size_t home = table->slots[next].hash & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            table->slots[hole] = table->slots[next];
+            hole = next;
+        }
+    }
+    table->slots[hole].index = 0;
+
+    table->length--;
+    return value;
+}
+
+/*
+ * ht_length
+ * ----------
+ * Returns the current number of key-value pairs stored in the hashtable.
+ */
+size_t ht_length(ht *table)
+{
+    if (table == NULL)
+        return 0;
+    return table->length;
+}
+
+/*
+ * ht_read_counters
+ * ----------
+ * Copies the instrumentation counters of the table into *counters.
+ * Returns false, with *counters zeroed, in builds without HT_INSTRUMENT.
+ */
+bool ht_read_counters(ht *table, ht_counters *counters)
+{
+    if (counters == NULL)
+        return false;
+    memset(counters, 0, sizeof(*counters));
+    if (table == NULL)
+        return false;
+
+#ifdef HT_INSTRUMENT
+    *counters = table->counters;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+ * ht_stats
+ * ----------
+ * Computes the load factor of the slots and the probe distances of the keys, the number
+ * of slots between the home slot of a key and the one naming its entry.
+ */
+ht_statistics ht_stats(ht *table)
+{
+    ht_statistics stats = {0};
+    if (table == NULL)
+        return stats;
+
+    size_t mask = table->capacity - 1;
+    size_t total = 0;
+    for (size_t i = 0; i < table->capacity; i++)
+    {
+        if (table->slots[i].index == 0)
+            continue;
+        size_t distance = (i - table->slots[i].hash) & mask;
+        total += distance;
+        if (distance > stats.max_probe)
+            stats.max_probe = distance;
+    }
+
+    stats.length = table->length;
+    stats.capacity = table->capacity;
+    stats.load_factor = (double)table->length / (double)table->capacity;
+    stats.mean_probe = table->length > 0 ? (double)total / (double)table->length : 0;
+    return stats;
+}
+
+/*
+ * ht_save / ht_load
+ * ----------
+ * Snapshots are the linear-probing layout's entries array written out as is,
+ * so this layout doesn't support them.
+ */
+bool ht_save(ht *table, const char *path)
+{
+    (void)table;
+    (void)path;
+    fprintf(stderr, "Error: Snapshots are not supported by the dense layout.\n");
+    return false;
+}
+
+ht *ht_load(const char *path)
+{
+    (void)path;
+    fprintf(stderr, "Error: Snapshots are not supported by the dense layout.\n");
+    return NULL;
+}
+
+/*
+ * ht_iterator
+ * ----------
+ * Initializes and returns a new hashtable iterator.
+ */
+hti ht_iterator(ht *table)
+{
+    hti it;
+    it._table = table;
+    it._index = 0;
+    it._end = SIZE_MAX;
+    it.key = NULL;
+    it.value = NULL;
+    it.length = 0;
+    return it;
+}
+
+/*
+ * ht_iterator_part
+ * ----------
+ * Returns an iterator over part (0 to parts - 1) of its entries, in insertion order.
+ */
+hti ht_iterator_part(ht *table, size_t part, size_t parts)
+{
+    hti it = ht_iterator(table);
+    if (table == NULL || parts == 0 || part >= parts)
+    {
+        it._end = 0;
+        return it;
+    }
+    size_t total = table->used, share = total / parts, extra = total % parts;
+    it._index = part * share + (part < extra ? part : extra);
+    it._end = it._index + share + (part < extra ? 1 : 0);
+    return it;
+}
+
+/*
+ * ht_next
+ * ----------
+ * Advances the iterator to the next entry, in insertion order, updating its key and value.
+ * Only the entries array is read, and only its removed entries are skipped.
+ * Returns true if there is a next entry, false otherwise.
+ */
+bool ht_next(hti *it)
+{
+    if (it == NULL || it->_table == NULL)
+        return false;
+
+    ht *table = it->_table;
+
+    size_t end = table->used;
+    if (it->_end < end)
+        end = it->_end;
+
+    while (it->_index < end)
+    {
+        const ht_entry *entry = &table->entries[it->_index++];
+        if (entry->key != NULL)
+        {
+            it->key = entry->key;
+            it->value = entry->value;
+            it->length = entry->length;
+            return true;
+        }
+    }
+
+    it->key = NULL;
+    it->value = NULL;
+    it->length = 0;
+    return false;
+}
@@ -0,0 +1,284 @@
+#ifndef HT_HASH_H
+#define HT_HASH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "ht.h"
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+/*
+ * Hash functions shared by the hashtable layouts (ht.c, ht_swiss.c).
+ * Everything in here is static inline so each layout can be compiled on its own.
+ *
+ * Tables pick one with ht_options.hash; all of them hash (data, length, seed):
+ * - HT_HASH_FNV1A: one byte per step, each step a multiply depending on the last.
+ * - HT_HASH_WY: wyhash-style, 16 bytes per step (48 on long keys, in three
+ *   independent lanes) folded by 64x64->128 bit multiplies.
+ * - HT_HASH_CRC32C: 8 bytes per CRC32 instruction when built with SSE4.2 (-msse4.2)
+ *   or the ARMv8 CRC extension, bit by bit in software otherwise.
+ * - HT_HASH_SEEDED: HT_HASH_WY keyed with a random seed drawn for each table,
+ *   so collisions can't be precomputed to build long probe chains.
+ */
+
+typedef uint64_t (*ht_hash_fn)(const void *data, size_t length, uint64_t seed);
+
+// --- Constants for FNV-1a Hash Function ---
+#define FNV_OFFSET 14695981039346656037UL
+#define FNV_PRIME 1099511628211UL
+
+/*
+ * hash_key
+ * ----------
+ * Computes the FNV-1a hash for a given string key.
+ * Returns a 64-bit unsigned integer hash value.
+ */
+static inline uint64_t hash_key(const char *key)
+{
+    uint64_t hash = FNV_OFFSET;
+    for (const char *p = key; *p; p++)
+    {
+        hash ^= (uint64_t)(unsigned char)(*p);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/*
+ * hash_fnv1a
+ * ----------
+ * FNV-1a over length bytes, starting from the offset basis xor seed.
+ * With seed 0 it matches hash_key on the same string.
+ */
+static inline uint64_t hash_fnv1a(const void *data, size_t length, uint64_t seed)
+{
+    const unsigned char *p = data;
+    uint64_t hash = FNV_OFFSET ^ seed;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (uint64_t)p[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// --- Word Reads ---
+// Unaligned native-endian loads: memcpy compiles to a single load instruction.
+static inline uint64_t hash_read64(const unsigned char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t hash_read32(const unsigned char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// --- Constants for the wyhash-style Hash Function ---
+#define WY_P0 0xa0761d6478bd642fULL
+#define WY_P1 0xe7037ed1a0b428dbULL
+#define WY_P2 0x8ebc6af09c88c6e3ULL
+#define WY_P3 0x589965cc75374cc3ULL
+
+/*
+ * hash_mix
+ * ----------
+ * Multiplies a by b into 128 bits and folds the halves together.
+ */
+static inline uint64_t hash_mix(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    uint64_t ha = a >> 32, la = (uint32_t)a, hb = b >> 32, lb = (uint32_t)b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+    return lo ^ hi;
+#endif
+}
+
+/*
+ * hash_wy
+ * ----------
+ * wyhash-style hash: keys up to 16 bytes are read as two overlapping words,
+ * longer ones 16 bytes (or 48, in three lanes) at a time.
+ */
+static inline uint64_t hash_wy(const void *data, size_t length, uint64_t seed)
+{
+    const unsigned char *p = data;
+    uint64_t a, b;
+
+    seed ^= hash_mix(seed ^ WY_P0, WY_P1);
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            // Two 4-byte reads from each end, overlapping as needed
+            size_t mid = (length >> 3) << 2;
+            a = (hash_read32(p) << 32) | hash_read32(p + mid);
+            b = (hash_read32(p + length - 4) << 32) | hash_read32(p + length - 4 - mid);
+        }
+        else if (length > 0)
+        {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) | p[length - 1];
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t left = length;
+        if (left > 48)
+        {
+            uint64_t lane1 = seed, lane2 = seed;
+            do
+            {
+                seed = hash_mix(hash_read64(p) ^ WY_P1, hash_read64(p + 8) ^ seed);
+                lane1 = hash_mix(hash_read64(p + 16) ^ WY_P2, hash_read64(p + 24) ^ lane1);
+                lane2 = hash_mix(hash_read64(p + 32) ^ WY_P3, hash_read64(p + 40) ^ lane2);
+                p += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= lane1 ^ lane2;
+        }
+        while (left > 16)
+        {
+            seed = hash_mix(hash_read64(p) ^ WY_P1, hash_read64(p + 8) ^ seed);
+            p += 16;
+            left -= 16;
+        }
+        // The last 16 bytes of the key, which may overlap the ones already mixed
+        a = hash_read64(p + left - 16);
+        b = hash_read64(p + left - 8);
+    }
+
+    return hash_mix(WY_P1 ^ length, hash_mix(a ^ WY_P1, b ^ seed));
+}
+
+/*
+ * hash_crc32c
+ * ----------
+ * CRC32C of the key, starting from the seed, spread over 64 bits.
+ * The final multiply-xorshift fills the high bits, which the Swiss table
+ * and the sharded table rely on, from the 32-bit CRC and the length.
+ */
+static inline uint64_t hash_crc32c(const void *data, size_t length, uint64_t seed)
+{
+    const unsigned char *p = data;
+    size_t total = length;
+    uint64_t crc = (uint32_t)~seed;
+
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    for (; length >= 8; p += 8, length -= 8)
+    {
+#if defined(__SSE4_2__)
+        crc = _mm_crc32_u64(crc, hash_read64(p));
+#else
+        crc = __crc32cd((uint32_t)crc, hash_read64(p));
+#endif
+    }
+    for (; length > 0; p++, length--)
+    {
+#if defined(__SSE4_2__)
+        crc = _mm_crc32_u8((uint32_t)crc, *p);
+#else
+        crc = __crc32cb((uint32_t)crc, *p);
+#endif
+    }
+#else
+    // Reflected Castagnoli polynomial, one bit at a time
+    for (; length > 0; p++, length--)
+    {
+        crc ^= *p;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0x82F63B78U & (0U - (uint32_t)(crc & 1)));
+    }
+#endif
+
+    uint64_t hash = ((uint64_t)(uint32_t)~crc | ((uint64_t)total << 32)) * 0x9E3779B97F4A7C15ULL;
+    return hash ^ (hash >> 29);
+}
+
+/*
+ * hash_random_seed
+ * ----------
+ * Returns a seed from /dev/urandom, or mixed from the clock and a stack address
+ * where it isn't available.
+ */
+static inline uint64_t hash_random_seed(void)
+{
+    uint64_t seed = 0;
+    FILE *urandom = fopen("/dev/urandom", "rb");
+    if (urandom != NULL)
+    {
+        if (fread(&seed, sizeof(seed), 1, urandom) != 1)
+            seed = 0;
+        fclose(urandom);
+    }
+    if (seed == 0)
+    {
+        // clock_gettime where POSIX declares it, plain C99 time() and clock() elsewhere
+#if defined(CLOCK_REALTIME)
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        uint64_t seconds = (uint64_t)ts.tv_sec, fraction = (uint64_t)ts.tv_nsec;
+#else
+        uint64_t seconds = (uint64_t)time(NULL), fraction = (uint64_t)clock();
+#endif
+        seed = hash_mix(seconds ^ WY_P0, fraction ^ (uint64_t)(uintptr_t)&seconds);
+    }
+    return seed;
+}
+
+/*
+ * hash_select
+ * ----------
+ * Resolves the hash function and seed given by opts (NULL for FNV-1a, unseeded).
+ * Returns false if opts names an unknown function.
+ */
+static inline bool hash_select(const ht_options *opts, ht_hash_fn *fn, uint64_t *seed)
+{
+    unsigned kind = opts != NULL ? opts->hash : HT_HASH_FNV1A;
+    *seed = opts != NULL ? opts->seed : 0;
+
+    switch (kind)
+    {
+    case HT_HASH_FNV1A:
+        *fn = hash_fnv1a;
+        return true;
+    case HT_HASH_WY:
+        *fn = hash_wy;
+        return true;
+    case HT_HASH_CRC32C:
+        *fn = hash_crc32c;
+        return true;
+    case HT_HASH_SEEDED:
+        *fn = hash_wy;
+        if (*seed == 0)
+            *seed = hash_random_seed();
+        return true;
+    default:
+        fprintf(stderr, "Error: Unknown hash function %u.\n", kind);
+        return false;
+    }
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "ht_hash.h"
+
+/*
+ * Hash function benchmark
+ *
+ * Only needs ht_hash.h; build with -msse4.2 (x86) or -march=armv8-a+crc (ARM)
+ * to time the hardware CRC32C instead of the software fallback:
+ * gcc -O2 -msse4.2 -o ht_hash_bench ht_hash_bench.c
+ *
+ * Usage: ./ht_hash_bench [number of keys] [load factor]
+ * Defaults to 1000000 keys at a load factor of 0.5 (ht.c's default).
+ *
+ * Throughput: hashes a buffer of keys of 8 to 256 bytes with every function.
+ * Probe lengths: inserts the keys into a simulated linear-probing array, the way
+ * ht.c places them, and reports how far from their home slot they ended up.
+ * Key sets are short sequential keys ("key<i>") and 64-byte keys sharing a long
+ * prefix, which is where poor mixing of the last bytes shows up.
+ */
+
+typedef struct
+{
+    const char *name;
+    ht_hash_fn fn;
+    uint64_t seed;
+} hash_case;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*
+ * run_throughput
+ * ----------
+ * Hashes count keys of length bytes, laid out back to back, several times over.
+ * Returns the hashing rate in GB/s; the xor of all hashes goes to *sink so the
+ * compiler can't drop the work.
+ */
+static double run_throughput(const hash_case *hc, const unsigned char *data, size_t length, size_t count,
+                             uint64_t *sink)
+{
+    size_t rounds = (64u << 20) / (length * count) + 1;
+    uint64_t acc = 0;
+
+    double start = now_sec();
+    for (size_t r = 0; r < rounds; r++)
+        for (size_t i = 0; i < count; i++)
+            acc ^= hc->fn(data + i * length, length, hc->seed);
+    double seconds = now_sec() - start;
+
+    *sink ^= acc;
+    return (double)(rounds * count * length) / seconds / 1e9;
+}
+
+/*
+ * report_probes
+ * ----------
+ * Places n keys into a power of 2 array sized for the given load factor with linear
+ * probing, and prints the distribution of distances from the home slot.
+ */
+static void report_probes(const hash_case *hc, const char *keys, size_t key_size, size_t n, double load)
+{
+    size_t capacity = 16;
+    while ((double)n > (double)capacity * load)
+        capacity *= 2;
+
+    bool *used = calloc(capacity, sizeof(bool));
+    if (used == NULL)
+        return;
+
+    // Distance buckets: 0, 1, 2, 3-4, 5-8, 9-16, 17+
+    size_t buckets[7] = {0};
+    size_t total = 0, longest = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        const char *key = keys + i * key_size;
+        size_t index = (size_t)(hc->fn(key, strlen(key), hc->seed) & (uint64_t)(capacity - 1));
+        size_t distance = 0;
+        while (used[index])
+        {
+            index = (index + 1) & (capacity - 1);
+            distance++;
+        }
+        used[index] = true;
+
+        total += distance;
+        if (distance > longest)
+            longest = distance;
+        int bucket = distance <= 2 ? (int)distance : distance <= 4 ? 3 : distance <= 8 ? 4 : distance <= 16 ? 5 : 6;
+        buckets[bucket]++;
+    }
+    free(used);
+
+    printf("%-8s mean %6.2f max %6zu |", hc->name, (double)total / (double)n, longest);
+    for (int b = 0; b < 7; b++)
+        printf(" %6.2f%%", 100.0 * (double)buckets[b] / (double)n);
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    double load = argc > 2 ? strtod(argv[2], NULL) : 0.5;
+    if (n == 0 || !(load > 0 && load < 1))
+    {
+        fprintf(stderr, "Error: need at least one key and a load factor between 0 and 1.\n");
+        return 1;
+    }
+
+    hash_case cases[] = {
+        {"fnv1a", hash_fnv1a, 0},
+        {"wy", hash_wy, 0},
+        {"crc32c", hash_crc32c, 0},
+        {"seeded", hash_wy, hash_random_seed()},
+    };
+    size_t ncases = sizeof(cases) / sizeof(cases[0]);
+
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    printf("crc32c: hardware instructions\n");
+#else
+    printf("crc32c: software fallback\n");
+#endif
+
+    // Throughput over 4096 keys of each length, small enough to stay in L1/L2
+    size_t count = 4096;
+    unsigned char *data = malloc(count * 256);
+    if (data == NULL)
+    {
+        fprintf(stderr, "Error: out of memory.\n");
+        return 1;
+    }
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < count * 256; i++)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        data[i] = (unsigned char)(state >> 56);
+    }
+
+    uint64_t sink = 0;
+    printf("\nthroughput (GB/s)\n%8s", "bytes");
+    for (size_t c = 0; c < ncases; c++)
+        printf(" %10s", cases[c].name);
+    printf("\n");
+    for (size_t length = 8; length <= 256; length *= 2)
+    {
+        printf("%8zu", length);
+        for (size_t c = 0; c < ncases; c++)
+            printf(" %10.2f", run_throughput(&cases[c], data, length, count, &sink));
+        printf("\n");
+    }
+    free(data);
+
+    // Probe length distributions, for two key sets
+    size_t key_size = 72;
+    char *keys = malloc(n * key_size);
+    if (keys == NULL)
+    {
+        fprintf(stderr, "Error: out of memory.\n");
+        return 1;
+    }
+
+    const char *sets[] = {"key%zu", "/api/v1/accounts/0000000000/transactions/by-id/%016zx"};
+    for (size_t s = 0; s < 2; s++)
+    {
+        for (size_t i = 0; i < n; i++)
+            snprintf(keys + i * key_size, key_size, sets[s], i);
+
+        printf("\nprobe distance, %zu keys \"%s\" at load %.2f\n", n, sets[s], load);
+        printf("%-8s %11s %10s | %7s %7s %7s %7s %7s %7s %7s\n", "hash", "", "", "0", "1", "2", "3-4", "5-8",
+               "9-16", "17+");
+        for (size_t c = 0; c < ncases; c++)
+            report_probes(&cases[c], keys, key_size, n, load);
+    }
+    free(keys);
+
+    return sink == 42; // Keeps the hashes alive; the exit code is 0 in practice
+}
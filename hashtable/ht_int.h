@@ -0,0 +1,285 @@
+#ifndef HT_INT_H
+#define HT_INT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+/*
+ * Integer-keyed hashtables
+ *
+ * The open addressing scheme of ht.c (power of 2 capacity, linear probing,
+ * expansion at 50% load, backward-shift deletion), specialized for integer keys:
+ * the key is stored in its slot, hashed with an integer mixer, and never allocated.
+ * Header only: HT_INT_DEFINE(name, key_type) generates a table type and its functions,
+ * and ht_u32 and ht_u64 are generated below.
+ *
+ * Usage:
+ * ht_u64 *table = ht_u64_create();
+ * ht_u64_set(table, 42, value);
+ * void *value = ht_u64_get(table, 42);
+ * ht_u64_destroy(table);
+ *
+ * Iterator Usage:
+ * ht_u64_it it = ht_u64_iterator(table);
+ * while (ht_u64_next(&it)) {
+ * printf("Key: %llu, Value: %p\n", (unsigned long long)it.key, it.value);
+ * }
+ *
+ * Every key value, 0 included, is valid. As with ht, values must not be NULL:
+ * a NULL value is what marks a slot as empty.
+ */
+
+// --- Initial Capacity ---
+#define HT_INT_INITIAL_CAPACITY 16
+
+/*
+ * ht_int_hash
+ * ----------
+ * Mixes an integer key into a 64-bit hash (the MurmurHash3 finalizer).
+ * Every input bit affects every output bit, so sequential IDs spread over the whole table.
+ */
+static inline uint64_t ht_int_hash(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/*
+ * ht_int_capacity_for
+ * ----------
+ * Returns the smallest power of 2 capacity (at least HT_INT_INITIAL_CAPACITY) that
+ * holds length entries at 50% load, or 0 on overflow.
+ */
+static inline size_t ht_int_capacity_for(size_t length)
+{
+    if (length >= SIZE_MAX / 8)
+        return 0;
+
+    size_t capacity = HT_INT_INITIAL_CAPACITY;
+    while (capacity / 2 < length)
+        capacity *= 2;
+    return capacity;
+}
+
+/*
+ * HT_INT_DEFINE
+ * ----------
+ * Generates, for the table type name with keys of integer type key_type:
+ * - name: the table, with name_entry slots of a key and a value,
+ * - name_create, name_create_capacity, name_destroy, name_reserve,
+ * - name_get, name_set, name_remove, name_length,
+ * - name_it, name_iterator and name_next, shaped like hti / ht_iterator / ht_next.
+ * They behave like their ht counterparts, except that name_set returns true
+ * on success instead of the address of a key copy.
+ */
+#define HT_INT_DEFINE(name, key_type)                                                      \
+    typedef struct                                                                         \
+    {                                                                                      \
+        key_type key;                                                                      \
+        void *value; /* NULL for an empty slot */                                          \
+    } name##_entry;                                                                        \
+                                                                                           \
+    typedef struct                                                                         \
+    {                                                                                      \
+        name##_entry *entries;                                                             \
+        size_t capacity; /* Total number of slots, a power of 2 */                         \
+        size_t length;   /* Number of key-value pairs stored */                            \
+    } name;                                                                                \
+                                                                                           \
+    typedef struct                                                                         \
+    {                                                                                      \
+        key_type key;                                                                      \
+        void *value;                                                                       \
+                                                                                           \
+        /* don't use these directly */                                                     \
+        name *_table;                                                                      \
+        size_t _index;                                                                     \
+    } name##_it;                                                                           \
+                                                                                           \
+    static inline name *name##_create_capacity(size_t capacity)                            \
+    {                                                                                      \
+        size_t slots = ht_int_capacity_for(capacity);                                      \
+        if (slots == 0)                                                                    \
+        {                                                                                  \
+            fprintf(stderr, "Error: Hashtable capacity overflow.\n");                      \
+            return NULL;                                                                   \
+        }                                                                                  \
+                                                                                           \
+        name *table = malloc(sizeof(name));                                                \
+        if (table == NULL)                                                                 \
+            return NULL;                                                                   \
+        table->entries = calloc(slots, sizeof(name##_entry));                              \
+        if (table->entries == NULL)                                                        \
+        {                                                                                  \
+            free(table);                                                                   \
+            return NULL;                                                                   \
+        }                                                                                  \
+        table->capacity = slots;                                                           \
+        table->length = 0;                                                                 \
+        return table;                                                                      \
+    }                                                                                      \
+                                                                                           \
+    static inline name *name##_create(void)                                                \
+    {                                                                                      \
+        return name##_create_capacity(0);                                                  \
+    }                                                                                      \
+                                                                                           \
+    static inline void name##_destroy(name *table)                                         \
+    {                                                                                      \
+        if (table == NULL)                                                                 \
+            return;                                                                        \
+        free(table->entries);                                                              \
+        free(table);                                                                       \
+    }                                                                                      \
+                                                                                           \
+    /* Index of the slot holding key, or of the empty slot ending its probe sequence */    \
+    static inline size_t name##_probe(const name##_entry *entries, size_t capacity,        \
+                                      key_type key)                                        \
+    {                                                                                      \
+        size_t mask = capacity - 1;                                                        \
+        size_t index = (size_t)(ht_int_hash((uint64_t)key) & (uint64_t)mask);             \
+        while (entries[index].value != NULL && entries[index].key != key)                  \
+            index = (index + 1) & mask;                                                    \
+        return index;                                                                      \
+    }                                                                                      \
+                                                                                           \
+    static inline void *name##_get(name *table, key_type key)                              \
+    {                                                                                      \
+        if (table == NULL)                                                                 \
+            return NULL;                                                                   \
+        return table->entries[name##_probe(table->entries, table->capacity, key)].value;   \
+    }                                                                                      \
+                                                                                           \
+    /* Moves every entry into a new array of capacity slots */                             \
+    static inline bool name##_resize(name *table, size_t capacity)                         \
+    {                                                                                      \
+        name##_entry *entries = calloc(capacity, sizeof(name##_entry));                    \
+        if (entries == NULL)                                                               \
+        {                                                                                  \
+            fprintf(stderr, "Error: Failed to allocate memory for new hashtable entries.\n"); \
+            return false;                                                                  \
+        }                                                                                  \
+        for (size_t i = 0; i < table->capacity; i++)                                       \
+        {                                                                                  \
+            if (table->entries[i].value != NULL)                                           \
+                entries[name##_probe(entries, capacity, table->entries[i].key)] =          \
+                    table->entries[i];                                                     \
+        }                                                                                  \
+        free(table->entries);                                                              \
+        table->entries = entries;                                                          \
+        table->capacity = capacity;                                                        \
+        return true;                                                                       \
+    }                                                                                      \
+                                                                                           \
+    static inline bool name##_reserve(name *table, size_t length)                          \
+    {                                                                                      \
+        if (table == NULL)                                                                 \
+            return false;                                                                  \
+        size_t capacity = ht_int_capacity_for(length);                                     \
+        if (capacity == 0)                                                                 \
+        {                                                                                  \
+            fprintf(stderr, "Error: Hashtable capacity overflow.\n");                      \
+            return false;                                                                  \
+        }                                                                                  \
+        return capacity <= table->capacity || name##_resize(table, capacity);              \
+    }                                                                                      \
+                                                                                           \
+    static inline bool name##_set(name *table, key_type key, void *value)                  \
+    {                                                                                      \
+        assert(value != NULL); /* (debug builds) */                                        \
+        if (table == NULL || value == NULL)                                                \
+            return false;                                                                  \
+                                                                                           \
+        /* Expand at 50% load, like ht.c */                                                \
+        if (table->length >= table->capacity / 2)                                          \
+        {                                                                                  \
+            if (table->capacity * 2 < table->capacity ||                                   \
+                !name##_resize(table, table->capacity * 2))                                \
+                return false;                                                              \
+        }                                                                                  \
+                                                                                           \
+        name##_entry *entry = &table->entries[name##_probe(table->entries,                 \
+                                                           table->capacity, key)];         \
+        if (entry->value == NULL)                                                          \
+            table->length++;                                                               \
+        entry->key = key;                                                                  \
+        entry->value = value;                                                              \
+        return true;                                                                       \
+    }                                                                                      \
+                                                                                           \
+    /* Backward-shift deletion, as in ht.c's ht_remove_at */                               \
+    static inline void *name##_remove(name *table, key_type key)                           \
+    {                                                                                      \
+        if (table == NULL)                                                                 \
+            return NULL;                                                                   \
+                                                                                           \
+        name##_entry *entries = table->entries;                                            \
+        size_t mask = table->capacity - 1;                                                 \
+        size_t hole = name##_probe(entries, table->capacity, key);                         \
+        void *value = entries[hole].value;                                                 \
+        if (value == NULL)                                                                 \
+            return NULL;                                                                   \
+                                                                                           \
+        for (size_t next = (hole + 1) & mask; entries[next].value != NULL;                 \
+             next = (next + 1) & mask)                                                     \
+        {                                                                                  \
+            size_t home = (size_t)(ht_int_hash((uint64_t)entries[next].key) & mask);       \
+            if (((next - home) & mask) >= ((next - hole) & mask))                          \
+            {                                                                              \
+                entries[hole] = entries[next];                                             \
+                hole = next;                                                               \
+            }                                                                              \
+        }                                                                                  \
+        entries[hole].value = NULL;                                                        \
+        table->length--;                                                                   \
+        return value;                                                                      \
+    }                                                                                      \
+                                                                                           \
+    static inline size_t name##_length(name *table)                                        \
+    {                                                                                      \
+        return table != NULL ? table->length : 0;                                          \
+    }                                                                                      \
+                                                                                           \
+    static inline name##_it name##_iterator(name *table)                                   \
+    {                                                                                      \
+        name##_it it;                                                                      \
+        it.key = 0;                                                                        \
+        it.value = NULL;                                                                   \
+        it._table = table;                                                                 \
+        it._index = 0;                                                                     \
+        return it;                                                                         \
+    }                                                                                      \
+                                                                                           \
+    /* Don't call name_set or name_remove during iteration */                              \
+    static inline bool name##_next(name##_it *it)                                          \
+    {                                                                                      \
+        if (it == NULL || it->_table == NULL)                                              \
+            return false;                                                                  \
+                                                                                           \
+        name *table = it->_table;                                                          \
+        while (it->_index < table->capacity)                                               \
+        {                                                                                  \
+            name##_entry *entry = &table->entries[it->_index++];                           \
+            if (entry->value != NULL)                                                      \
+            {                                                                              \
+                it->key = entry->key;                                                      \
+                it->value = entry->value;                                                  \
+                return true;                                                               \
+            }                                                                              \
+        }                                                                                  \
+        it->key = 0;                                                                       \
+        it->value = NULL;                                                                  \
+        return false;                                                                      \
+    }
+
+HT_INT_DEFINE(ht_u32, uint32_t)
+HT_INT_DEFINE(ht_u64, uint64_t)
+
+#endif
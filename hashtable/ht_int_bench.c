@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include "ht.h"
+#include "ht_int.h"
+
+/*
+ * Integer-keyed table benchmark
+ *
+ * Compares ht_u64 against integer IDs formatted into ht string keys:
+ * gcc -O2 -o ht_int_bench ht_int_bench.c ht.c
+ *
+ * Usage: ./ht_int_bench [number of keys]
+ * Defaults to 1000000 keys. The string table pays for snprintf on every operation,
+ * as callers that turn IDs into keys do. IDs are spread out (i * 2654435761) rather
+ * than sequential, like database or user IDs.
+ * On glibc it also reports the heap bytes per entry of each table, keys included.
+ */
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Bytes currently allocated from the heap, or 0 where it can't be measured
+static size_t heap_in_use(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+static void report(const char *name, size_t ops, double seconds)
+{
+    printf("%-20s %10.2f ns/op %10.2f Mops/s\n", name, seconds * 1e9 / (double)ops, (double)ops / seconds / 1e6);
+}
+
+static inline uint64_t id_of(size_t i)
+{
+    return (uint64_t)i * 2654435761ULL;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    if (n == 0)
+    {
+        fprintf(stderr, "Error: need at least one key.\n");
+        return 1;
+    }
+
+    // --- ht_u64 ---
+    size_t heap = heap_in_use();
+    double start = now_sec();
+    ht_u64 *ints = ht_u64_create();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (ints == NULL || !ht_u64_set(ints, id_of(i), (void *)(uintptr_t)(i + 1)))
+        {
+            fprintf(stderr, "Error: ht_u64_set failed.\n");
+            return 1;
+        }
+    }
+    report("ht_u64 insert", n, now_sec() - start);
+    size_t int_bytes = heap_in_use() - heap;
+
+    size_t found = 0;
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        found += ht_u64_get(ints, id_of(i)) != NULL;
+    report("ht_u64 lookup", n, now_sec() - start);
+
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+        found += ht_u64_remove(ints, id_of(i)) != NULL;
+    report("ht_u64 remove", n, now_sec() - start);
+    ht_u64_destroy(ints);
+
+    // --- ht with formatted keys ---
+    char key[24];
+    heap = heap_in_use();
+    start = now_sec();
+    ht *strings = ht_create();
+    for (size_t i = 0; i < n; i++)
+    {
+        snprintf(key, sizeof(key), "%llu", (unsigned long long)id_of(i));
+        if (strings == NULL || ht_set(strings, key, (void *)(uintptr_t)(i + 1)) == NULL)
+        {
+            fprintf(stderr, "Error: ht_set failed.\n");
+            return 1;
+        }
+    }
+    report("ht string insert", n, now_sec() - start);
+    size_t string_bytes = heap_in_use() - heap;
+
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+    {
+        snprintf(key, sizeof(key), "%llu", (unsigned long long)id_of(i));
+        found += ht_get(strings, key) != NULL;
+    }
+    report("ht string lookup", n, now_sec() - start);
+
+    start = now_sec();
+    for (size_t i = 0; i < n; i++)
+    {
+        snprintf(key, sizeof(key), "%llu", (unsigned long long)id_of(i));
+        found += ht_remove(strings, key) != NULL;
+    }
+    report("ht string remove", n, now_sec() - start);
+    ht_destroy(strings);
+
+    if (found != 4 * n)
+    {
+        fprintf(stderr, "Error: lookups returned wrong results.\n");
+        return 1;
+    }
+
+    if (int_bytes != 0)
+        printf("heap per entry: ht_u64 %.1f bytes, ht string %.1f bytes\n", (double)int_bytes / (double)n,
+               (double)string_bytes / (double)n);
+    return 0;
+}
@@ -0,0 +1,589 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <sched.h>
+#include <pthread.h>
+#include "ht_rcu.h"
+#include "ht_hash.h"
+
+/*
+ * Concurrent Hashtable with Lock-free Reads
+ *
+ * Same open addressing and linear probing as ht.c, with every slot field read atomically:
+ * gcc -O2 -pthread -c ht_rcu.c
+ *
+ * Usage:
+ * rht *table = rht_create();
+ * rht_set(table, "key", value);        // writers take the table mutex
+ * void *value = rht_get(table, "key"); // readers never lock or wait
+ * rht_destroy(table);
+ *
+ * Writers publish slots in an order readers can rely on: the hash and value are
+ * written before the key pointer (release), so a reader that sees the key (acquire)
+ * also sees the rest of the entry. A slot's key never changes once set, so readers
+ * can compare keys without fear of them changing underneath.
+ * Removing stores a NULL value and leaves the key in place as a tombstone; tombstones
+ * are dropped when the table is rebuilt into a new array.
+ *
+ * A rebuild copies the live entries into a new array and publishes it with one atomic
+ * store. The old array is retired: readers that loaded it before the swap keep using
+ * it safely, and it is only freed once every such reader has left its read section.
+ *
+ * Epoch-based reclamation
+ * ----------
+ * Every thread that reads gets a reader record, holding the global epoch it saw when
+ * entering its current read section (or 0 outside of one). Retiring an array bumps
+ * the global epoch to E; the array can be freed once no reader record holds an epoch
+ * below E, since any reader entering later sees the new array.
+ */
+
+// --- Hashtable Entry ---
+// Like ht.c's entry, with the fields readers load concurrently made atomic.
+typedef struct
+{
+    _Atomic(const char *) key; // NULL for an empty slot, set once
+    _Atomic(void *) value;     // NULL for a removed key (tombstone)
+    uint64_t hash;             // Written before key is published
+} rht_entry;
+
+// --- Entries Array ---
+// Published as a whole, so readers always see a capacity matching the entries.
+typedef struct rht_array
+{
+    size_t capacity;
+    struct rht_array *retired_next; // Retired list link
+    uint64_t retired_epoch;         // Global epoch at which it was retired
+    rht_entry entries[];
+} rht_array;
+
+// --- Hashtable Structure ---
+struct rht
+{
+    _Atomic(rht_array *) current;
+    pthread_mutex_t write_lock; // Serializes writers
+    size_t length;              // Live keys, written under write_lock
+    size_t used;                // Slots holding a key, live or tombstone
+    rht_array *retired;         // Arrays waiting for readers to move on
+};
+
+// --- Initial Capacity ---
+#define INITIAL_CAPACITY 16
+
+// --- Reader Records ---
+// One per thread that ever read a table, kept in a global lock-free list.
+// Records of exited threads are released and reused by new threads.
+typedef struct rcu_reader
+{
+    _Atomic uint64_t epoch;  // Epoch seen on entering the read section, 0 when outside
+    _Atomic bool in_use;     // Owned by a live thread
+    unsigned nesting;        // Nested read sections of the owner (e.g. rht_get while iterating)
+    struct rcu_reader *next; // Immutable once the record is published
+} rcu_reader;
+
+static _Atomic(rcu_reader *) rcu_readers = NULL;
+static _Atomic uint64_t rcu_epoch = 1;
+static _Thread_local rcu_reader *rcu_self = NULL;
+
+static pthread_key_t rcu_exit_key;
+static pthread_once_t rcu_exit_once = PTHREAD_ONCE_INIT;
+
+// Thread exit hook: hand the record over to future threads.
+static void rcu_release_reader(void *record)
+{
+    atomic_store(&((rcu_reader *)record)->in_use, false);
+}
+
+static void rcu_init_exit_key(void)
+{
+    pthread_key_create(&rcu_exit_key, rcu_release_reader);
+}
+
+/*
+ * rcu_register
+ * ----------
+ * Gives the calling thread a reader record: a released one if available, a new one otherwise.
+ * Runs once per thread; both paths are a single compare-and-swap, no lock.
+ */
+static rcu_reader *rcu_register(void)
+{
+    pthread_once(&rcu_exit_once, rcu_init_exit_key);
+
+    rcu_reader *record = NULL;
+    for (rcu_reader *r = atomic_load(&rcu_readers); r != NULL; r = r->next)
+    {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&r->in_use, &expected, true))
+        {
+            record = r;
+            break;
+        }
+    }
+
+    if (record == NULL)
+    {
+        record = malloc(sizeof(rcu_reader));
+        if (record == NULL)
+        {
+            fprintf(stderr, "Error: Failed to allocate memory for reader record.\n");
+            abort();
+        }
+        atomic_init(&record->epoch, 0);
+        atomic_init(&record->in_use, true);
+        record->next = atomic_load(&rcu_readers);
+        while (!atomic_compare_exchange_weak(&rcu_readers, &record->next, record))
+            ;
+    }
+
+    record->nesting = 0;
+    pthread_setspecific(rcu_exit_key, record);
+    return record;
+}
+
+/*
+ * rcu_read_enter / rcu_read_exit
+ * ----------
+ * Delimit a read section; every array pointer loaded inside stays valid until the exit.
+ * The epoch store is sequentially consistent, so a writer scanning the records after
+ * retiring an array either sees this reader or this reader sees the new array.
+ */
+static inline void rcu_read_enter(void)
+{
+    rcu_reader *self = rcu_self;
+    if (self == NULL)
+        self = rcu_self = rcu_register();
+
+    if (self->nesting++ == 0)
+        atomic_store(&self->epoch, atomic_load(&rcu_epoch));
+}
+
+static inline void rcu_read_exit(void)
+{
+    rcu_reader *self = rcu_self;
+    if (--self->nesting == 0)
+        atomic_store_explicit(&self->epoch, 0, memory_order_release);
+}
+
+/*
+ * rcu_oldest_epoch
+ * ----------
+ * Returns the smallest epoch held by a reader inside a read section, or UINT64_MAX if none.
+ */
+static uint64_t rcu_oldest_epoch(void)
+{
+    uint64_t oldest = UINT64_MAX;
+    for (rcu_reader *r = atomic_load(&rcu_readers); r != NULL; r = r->next)
+    {
+        uint64_t epoch = atomic_load(&r->epoch);
+        if (epoch != 0 && epoch < oldest)
+            oldest = epoch;
+    }
+    return oldest;
+}
+
+/*
+ * rht_synchronize
+ * ----------
+ * Bumps the epoch, then yields until no reader still holds an earlier one.
+ */
+void rht_synchronize(void)
+{
+    uint64_t epoch = atomic_fetch_add(&rcu_epoch, 1) + 1;
+    while (rcu_oldest_epoch() < epoch)
+        sched_yield();
+}
+
+/*
+ * rht_array_new
+ * ----------
+ * Allocates an array of empty slots.
+ */
+static rht_array *rht_array_new(size_t capacity)
+{
+    rht_array *array = calloc(1, sizeof(rht_array) + capacity * sizeof(rht_entry));
+    if (array == NULL)
+        return NULL;
+    array->capacity = capacity;
+    return array;
+}
+
+/*
+ * rht_array_free
+ * ----------
+ * Frees a retired array, along with the keys of its tombstones:
+ * those were not carried over to the new array, so nothing else references them.
+ */
+static void rht_array_free(rht_array *array)
+{
+    for (size_t i = 0; i < array->capacity; i++)
+    {
+        rht_entry *entry = &array->entries[i];
+        const char *key = atomic_load_explicit(&entry->key, memory_order_relaxed);
+        if (key != NULL && atomic_load_explicit(&entry->value, memory_order_relaxed) == NULL)
+            free((void *)key);
+    }
+    free(array);
+}
+
+/*
+ * rht_reclaim
+ * ----------
+ * Frees the retired arrays no reader can still hold. Called by writers, under write_lock.
+ */
+static void rht_reclaim(rht *table)
+{
+    if (table->retired == NULL)
+        return;
+
+    uint64_t oldest = rcu_oldest_epoch();
+    rht_array **link = &table->retired;
+    while (*link != NULL)
+    {
+        rht_array *array = *link;
+        if (array->retired_epoch <= oldest)
+        {
+            *link = array->retired_next;
+            rht_array_free(array);
+        }
+        else
+        {
+            link = &array->retired_next;
+        }
+    }
+}
+
+/*
+ * rht_create
+ * ----------
+ * Allocates and initializes a new table.
+ * Returns a pointer to the new table, or NULL on failure.
+ */
+rht *rht_create(void)
+{
+    rht *table = malloc(sizeof(rht));
+    if (table == NULL)
+        return NULL;
+
+    rht_array *array = rht_array_new(INITIAL_CAPACITY);
+    if (array == NULL || pthread_mutex_init(&table->write_lock, NULL) != 0)
+    {
+        free(array);
+        free(table);
+        return NULL;
+    }
+
+    atomic_init(&table->current, array);
+    table->length = 0;
+    table->used = 0;
+    table->retired = NULL;
+    return table;
+}
+
+/*
+ * rht_destroy
+ * ----------
+ * Frees the current array with all its keys, and every retired array.
+ */
+void rht_destroy(rht *table)
+{
+    if (table == NULL)
+        return;
+
+    rht_array *array = atomic_load(&table->current);
+    for (size_t i = 0; i < array->capacity; i++)
+        free((void *)atomic_load_explicit(&array->entries[i].key, memory_order_relaxed));
+    free(array);
+
+    while (table->retired != NULL)
+    {
+        rht_array *retired = table->retired;
+        table->retired = retired->retired_next;
+        rht_array_free(retired);
+    }
+
+    pthread_mutex_destroy(&table->write_lock);
+    free(table);
+}
+
+/*
+ * rht_probe
+ * ----------
+ * Walks the linear probe sequence of key in an array.
+ * Returns the index of the slot holding key (possibly as a tombstone) and sets *found,
+ * or returns the empty slot that ends the sequence and clears *found.
+ * Readers must rely on *found rather than reloading the slot's key: a writer may
+ * publish another key in that empty slot right after the probe looked at it.
+ * Every step is a bounded amount of work, so lookups are wait-free.
+ */
+static size_t rht_probe(rht_array *array, const char *key, uint64_t hash, bool *found)
+{
+    size_t mask = array->capacity - 1;
+    size_t index = (size_t)(hash & (uint64_t)mask);
+
+    for (;;)
+    {
+        const char *stored = atomic_load_explicit(&array->entries[index].key, memory_order_acquire);
+        if (stored == NULL || (array->entries[index].hash == hash && strcmp(key, stored) == 0))
+        {
+            *found = stored != NULL;
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+/*
+ * rht_get
+ * ----------
+ * Looks up a key in the current array inside a read section.
+ * Returns NULL if the key is not found or was removed.
+ */
+void *rht_get(rht *table, const char *key)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+
+    uint64_t hash = hash_key(key);
+
+    bool found;
+    rcu_read_enter();
+    rht_array *array = atomic_load(&table->current);
+    size_t index = rht_probe(array, key, hash, &found);
+    void *value = found ? atomic_load_explicit(&array->entries[index].value, memory_order_acquire) : NULL;
+    rcu_read_exit();
+
+    return value;
+}
+
+/*
+ * rht_rebuild
+ * ----------
+ * Copies the live entries of the current array into a new one, sized so that the
+ * live keys fill at most a quarter of it, then publishes it and retires the old one.
+ * Keys are shared between the arrays; tombstones are left behind in the old one.
+ * Called under write_lock. Returns true on success, false if out of memory.
+ */
+static bool rht_rebuild(rht *table)
+{
+    rht_array *old = atomic_load_explicit(&table->current, memory_order_relaxed);
+
+    size_t capacity = INITIAL_CAPACITY;
+    while (table->length >= capacity / 4)
+    {
+        capacity *= 2;
+        if (capacity == 0)
+        {
+            fprintf(stderr, "Error: Hashtable capacity overflow during expansion.\n");
+            return false;
+        }
+    }
+
+    rht_array *array = rht_array_new(capacity);
+    if (array == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for new hashtable entries.\n");
+        return false;
+    }
+
+    // Nobody sees the new array yet: relaxed stores are enough, the publishing store orders them
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < old->capacity; i++)
+    {
+        rht_entry *entry = &old->entries[i];
+        const char *key = atomic_load_explicit(&entry->key, memory_order_relaxed);
+        void *value = atomic_load_explicit(&entry->value, memory_order_relaxed);
+        if (key == NULL || value == NULL)
+            continue;
+
+        size_t index = (size_t)(entry->hash & (uint64_t)mask);
+        while (atomic_load_explicit(&array->entries[index].key, memory_order_relaxed) != NULL)
+            index = (index + 1) & mask;
+
+        array->entries[index].hash = entry->hash;
+        atomic_store_explicit(&array->entries[index].value, value, memory_order_relaxed);
+        atomic_store_explicit(&array->entries[index].key, key, memory_order_relaxed);
+    }
+
+    atomic_store(&table->current, array);
+    table->used = table->length;
+
+    // Readers entering from now on see the new array
+    old->retired_epoch = atomic_fetch_add(&rcu_epoch, 1) + 1;
+    old->retired_next = table->retired;
+    table->retired = old;
+    return true;
+}
+
+/*
+ * rht_set
+ * ----------
+ * Updates the value of an existing key in place, or publishes a new slot.
+ * Rebuilds the table first when live keys and tombstones reach 50% of the slots.
+ * Returns a pointer to the stored key string on success, NULL on failure.
+ */
+const char *rht_set(rht *table, const char *key, void *value)
+{
+    assert(value != NULL); // (debug builds)
+    if (table == NULL || key == NULL || value == NULL)
+        return NULL;
+
+    uint64_t hash = hash_key(key);
+    const char *stored = NULL;
+
+    pthread_mutex_lock(&table->write_lock);
+    rht_reclaim(table);
+
+    rht_array *array = atomic_load_explicit(&table->current, memory_order_relaxed);
+    if (table->used >= array->capacity / 2)
+    {
+        if (!rht_rebuild(table))
+            goto unlock;
+        array = atomic_load_explicit(&table->current, memory_order_relaxed);
+    }
+
+    bool found;
+    rht_entry *entry = &array->entries[rht_probe(array, key, hash, &found)];
+    if (found)
+    {
+        stored = atomic_load_explicit(&entry->key, memory_order_relaxed);
+        // Existing key, or a tombstone coming back to life
+        if (atomic_load_explicit(&entry->value, memory_order_relaxed) == NULL)
+            table->length++;
+        atomic_store_explicit(&entry->value, value, memory_order_release);
+        goto unlock;
+    }
+
+    char *new_key_copy = strdup(key);
+    if (new_key_copy == NULL)
+        goto unlock;
+
+    entry->hash = hash;
+    atomic_store_explicit(&entry->value, value, memory_order_relaxed);
+    atomic_store_explicit(&entry->key, new_key_copy, memory_order_release); // Publishes the slot
+    stored = new_key_copy;
+    table->length++;
+    table->used++;
+
+unlock:
+    pthread_mutex_unlock(&table->write_lock);
+    return stored;
+}
+
+/*
+ * rht_remove
+ * ----------
+ * Turns the key's slot into a tombstone by clearing its value.
+ * Returns the value that was stored with the key, or NULL if it was not found.
+ */
+void *rht_remove(rht *table, const char *key)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+
+    uint64_t hash = hash_key(key);
+    void *value = NULL;
+
+    pthread_mutex_lock(&table->write_lock);
+    rht_array *array = atomic_load_explicit(&table->current, memory_order_relaxed);
+    bool found;
+    rht_entry *entry = &array->entries[rht_probe(array, key, hash, &found)];
+    if (found)
+    {
+        value = atomic_load_explicit(&entry->value, memory_order_relaxed);
+        if (value != NULL)
+        {
+            atomic_store_explicit(&entry->value, NULL, memory_order_release);
+            table->length--;
+        }
+    }
+    pthread_mutex_unlock(&table->write_lock);
+    return value;
+}
+
+/*
+ * rht_length
+ * ----------
+ * Returns the number of live keys, as of the last completed write.
+ */
+size_t rht_length(rht *table)
+{
+    if (table == NULL)
+        return 0;
+
+    pthread_mutex_lock(&table->write_lock);
+    size_t length = table->length;
+    pthread_mutex_unlock(&table->write_lock);
+    return length;
+}
+
+/*
+ * rht_iterator
+ * ----------
+ * Enters a read section and pins the current array for the whole iteration.
+ */
+rhti rht_iterator(rht *table)
+{
+    rhti it;
+    it._index = 0;
+    it._array = NULL;
+    it.key = NULL;
+    it.value = NULL;
+
+    if (table != NULL)
+    {
+        rcu_read_enter();
+        it._array = atomic_load(&table->current);
+    }
+    return it;
+}
+
+/*
+ * rht_next
+ * ----------
+ * Advances to the next live slot of the pinned array.
+ * Leaves the read section when there are no more entries.
+ */
+bool rht_next(rhti *it)
+{
+    if (it == NULL || it->_array == NULL)
+        return false;
+
+    rht_array *array = it->_array;
+
+    while (it->_index < array->capacity)
+    {
+        rht_entry *entry = &array->entries[it->_index];
+        it->_index++;
+
+        const char *key = atomic_load_explicit(&entry->key, memory_order_acquire);
+        void *value = key != NULL ? atomic_load_explicit(&entry->value, memory_order_acquire) : NULL;
+        if (value != NULL)
+        {
+            it->key = key;
+            it->value = value;
+            return true;
+        }
+    }
+
+    rht_iterator_stop(it);
+    return false;
+}
+
+/*
+ * rht_iterator_stop
+ * ----------
+ * Leaves the iterator's read section. Safe to call after rht_next returned false.
+ */
+void rht_iterator_stop(rhti *it)
+{
+    if (it == NULL || it->_array == NULL)
+        return;
+
+    it->_array = NULL;
+    it->key = NULL;
+    it->value = NULL;
+    rcu_read_exit();
+}
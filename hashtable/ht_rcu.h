@@ -0,0 +1,72 @@
+#ifndef HT_RCU_H
+#define HT_RCU_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/*
+ * Concurrent hashtable with a lock-free read path.
+ * Lookups take no lock and never wait: they read the slots of the current entries
+ * array with atomic loads. Writers are serialized by a mutex and publish a whole new
+ * array when the table grows; old arrays are freed by an epoch-based reclaimer once
+ * no reader can still be using them.
+ */
+
+typedef struct rht rht;
+
+/** Create an empty table, or NULL if out of memory */
+rht *rht_create(void);
+
+/** Free the table, its keys and all retired arrays. No other thread may be using the table. */
+void rht_destroy(rht *table);
+
+/** Get item with given key, or NULL if not found. Wait-free, safe from any thread. */
+void *rht_get(rht *table, const char *key);
+
+/** Set item with given key to value (which must not be NULL). Writers run one at a time.
+ *  Return the address of the table's copy of the key, or NULL if out of memory.
+ *  The copy stays valid until the table is destroyed or the key is removed and the
+ *  array holding it has been reclaimed.
+ */
+const char *rht_set(rht *table, const char *key, void *value);
+
+/** Remove item with given key. Return the value stored with it, or NULL if not found.
+ *  Readers may still be using the returned value: call rht_synchronize before freeing it.
+ */
+void *rht_remove(rht *table, const char *key);
+
+/** Number of items in the table */
+size_t rht_length(rht *table);
+
+/** Wait until every read (rht_get or iteration) running at the time of the call has finished */
+void rht_synchronize(void);
+
+/** Concurrent Table Iterator: create with rht_iterator, iterate with rht_next.
+ *  Iteration is weakly consistent: it walks the entries array that was current when
+ *  the iterator was created, never returns a key twice, returns every key present for
+ *  the whole iteration, and may or may not return keys set or removed meanwhile.
+ *  The iterator holds a read-side epoch, so stopping before rht_next returns false
+ *  requires rht_iterator_stop.
+ */
+typedef struct
+{
+    const char *key;
+    void *value;
+
+    // don't use these directly
+    void *_array;
+    size_t _index;
+} rhti;
+
+/** Returns new concurrent table iterator */
+rhti rht_iterator(rht *table);
+
+/** Moves iterator to next item, update its key and value, and return true.
+ *  If there are no more items it will return false.
+ */
+bool rht_next(rhti *it);
+
+/** End an iteration that stops before rht_next returned false */
+void rht_iterator_stop(rhti *it);
+
+#endif
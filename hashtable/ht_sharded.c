@@ -0,0 +1,291 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "ht_sharded.h"
+#include "ht_hash.h"
+
+/*
+ * Sharded Concurrent Hashtable
+ *
+ * Builds on any ht.h layout (ht.c or ht_swiss.c):
+ * gcc -O2 -pthread -c ht_sharded.c ht.c
+ *
+ * Usage:
+ * sht *table = sht_create(0, NULL);
+ * sht_set(table, "key", value);        // from any thread
+ * void *value = sht_get(table, "key"); // from any thread
+ * sht_destroy(table);
+ *
+ * The shard of a key is picked by the top bits of its hash (with the function chosen
+ * by ht_options.hash), while the shards index their slots with the low bits, so keys
+ * spread evenly inside each shard.
+ */
+
+// --- Default Shard Count ---
+// Enough shards that 64 threads rarely collide on the same lock.
+#define DEFAULT_SHARDS 64
+#define MAX_SHARDS 65536
+
+// --- Shard ---
+// Aligned to a cache line so locking one shard doesn't bounce its neighbours' lines.
+typedef struct
+{
+    _Alignas(64) pthread_rwlock_t lock;
+    ht *table;
+} sht_shard;
+
+// --- Sharded Table Structure ---
+struct sht
+{
+    sht_shard *shards;
+    size_t count; // Number of shards, a power of 2
+    int bits;     // log2(count): number of top hash bits selecting the shard
+
+    // The shards' hash function and seed, whose top bits route a key to its shard.
+    // Only HT_HASH_SEEDED with no seed given draws a random seed of the router's own.
+    ht_hash_fn hash_fn;
+    uint64_t seed;
+};
+
+/*
+ * sht_shard_of
+ * ----------
+ * Returns the shard responsible for key, chosen by the top bits of its hash.
+ */
+static sht_shard *sht_shard_of(sht *table, const char *key)
+{
+    if (table->bits == 0)
+        return &table->shards[0];
+    return &table->shards[table->hash_fn(key, strlen(key), table->seed) >> (64 - table->bits)];
+}
+
+/*
+ * sht_create
+ * ----------
+ * Allocates the shards and creates one ht per shard with the given options.
+ * Returns a pointer to the new table, or NULL on failure.
+ */
+sht *sht_create(size_t shards, const ht_options *opts)
+{
+    if (opts != NULL && (opts->flags & HT_INCREMENTAL))
+    {
+        fprintf(stderr, "Error: HT_INCREMENTAL is not supported by the sharded table.\n");
+        return NULL;
+    }
+    if (shards == 0)
+        shards = DEFAULT_SHARDS;
+    if (shards > MAX_SHARDS)
+        shards = MAX_SHARDS;
+
+    ht_hash_fn hash_fn;
+    uint64_t seed;
+    if (!hash_select(opts, &hash_fn, &seed))
+        return NULL;
+
+    sht *table = malloc(sizeof(sht));
+    if (table == NULL)
+        return NULL;
+
+    table->hash_fn = hash_fn;
+    table->seed = seed;
+
+    table->count = 1;
+    table->bits = 0;
+    while (table->count < shards)
+    {
+        table->count *= 2;
+        table->bits++;
+    }
+
+    table->shards = aligned_alloc(64, table->count * sizeof(sht_shard));
+    if (table->shards == NULL)
+    {
+        free(table);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < table->count; i++)
+    {
+        sht_shard *shard = &table->shards[i];
+        shard->table = ht_create_opts(opts);
+        // Instrumented layouts bump their counters with plain writes, even in ht_get,
+        // so readers sharing a shard's read lock would race on them
+        ht_counters counters;
+        bool instrumented = i == 0 && shard->table != NULL && ht_read_counters(shard->table, &counters);
+        if (instrumented)
+            fprintf(stderr, "Error: the sharded table can't use a layout built with HT_INSTRUMENT.\n");
+        if (shard->table == NULL || instrumented || pthread_rwlock_init(&shard->lock, NULL) != 0)
+        {
+            ht_destroy(shard->table);
+            table->count = i; // Only tear down the shards set up so far
+            sht_destroy(table);
+            return NULL;
+        }
+    }
+    return table;
+}
+
+/*
+ * sht_destroy
+ * ----------
+ * Frees every shard and the table itself.
+ */
+void sht_destroy(sht *table)
+{
+    if (table == NULL)
+        return;
+
+    for (size_t i = 0; i < table->count; i++)
+    {
+        pthread_rwlock_destroy(&table->shards[i].lock);
+        ht_destroy(table->shards[i].table);
+    }
+    free(table->shards);
+    free(table);
+}
+
+/*
+ * sht_get
+ * ----------
+ * Looks up a key under its shard's read lock.
+ */
+void *sht_get(sht *table, const char *key)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+
+    sht_shard *shard = sht_shard_of(table, key);
+    pthread_rwlock_rdlock(&shard->lock);
+    void *value = ht_get(shard->table, key);
+    pthread_rwlock_unlock(&shard->lock);
+    return value;
+}
+
+/*
+ * sht_set
+ * ----------
+ * Sets a key under its shard's write lock.
+ */
+const char *sht_set(sht *table, const char *key, void *value)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+
+    sht_shard *shard = sht_shard_of(table, key);
+    pthread_rwlock_wrlock(&shard->lock);
+    const char *stored = ht_set(shard->table, key, value);
+    pthread_rwlock_unlock(&shard->lock);
+    return stored;
+}
+
+/*
+ * sht_remove
+ * ----------
+ * Removes a key under its shard's write lock.
+ */
+void *sht_remove(sht *table, const char *key)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+
+    sht_shard *shard = sht_shard_of(table, key);
+    pthread_rwlock_wrlock(&shard->lock);
+    void *value = ht_remove(shard->table, key);
+    pthread_rwlock_unlock(&shard->lock);
+    return value;
+}
+
+/*
+ * sht_length
+ * ----------
+ * Sums the shard lengths, locking one shard at a time.
+ */
+size_t sht_length(sht *table)
+{
+    if (table == NULL)
+        return 0;
+
+    size_t length = 0;
+    for (size_t i = 0; i < table->count; i++)
+    {
+        pthread_rwlock_rdlock(&table->shards[i].lock);
+        length += ht_length(table->shards[i].table);
+        pthread_rwlock_unlock(&table->shards[i].lock);
+    }
+    return length;
+}
+
+/*
+ * sht_iterator
+ * ----------
+ * Initializes and returns a new iterator. No lock is taken until the first sht_next.
+ */
+shti sht_iterator(sht *table)
+{
+    shti it;
+    it._table = table;
+    it._shard = 0;
+    it._locked = false;
+    it.key = NULL;
+    it.value = NULL;
+    return it;
+}
+
+/*
+ * sht_next
+ * ----------
+ * Walks the shards in order, holding the read lock of the current one.
+ * Returns true if there is a next entry, false otherwise (with no lock held).
+ */
+bool sht_next(shti *it)
+{
+    if (it == NULL || it->_table == NULL)
+        return false;
+
+    sht *table = it->_table;
+
+    while (it->_shard < table->count)
+    {
+        sht_shard *shard = &table->shards[it->_shard];
+        if (!it->_locked)
+        {
+            pthread_rwlock_rdlock(&shard->lock);
+            it->_it = ht_iterator(shard->table);
+            it->_locked = true;
+        }
+
+        if (ht_next(&it->_it))
+        {
+            it->key = it->_it.key;
+            it->value = it->_it.value;
+            return true;
+        }
+
+        // Shard done: release it before moving on
+        pthread_rwlock_unlock(&shard->lock);
+        it->_locked = false;
+        it->_shard++;
+    }
+
+    it->key = NULL;
+    it->value = NULL;
+    return false;
+}
+
+/*
+ * sht_iterator_stop
+ * ----------
+ * Releases the lock of an iteration that ends early. Safe to call after sht_next returned false.
+ */
+void sht_iterator_stop(shti *it)
+{
+    if (it == NULL || !it->_locked)
+        return;
+
+    pthread_rwlock_unlock(&it->_table->shards[it->_shard].lock);
+    it->_locked = false;
+    it->_shard = it->_table->count;
+}
@@ -0,0 +1,73 @@
+#ifndef HT_SHARDED_H
+#define HT_SHARDED_H
+
+#include "ht.h"
+
+/*
+ * Sharded concurrent hashtable built on top of ht.
+ * The keyspace is split by the high bits of the key hash across independent ht shards,
+ * each guarded by its own reader-writer lock, so threads working on different shards
+ * never contend and lookups in the same shard run in parallel.
+ */
+
+typedef struct sht sht;
+
+/** Create a table with the given number of shards (rounded up to a power of 2, 0 for 64).
+ *  Every shard is created with opts (NULL for defaults). HT_INCREMENTAL is rejected,
+ *  because lookups would then modify a shard while holding only its read lock, and so
+ *  is a layout compiled with -DHT_INSTRUMENT, whose lookups update its counters.
+ *  Return NULL if out of memory or if the options are invalid.
+ */
+sht *sht_create(size_t shards, const ht_options *opts);
+
+/** Free the table and every shard. No other thread may be using the table. */
+void sht_destroy(sht *table);
+
+/** Get item with given key, or NULL if not found. Safe to call from any thread. */
+void *sht_get(sht *table, const char *key);
+
+/** Set item with given key to value (which must not be NULL). Safe to call from any thread.
+ *  Return the address of the table's copy of the key, or NULL if out of memory.
+ *  The copy stays valid until the key is removed, by any thread. With HT_KEY_ARENA it
+ *  stays valid until the table is destroyed. With HT_KEY_INLINE a short key is copied
+ *  into its slot, so the address is only valid until the next call, from any thread,
+ *  that modifies the key's shard: don't use it unless no other thread writes.
+ */
+const char *sht_set(sht *table, const char *key, void *value);
+
+/** Remove item with given key. Return the value stored with it, or NULL if not found. */
+void *sht_remove(sht *table, const char *key);
+
+/** Number of items in all shards. Each shard is counted under its lock, not all at once. */
+size_t sht_length(sht *table);
+
+/** Sharded Table Iterator: create with sht_iterator, iterate with sht_next.
+ *  The shard being walked is read-locked, so other threads can still read it
+ *  and can modify every other shard. Stopping before sht_next returns false
+ *  requires sht_iterator_stop to release the lock.
+ */
+typedef struct
+{
+    const char *key;
+    void *value;
+
+    // don't use these directly
+    sht *_table;
+    size_t _shard;
+    hti _it;
+    bool _locked;
+} shti;
+
+/** Returns new sharded table iterator */
+shti sht_iterator(sht *table);
+
+/** Moves iterator to next item, update its key and value, and return true.
+ *  If there are no more items it will return false.
+ *  Don't set or remove keys from the same thread during iteration.
+ */
+bool sht_next(shti *it);
+
+/** Release the iterator's lock when stopping before sht_next returned false */
+void sht_iterator_stop(shti *it);
+
+#endif
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include "ht_sharded.h"
+
+/*
+ * Sharded hashtable scaling benchmark
+ *
+ * gcc -O2 -pthread -o ht_sharded_bench ht_sharded_bench.c ht_sharded.c ht.c
+ *
+ * Usage: ./ht_sharded_bench [number of keys] [shards] [ops per thread] [max threads]
+ * Defaults to 1000000 keys, 64 shards, 1000000 ops per thread and up to 64 threads.
+ * Runs a read-heavy (95% get / 5% set) and a write-heavy (50/50) mix at 1, 2, 4 ... threads.
+ * With 1 shard every operation goes through a single lock, the global-mutex baseline.
+ */
+
+#define KEY_SIZE 24
+
+typedef struct
+{
+    sht *table;
+    const char *keys;
+    size_t n;
+    size_t ops;
+    unsigned write_percent;
+    uint64_t seed;
+} worker_args;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: cheap per-thread random numbers
+static inline uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/*
+ * worker
+ * ----------
+ * Runs ops random operations on existing keys: a set for write_percent of them, a get otherwise.
+ */
+static void *worker(void *arg)
+{
+    worker_args *args = arg;
+    uint64_t state = args->seed;
+
+    for (size_t i = 0; i < args->ops; i++)
+    {
+        uint64_t r = next_random(&state);
+        const char *key = args->keys + (r >> 8) % args->n * KEY_SIZE;
+        if ((r & 0xFF) % 100 < args->write_percent)
+            sht_set(args->table, key, (void *)(uintptr_t)(i + 1));
+        else if (sht_get(args->table, key) == NULL)
+            fprintf(stderr, "Error: key %s missing.\n", key);
+    }
+    return NULL;
+}
+
+/*
+ * run_mix
+ * ----------
+ * Times nthreads workers running the same mix concurrently.
+ * Returns the aggregate throughput in operations per second.
+ */
+static double run_mix(sht *table, const char *keys, size_t n, size_t ops, unsigned write_percent, size_t nthreads)
+{
+    pthread_t *threads = malloc(nthreads * sizeof(pthread_t));
+    worker_args *args = malloc(nthreads * sizeof(worker_args));
+    if (threads == NULL || args == NULL)
+    {
+        free(threads);
+        free(args);
+        return 0;
+    }
+
+    double start = now_sec();
+    for (size_t t = 0; t < nthreads; t++)
+    {
+        args[t] = (worker_args){table, keys, n, ops, write_percent, 0x9E3779B97F4A7C15ULL * (t + 1)};
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+    for (size_t t = 0; t < nthreads; t++)
+        pthread_join(threads[t], NULL);
+    double seconds = now_sec() - start;
+
+    free(threads);
+    free(args);
+    return (double)(ops * nthreads) / seconds;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+    size_t shards = argc > 2 ? strtoull(argv[2], NULL, 10) : 64;
+    size_t ops = argc > 3 ? strtoull(argv[3], NULL, 10) : 1000000;
+    size_t max_threads = argc > 4 ? strtoull(argv[4], NULL, 10) : 64;
+
+    char *keys = malloc(n * KEY_SIZE);
+    sht *table = sht_create(shards, NULL);
+    if (keys == NULL || table == NULL)
+    {
+        fprintf(stderr, "Error: out of memory.\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        snprintf(keys + i * KEY_SIZE, KEY_SIZE, "key%zu", i);
+        sht_set(table, keys + i * KEY_SIZE, (void *)(uintptr_t)(i + 1));
+    }
+
+    printf("%zu keys, %zu shards, %zu ops per thread\n", n, shards, ops);
+    printf("%8s %18s %18s\n", "threads", "95/5 Mops/s", "50/50 Mops/s");
+    for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+    {
+        double read_heavy = run_mix(table, keys, n, ops, 5, nthreads);
+        double write_heavy = run_mix(table, keys, n, ops, 50, nthreads);
+        printf("%8zu %18.2f %18.2f\n", nthreads, read_heavy / 1e6, write_heavy / 1e6);
+    }
+
+    sht_destroy(table);
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,1058 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <time.h>
+#include "ht.h"
+#include "ht_hash.h"
+#include "ht_arena.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/*
+ * Swiss-table Hashtable Implementation in C
+ *
+ * Drop-in alternative to ht.c implementing the same ht.h API.
+ * Build with ht_swiss.c instead of ht.c to swap the layout in.
+ *
+ * Next to the entries array the table keeps one control byte per slot:
+ * - EMPTY (0x80) for a slot that was never used,
+ * - DELETED (0xFE) for a slot whose key was removed (a tombstone),
+ * - otherwise the low 7 bits of the hash of the key in that slot (the "tag").
+ *
+ * Slots are grouped in blocks of GROUP_SIZE (16). A probe loads the 16 control
+ * bytes of a group at once and compares them against the tag with SSE2 (x86) or
+ * NEON (ARM), so stored keys are only dereferenced when the tag matches.
+ * The remaining 57 hash bits select the first group; the probe then visits groups
+ * in triangular order (+1, +2, +3 ...), which covers every group when the
+ * number of groups is a power of 2.
+ *
+ * Probes stop at the first group with an EMPTY slot, so ht_remove can only free a
+ * slot outright when its group still has an EMPTY one (no probe ever went past it).
+ * Otherwise it leaves a tombstone, which inserts reuse and resizes drop.
+ *
+ * Keys are malloc'ed or, with HT_KEY_ARENA, copied into the key arena.
+ * HT_KEY_INLINE is not supported: entries stay 16 bytes and the tag check
+ * already avoids most key dereferences. Neither are HT_INCREMENTAL and HT_ROBIN_HOOD
+ * (a probe already scans a whole group per step).
+ * For the same reason the length of a key (for ht_set_n and friends) is not kept in
+ * its entry but in a 4-byte header right before the key bytes, which a probe only
+ * reads after a tag match, on the same cache line as the key it is about to compare.
+ *
+ * ht_get_many and ht_set_many prefetch the first group of every key in a batch
+ * of HT_BATCH before probing any of them, like ht.c does with home slots.
+ *
+ * -DHT_INSTRUMENT enables the same counters as in ht.c, with probes counted in groups.
+ */
+
+// --- Hashtable Entry ---
+typedef struct
+{
+    const char *key;
+    void *value;
+} ht_entry;
+
+// --- Hashtable Structure ---
+struct ht
+{
+    uint8_t *ctrl;      // One control byte per slot (EMPTY, DELETED or 7-bit tag)
+    ht_entry *entries;  // Key-value pairs, only valid where ctrl holds a tag
+    size_t capacity;    // Total number of slots, a power of 2 multiple of GROUP_SIZE
+    size_t length;      // Number of key-value pairs stored
+    size_t growth_left; // EMPTY slots left to fill before the table reaches its maximum load
+    double max_load;    // Maximum load factor, in (0, 1)
+    unsigned flags;     // HT_KEY_* options given to ht_create_opts
+    ht_arena arena;     // Key storage for HT_KEY_ARENA
+    ht_hash_fn hash_fn; // Hash function selected by ht_options.hash
+    uint64_t seed;      // Seed passed to hash_fn
+
+#ifdef HT_INSTRUMENT
+    ht_counters counters; // Read with ht_read_counters
+#endif
+};
+
+// --- Layout Constants ---
+#define GROUP_SIZE 16
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xFE
+
+// Tags have the high bit clear, EMPTY and DELETED have it set.
+#define CTRL_IS_FULL(c) (((c) & 0x80) == 0)
+
+// Length header stored before every key copy.
+#define KEY_HEADER sizeof(uint32_t)
+#define MAX_KEY_LENGTH UINT32_MAX
+
+// Same starting size as ht.c: a single group.
+#define INITIAL_CAPACITY 16
+
+// Default maximum load factor of 7/8: group probing keeps chains short even when mostly full.
+#define DEFAULT_MAX_LOAD 0.875
+
+// Keys hashed and prefetched together by ht_get_many/ht_set_many, as in ht.c.
+#define HT_BATCH 16
+
+#if defined(__GNUC__)
+#define HT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define HT_PREFETCH(addr) ((void)(addr))
+#endif
+
+// HT_COUNT(statement) updates a counter only in builds with -DHT_INSTRUMENT, as in ht.c.
+#ifdef HT_INSTRUMENT
+#define HT_COUNT(statement) statement
+#else
+#define HT_COUNT(statement)
+#endif
+
+/*
+ * ht_max_length
+ * ----------
+ * Returns how many entries a capacity holds before it must expand.
+ * It stays below capacity, so every probe sequence reaches an EMPTY slot.
+ */
+static size_t ht_max_length(size_t capacity, double max_load)
+{
+    size_t max_length = (size_t)((double)capacity * max_load);
+    return max_length < capacity ? max_length : capacity - 1;
+}
+
+/*
+ * ht_capacity_for
+ * ----------
+ * Returns the smallest power of 2 capacity (at least one group) that
+ * holds length entries without expanding, or 0 on overflow.
+ */
+static size_t ht_capacity_for(size_t length, double max_load)
+{
+    if ((double)length / max_load >= (double)(SIZE_MAX / 4))
+        return 0;
+
+    size_t capacity = INITIAL_CAPACITY;
+    while (ht_max_length(capacity, max_load) < length)
+        capacity *= 2;
+    return capacity;
+}
+
+/*
+ * Group matching
+ * ----------
+ * Each helper returns a bitmask with one bit per matching slot of a 16-byte group:
+ * group_match for a given control value, group_match_free for EMPTY or DELETED slots.
+ * On NEON the mask carries 4 bits per slot, so bit positions are divided by MASK_STRIDE.
+ */
+#if defined(__SSE2__)
+
+#define MASK_STRIDE 1
+
+static inline uint64_t group_match(const uint8_t *group, uint8_t tag)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+}
+
+static inline uint64_t group_match_free(const uint8_t *group)
+{
+    // EMPTY and DELETED are the control values with the high bit set
+    return (uint64_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+}
+
+#elif defined(__ARM_NEON)
+
+#define MASK_STRIDE 4
+
+static inline uint64_t neon_mask(uint8x16_t eq)
+{
+    // Narrow every 0x00/0xFF byte to a nibble, keep one bit per slot
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ULL;
+}
+
+static inline uint64_t group_match(const uint8_t *group, uint8_t tag)
+{
+    return neon_mask(vceqq_u8(vld1q_u8(group), vdupq_n_u8(tag)));
+}
+
+static inline uint64_t group_match_free(const uint8_t *group)
+{
+    // vcltq_s8 against zero rather than vcltzq_s8, which is AArch64 only
+    return neon_mask(vcltq_s8(vreinterpretq_s8_u8(vld1q_u8(group)), vdupq_n_s8(0)));
+}
+
+#else
+
+#define MASK_STRIDE 1
+
+static inline uint64_t group_match(const uint8_t *group, uint8_t tag)
+{
+    uint64_t mask = 0;
+    for (int i = 0; i < GROUP_SIZE; i++)
+        mask |= (uint64_t)(group[i] == tag) << i;
+    return mask;
+}
+
+static inline uint64_t group_match_free(const uint8_t *group)
+{
+    uint64_t mask = 0;
+    for (int i = 0; i < GROUP_SIZE; i++)
+        mask |= (uint64_t)(group[i] >> 7) << i;
+    return mask;
+}
+
+#endif
+
+static inline uint64_t group_match_empty(const uint8_t *group)
+{
+    return group_match(group, CTRL_EMPTY);
+}
+
+// Index within the group of the lowest set bit, then drop that bit.
+static inline size_t mask_next(uint64_t *mask)
+{
+#if defined(__GNUC__)
+    size_t slot = (size_t)__builtin_ctzll(*mask) / MASK_STRIDE;
+#else
+    size_t slot = 0;
+    while (!((*mask >> slot) & 1))
+        slot++;
+    slot /= MASK_STRIDE;
+#endif
+    *mask &= *mask - 1;
+    return slot;
+}
+
+// The low 7 bits of the hash go into the control byte.
+static inline uint8_t hash_tag(uint64_t hash)
+{
+    return (uint8_t)(hash & 0x7F);
+}
+
+// The remaining bits pick the first group to probe.
+static inline size_t hash_group(uint64_t hash, size_t group_mask)
+{
+    return (size_t)((hash >> 7) & (uint64_t)group_mask);
+}
+
+/*
+ * ht_alloc_slots
+ * ----------
+ * Allocates the control bytes (all EMPTY) and the entries for a capacity.
+ * Returns true on success, false if memory allocation fails.
+ */
+static bool ht_alloc_slots(size_t capacity, uint8_t **pctrl, ht_entry **pentries)
+{
+    uint8_t *ctrl = malloc(capacity);
+    ht_entry *entries = calloc(capacity, sizeof(ht_entry));
+    if (ctrl == NULL || entries == NULL)
+    {
+        free(ctrl);
+        free(entries);
+        return false;
+    }
+    memset(ctrl, CTRL_EMPTY, capacity);
+    *pctrl = ctrl;
+    *pentries = entries;
+    return true;
+}
+
+/*
+ * ht_create_opts
+ * ----------
+ * Allocates and initializes a new hashtable with the given options (NULL for defaults).
+ * Returns a pointer to the new table, or NULL on failure or unsupported options.
+ */
+ht *ht_create_opts(const ht_options *opts)
+{
+    unsigned flags = opts != NULL ? opts->flags : 0;
+    if (flags & (HT_KEY_INLINE | HT_INCREMENTAL | HT_ROBIN_HOOD))
+    {
+        fprintf(stderr, "Error: HT_KEY_INLINE, HT_INCREMENTAL and HT_ROBIN_HOOD are not supported by the Swiss table "
+                        "layout.\n");
+        return NULL;
+    }
+
+    double max_load = opts != NULL && opts->max_load != 0 ? opts->max_load : DEFAULT_MAX_LOAD;
+    if (!(max_load > 0 && max_load < 1))
+    {
+        fprintf(stderr, "Error: Hashtable max_load must be between 0 and 1.\n");
+        return NULL;
+    }
+
+    size_t capacity = ht_capacity_for(opts != NULL ? opts->capacity : 0, max_load);
+    if (capacity == 0)
+    {
+        fprintf(stderr, "Error: Hashtable capacity overflow.\n");
+        return NULL;
+    }
+
+    ht_hash_fn hash_fn;
+    uint64_t seed;
+    if (!hash_select(opts, &hash_fn, &seed))
+        return NULL;
+
+    ht *table = malloc(sizeof(ht));
+    if (table == NULL)
+        return NULL;
+
+    table->length = 0;
+    table->hash_fn = hash_fn;
+    table->seed = seed;
+    table->capacity = capacity;
+    table->max_load = max_load;
+    table->growth_left = ht_max_length(capacity, max_load);
+    table->flags = flags;
+    table->arena.head = NULL;
+    table->arena.bytes = 0;
+    HT_COUNT(memset(&table->counters, 0, sizeof(table->counters)));
+
+    if (!ht_alloc_slots(table->capacity, &table->ctrl, &table->entries))
+    {
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+/*
+ * ht_create
+ * ----------
+ * Allocates and initializes a new hashtable with default options.
+ * Returns a pointer to the new table, or NULL on failure.
+ */
+ht *ht_create(void)
+{
+    return ht_create_opts(NULL);
+}
+
+/*
+ * ht_create_capacity
+ * ----------
+ * Allocates a new hashtable with room for capacity keys before its first expansion.
+ * Returns a pointer to the new table, or NULL on failure.
+ */
+ht *ht_create_capacity(size_t capacity)
+{
+    ht_options opts = {0};
+    opts.capacity = capacity;
+    return ht_create_opts(&opts);
+}
+
+#ifdef HT_INSTRUMENT
+/*
+ * ht_now_ns
+ * ----------
+ * Returns a timestamp in nanoseconds, from the monotonic clock where there is one.
+ */
+static uint64_t ht_now_ns(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#else
+    // Plain C99: processor time, close enough to time an expansion
+    return (uint64_t)((double)clock() * 1e9 / CLOCKS_PER_SEC);
+#endif
+}
+
+/*
+ * ht_print_counters
+ * ----------
+ * Writes the counters of the table to out on one line.
+ */
+static void ht_print_counters(const ht *table, FILE *out)
+{
+    const ht_counters *c = &table->counters;
+    fprintf(out,
+            "ht %p: %zu keys, %llu gets (%llu hits, %.2f probes each), %llu sets (%llu inserts, %.2f probes each), "
+            "%llu expansions in %.3f ms, %llu key bytes\n",
+            (const void *)table, table->length, (unsigned long long)c->gets, (unsigned long long)c->get_hits,
+            c->gets > 0 ? (double)c->get_probes / (double)c->gets : 0.0, (unsigned long long)c->sets,
+            (unsigned long long)c->set_inserts, c->sets > 0 ? (double)c->set_probes / (double)c->sets : 0.0,
+            (unsigned long long)c->expansions, (double)c->expand_ns / 1e6, (unsigned long long)c->key_bytes);
+}
+#endif
+
+/*
+ * ht_destroy
+ * ----------
+ * Frees all memory used by the hashtable, including keys and entries.
+ * After calling this, the table pointer is invalid.
+ */
+void ht_destroy(ht *table)
+{
+    if (table == NULL)
+        return;
+
+#ifdef HT_INSTRUMENT
+    if (getenv("HT_COUNTERS") != NULL)
+        ht_print_counters(table, stderr);
+#endif
+
+    // Arena keys go away with their chunks, no need to visit every slot
+    if (!(table->flags & HT_KEY_ARENA))
+    {
+        for (size_t i = 0; i < table->capacity; i++)
+        {
+            if (CTRL_IS_FULL(table->ctrl[i]))
+                free((void *)(table->entries[i].key - KEY_HEADER)); // Free each key allocated by ht_copy_key
+        }
+    }
+
+    arena_free(&table->arena);
+    free(table->ctrl);
+    free(table->entries);
+    free(table);
+}
+
+/*
+ * ht_hash
+ * ----------
+ * Hashes a key of length bytes with the function and seed the table was created with.
+ */
+static inline uint64_t ht_hash(const ht *table, const char *key, size_t length)
+{
+    return table->hash_fn(key, length, table->seed);
+}
+
+/*
+ * ht_key_length
+ * ----------
+ * Returns the length of a key copied by ht_copy_key, read from its header.
+ */
+static inline size_t ht_key_length(const char *stored)
+{
+    uint32_t length;
+    memcpy(&length, stored - KEY_HEADER, sizeof(length));
+    return length;
+}
+
+/*
+ * ht_find
+ * ----------
+ * Returns the slot index holding the key of length bytes, or SIZE_MAX if the key is not stored.
+ * The number of groups examined goes to *groups.
+ */
+static size_t ht_find(const ht *table, const char *key, size_t length, uint64_t hash, size_t *groups)
+{
+    size_t group_mask = table->capacity / GROUP_SIZE - 1;
+    size_t group = hash_group(hash, group_mask);
+    uint8_t tag = hash_tag(hash);
+
+    for (size_t probe = 1;; probe++)
+    {
+        const uint8_t *ctrl = table->ctrl + group * GROUP_SIZE;
+
+        // Only slots whose tag matches are worth a key comparison
+        uint64_t match = group_match(ctrl, tag);
+        while (match)
+        {
+            size_t index = group * GROUP_SIZE + mask_next(&match);
+            const char *stored = table->entries[index].key;
+            if (ht_key_length(stored) == length && memcmp(key, stored, length) == 0)
+            {
+                *groups = probe;
+                return index;
+            }
+        }
+
+        // An EMPTY slot in the group ends the probe sequence: the key would have been placed there
+        if (group_match_empty(ctrl))
+        {
+            *groups = probe;
+            return SIZE_MAX;
+        }
+
+        group = (group + probe) & group_mask;
+    }
+}
+
+/*
+ * ht_find_free
+ * ----------
+ * Returns the first EMPTY or DELETED slot along the probe sequence of hash.
+ * The table always keeps free slots, because it grows before it is full.
+ */
+static size_t ht_find_free(const uint8_t *ctrl_bytes, size_t capacity, uint64_t hash)
+{
+    size_t group_mask = capacity / GROUP_SIZE - 1;
+    size_t group = hash_group(hash, group_mask);
+
+    for (size_t probe = 1;; probe++)
+    {
+        uint64_t free_slots = group_match_free(ctrl_bytes + group * GROUP_SIZE);
+        if (free_slots)
+            return group * GROUP_SIZE + mask_next(&free_slots);
+
+        group = (group + probe) & group_mask;
+    }
+}
+
+/*
+ * ht_get
+ * ----------
+ * Looks up a key in the hashtable and returns its value.
+ * Returns NULL if the key is not found.
+ */
+void *ht_get(ht *table, const char *key)
+{
+    if (key == NULL)
+        return NULL;
+    return ht_get_n(table, key, strlen(key));
+}
+
+/*
+ * ht_get_n
+ * ----------
+ * Looks up a key of length bytes, which may contain NUL bytes and needn't be NUL-terminated.
+ * Returns its value, or NULL if the key is not found.
+ */
+void *ht_get_n(ht *table, const void *key, size_t length)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+
+    size_t groups;
+    size_t index = ht_find(table, key, length, ht_hash(table, key, length), &groups);
+    HT_COUNT(table->counters.gets++; table->counters.get_probes += groups;
+             table->counters.get_hits += index != SIZE_MAX);
+    return index == SIZE_MAX ? NULL : table->entries[index].value;
+}
+
+/*
+ * ht_get_many
+ * ----------
+ * Looks up n keys, storing each value (NULL if not found) in values.
+ * Each batch runs in three passes over its keys: hash and prefetch the control
+ * bytes of the first group, then match the tag there and prefetch the first
+ * candidate entry, then probe.
+ */
+void ht_get_many(ht *table, const char *const *keys, size_t n, void **values)
+{
+    if (table == NULL || keys == NULL || values == NULL)
+        return;
+
+    uint64_t hashes[HT_BATCH];
+    size_t lengths[HT_BATCH];
+    size_t group_mask = table->capacity / GROUP_SIZE - 1;
+    for (size_t base = 0; base < n; base += HT_BATCH)
+    {
+        size_t count = n - base < HT_BATCH ? n - base : HT_BATCH;
+        const char *const *batch = keys + base;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (batch[i] == NULL)
+                continue;
+            lengths[i] = strlen(batch[i]);
+            hashes[i] = ht_hash(table, batch[i], lengths[i]);
+            HT_PREFETCH(table->ctrl + hash_group(hashes[i], group_mask) * GROUP_SIZE);
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (batch[i] == NULL)
+                continue;
+            size_t group = hash_group(hashes[i], group_mask);
+            uint64_t match = group_match(table->ctrl + group * GROUP_SIZE, hash_tag(hashes[i]));
+            if (match)
+                HT_PREFETCH(&table->entries[group * GROUP_SIZE + mask_next(&match)]);
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            values[base + i] = NULL;
+            if (batch[i] == NULL)
+                continue;
+
+            size_t groups;
+            size_t index = ht_find(table, batch[i], lengths[i], hashes[i], &groups);
+            HT_COUNT(table->counters.gets++; table->counters.get_probes += groups;
+                     table->counters.get_hits += index != SIZE_MAX);
+            if (index != SIZE_MAX)
+                values[base + i] = table->entries[index].value;
+        }
+    }
+}
+
+/*
+ * ht_resize
+ * ----------
+ * Moves every entry into freshly allocated control bytes and entries of new_capacity slots.
+ * Returns true on success, false on failure (e.g., memory allocation fails).
+ */
+static bool ht_resize(ht *table, size_t new_capacity)
+{
+    uint8_t *new_ctrl;
+    ht_entry *new_entries;
+    if (!ht_alloc_slots(new_capacity, &new_ctrl, &new_entries))
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for new hashtable entries.\n");
+        return false;
+    }
+
+    // Keys are unique, so entries can go straight into the first free slot.
+    // Tombstones are not carried over.
+    for (size_t i = 0; i < table->capacity; i++)
+    {
+        if (!CTRL_IS_FULL(table->ctrl[i]))
+            continue;
+
+        const char *key = table->entries[i].key;
+        uint64_t hash = ht_hash(table, key, ht_key_length(key));
+        size_t index = ht_find_free(new_ctrl, new_capacity, hash);
+        new_ctrl[index] = hash_tag(hash);
+        new_entries[index] = table->entries[i];
+    }
+
+    free(table->ctrl);
+    free(table->entries);
+    table->ctrl = new_ctrl;
+    table->entries = new_entries;
+    table->capacity = new_capacity;
+    table->growth_left = ht_max_length(new_capacity, table->max_load) - table->length;
+
+    return true;
+}
+
+/*
+ * ht_expand
+ * ----------
+ * Doubles the capacity of the hashtable.
+ * Returns true on success, false on failure (e.g., memory allocation fails).
+ */
+static bool ht_expand(ht *table)
+{
+    size_t new_capacity = table->capacity * 2;
+    if (new_capacity < table->capacity)
+    {
+        fprintf(stderr, "Error: Hashtable capacity overflow during expansion.\n");
+        return false;
+    }
+
+#ifdef HT_INSTRUMENT
+    uint64_t start = ht_now_ns();
+    bool resized = ht_resize(table, new_capacity);
+    table->counters.expand_ns += ht_now_ns() - start;
+    table->counters.expansions += resized;
+    return resized;
+#else
+    return ht_resize(table, new_capacity);
+#endif
+}
+
+/*
+ * ht_reserve
+ * ----------
+ * Grows the table so that it holds length entries without expanding again.
+ * Returns true on success, false on failure.
+ */
+bool ht_reserve(ht *table, size_t length)
+{
+    if (table == NULL)
+        return false;
+
+    size_t capacity = ht_capacity_for(length, table->max_load);
+    if (capacity == 0)
+    {
+        fprintf(stderr, "Error: Hashtable capacity overflow.\n");
+        return false;
+    }
+    if (capacity <= table->capacity)
+        return true;
+
+    return ht_resize(table, capacity);
+}
+
+/*
+ * ht_copy_key
+ * ----------
+ * Makes the table's own copy of a new key of length bytes, in the key arena (HT_KEY_ARENA)
+ * or with malloc: a length header, the key bytes and a NUL, so string keys stay C strings.
+ * Returns the address of the key bytes, or NULL if memory allocation fails.
+ */
+static const char *ht_copy_key(ht *table, const char *key, size_t length)
+{
+    size_t size = KEY_HEADER + length + 1;
+    char *copy = (table->flags & HT_KEY_ARENA) ? arena_alloc(&table->arena, size) : malloc(size);
+    if (copy == NULL)
+        return NULL;
+    HT_COUNT(table->counters.key_bytes += size);
+
+    uint32_t header = (uint32_t)length;
+    memcpy(copy, &header, KEY_HEADER);
+    memcpy(copy + KEY_HEADER, key, length);
+    copy[KEY_HEADER + length] = '\0';
+    return copy + KEY_HEADER;
+}
+
+/*
+ * ht_set_hashed
+ * ----------
+ * Updates the value in place if the key is already stored, otherwise copies the key
+ * into the first EMPTY slot of its probe sequence, expanding the table first if it is
+ * at its maximum load. The caller passes the length and hash of key.
+ * Returns a pointer to the stored key string on success, NULL on failure.
+ */
+static const char *ht_set_hashed(ht *table, const char *key, size_t length, uint64_t hash, void *value)
+{
+    if (length > MAX_KEY_LENGTH)
+    {
+        fprintf(stderr, "Error: Hashtable key too long.\n");
+        return NULL;
+    }
+
+    size_t groups;
+    size_t index = ht_find(table, key, length, hash, &groups);
+    HT_COUNT(table->counters.sets++; table->counters.set_probes += groups);
+    if (index != SIZE_MAX)
+    {
+        table->entries[index].value = value;
+        return table->entries[index].key;
+    }
+
+    if (table->growth_left == 0)
+    {
+        // When tombstones took up most of the room, a rehash at the same capacity reclaims it
+        bool mostly_deleted = table->length < ht_max_length(table->capacity, table->max_load) / 2;
+        if (!(mostly_deleted ? ht_resize(table, table->capacity) : ht_expand(table)))
+            return NULL;
+    }
+
+    const char *new_key_copy = ht_copy_key(table, key, length);
+    if (new_key_copy == NULL)
+        return NULL;
+
+    index = ht_find_free(table->ctrl, table->capacity, hash);
+    if (table->ctrl[index] == CTRL_EMPTY)
+        table->growth_left--; // Reusing a tombstone takes no extra room
+    table->ctrl[index] = hash_tag(hash);
+    table->entries[index].key = new_key_copy;
+    table->entries[index].value = value;
+    table->length++;
+    HT_COUNT(table->counters.set_inserts++);
+    return new_key_copy;
+}
+
+/** Set value in the table.
+ * Checks the arguments and delegates to ht_set_hashed.
+ * Returns a pointer to the stored key string on success, NULL on failure.
+ */
+const char *ht_set(ht *table, const char *key, void *value)
+{
+    if (key == NULL)
+        return NULL;
+    return ht_set_n(table, key, strlen(key), value);
+}
+
+/*
+ * ht_set_n
+ * ----------
+ * Sets a key of length bytes, which may contain NUL bytes and needn't be NUL-terminated.
+ * Returns a pointer to the stored (NUL-terminated) key on success, NULL on failure.
+ */
+const char *ht_set_n(ht *table, const void *key, size_t length, void *value)
+{
+    assert(value != NULL); // (debug builds)
+    if (table == NULL || key == NULL || value == NULL)
+        return NULL;
+
+    return ht_set_hashed(table, key, length, ht_hash(table, key, length), value);
+}
+
+/*
+ * ht_set_many
+ * ----------
+ * Sets n keys to their values, in order, hashing and prefetching the first group
+ * of each key of a batch before inserting it.
+ * Returns the number of keys set: less than n if a key could not be stored
+ * (NULL key or value, or out of memory), in which case the following keys are not set.
+ */
+size_t ht_set_many(ht *table, const char *const *keys, void *const *values, size_t n)
+{
+    if (table == NULL || keys == NULL || values == NULL)
+        return 0;
+
+    uint64_t hashes[HT_BATCH];
+    size_t lengths[HT_BATCH];
+    for (size_t base = 0; base < n; base += HT_BATCH)
+    {
+        size_t count = n - base < HT_BATCH ? n - base : HT_BATCH;
+        const char *const *batch = keys + base;
+
+        // An expansion while inserting the batch only wastes the remaining prefetches
+        size_t group_mask = table->capacity / GROUP_SIZE - 1;
+        // Only the keys before a NULL key or value are set
+        size_t valid = 0;
+        while (valid < count && batch[valid] != NULL && values[base + valid] != NULL)
+            valid++;
+        assert(valid == count || batch[valid] == NULL); // NULL values: debug builds stop here, as in ht_set
+
+        for (size_t i = 0; i < valid; i++)
+        {
+            lengths[i] = strlen(batch[i]);
+            hashes[i] = ht_hash(table, batch[i], lengths[i]);
+            HT_PREFETCH(table->ctrl + hash_group(hashes[i], group_mask) * GROUP_SIZE);
+        }
+
+        for (size_t i = 0; i < valid; i++)
+        {
+            if (ht_set_hashed(table, batch[i], lengths[i], hashes[i], values[base + i]) == NULL)
+                return base + i;
+        }
+        if (valid < count)
+            return base + valid;
+    }
+    return n;
+}
+
+/*
+ * ht_bulk_load
+ * ----------
+ * Creates a table with the given options and room for n keys, and sets keys[i] to values[i].
+ * Probes wander from group to group over the whole table, which can't be split into
+ * regions filled independently, so threads is ignored and ht_set_many sets the keys.
+ * Returns the table, or NULL on failure (NULL key or value, options, out of memory).
+ */
+ht *ht_bulk_load(const ht_options *opts, const char *const *keys, void *const *values, size_t n, unsigned threads)
+{
+    (void)threads;
+    if (keys == NULL || values == NULL)
+        return NULL;
+
+    ht_options sized = opts != NULL ? *opts : (ht_options){0};
+    if (sized.capacity < n)
+        sized.capacity = n;
+    ht *table = ht_create_opts(&sized);
+    if (table != NULL && ht_set_many(table, keys, values, n) != n)
+    {
+        ht_destroy(table);
+        return NULL;
+    }
+    return table;
+}
+
+/*
+ * ht_remove
+ * ----------
+ * Removes a key from the hashtable and frees its copy (arena keys stay allocated until ht_destroy).
+ * Returns the value that was stored with the key, or NULL if it was not found.
+ */
+void *ht_remove(ht *table, const char *key)
+{
+    if (key == NULL)
+        return NULL;
+    return ht_remove_n(table, key, strlen(key));
+}
+
+/*
+ * ht_remove_n
+ * ----------
+ * Removes a key of length bytes, like ht_remove.
+ * Returns the value that was stored with the key, or NULL if it was not found.
+ */
+void *ht_remove_n(ht *table, const void *key, size_t length)
+{
+    if (table == NULL || key == NULL)
+        return NULL;
+
+    size_t groups;
+    size_t index = ht_find(table, key, length, ht_hash(table, key, length), &groups);
+    if (index == SIZE_MAX)
+        return NULL;
+
+    void *value = table->entries[index].value;
+    if (!(table->flags & HT_KEY_ARENA))
+        free((void *)(table->entries[index].key - KEY_HEADER));
+    table->entries[index].key = NULL;
+
+    // A group with an EMPTY slot never ended up full, so no probe sequence continues past it
+    uint8_t *group = table->ctrl + index / GROUP_SIZE * GROUP_SIZE;
+    if (group_match_empty(group))
+    {
+        table->ctrl[index] = CTRL_EMPTY;
+        table->growth_left++;
+    }
+    else
+    {
+        table->ctrl[index] = CTRL_DELETED;
+    }
+
+    table->length--;
+    return value;
+}
+
+/*
+ * ht_length
+ * ----------
+ * Returns the current number of key-value pairs stored in the hashtable.
+ */
+size_t ht_length(ht *table)
+{
+    if (table == NULL)
+        return 0;
+    return table->length;
+}
+
+/*
+ * ht_read_counters
+ * ----------
+ * Copies the instrumentation counters of the table into *counters.
+ * Returns false, with *counters zeroed, in builds without HT_INSTRUMENT.
+ */
+bool ht_read_counters(ht *table, ht_counters *counters)
+{
+    if (counters == NULL)
+        return false;
+    memset(counters, 0, sizeof(*counters));
+    if (table == NULL)
+        return false;
+
+#ifdef HT_INSTRUMENT
+    *counters = table->counters;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+ * ht_stats
+ * ----------
+ * Computes the load factor and probe distances of the table with a scan of its slots.
+ * The probe distance of a key is the number of groups its probe visits before its own,
+ * found by rehashing the key and following the triangular sequence from its first group.
+ */
+ht_statistics ht_stats(ht *table)
+{
+    ht_statistics stats = {0};
+    if (table == NULL)
+        return stats;
+
+    size_t group_mask = table->capacity / GROUP_SIZE - 1;
+    size_t total = 0;
+    for (size_t i = 0; i < table->capacity; i++)
+    {
+        if (!CTRL_IS_FULL(table->ctrl[i]))
+            continue;
+
+        const char *key = table->entries[i].key;
+        size_t group = hash_group(ht_hash(table, key, ht_key_length(key)), group_mask);
+        size_t distance = 0;
+        while (group != i / GROUP_SIZE)
+        {
+            distance++;
+            group = (group + distance) & group_mask;
+        }
+
+        total += distance;
+        if (distance > stats.max_probe)
+            stats.max_probe = distance;
+    }
+
+    stats.length = table->length;
+    stats.capacity = table->capacity;
+    stats.load_factor = (double)table->length / (double)table->capacity;
+    stats.mean_probe = table->length > 0 ? (double)total / (double)table->length : 0;
+    return stats;
+}
+
+/*
+ * ht_save / ht_load
+ * ----------
+ * Snapshots are the linear-probing layout's entries array written out as is,
+ * so this layout doesn't support them.
+ */
+bool ht_save(ht *table, const char *path)
+{
+    (void)table;
+    (void)path;
+    fprintf(stderr, "Error: Snapshots are not supported by the Swiss table layout.\n");
+    return false;
+}
+
+ht *ht_load(const char *path)
+{
+    (void)path;
+    fprintf(stderr, "Error: Snapshots are not supported by the Swiss table layout.\n");
+    return NULL;
+}
+
+/*
+ * ht_iterator
+ * ----------
+ * Initializes and returns a new hashtable iterator.
+ */
+hti ht_iterator(ht *table)
+{
+    hti it;
+    it._table = table;
+    it._index = 0;
+    it._end = SIZE_MAX;
+    it.key = NULL;
+    it.value = NULL;
+    it.length = 0;
+    return it;
+}
+
+/*
+ * ht_iterator_part
+ * ----------
+ * Returns an iterator over part (0 to parts - 1) of its slots.
+ */
+hti ht_iterator_part(ht *table, size_t part, size_t parts)
+{
+    hti it = ht_iterator(table);
+    if (table == NULL || parts == 0 || part >= parts)
+    {
+        it._end = 0;
+        return it;
+    }
+    size_t total = table->capacity, share = total / parts, extra = total % parts;
+    it._index = part * share + (part < extra ? part : extra);
+    it._end = it._index + share + (part < extra ? 1 : 0);
+    return it;
+}
+
+/*
+ * ht_next
+ * ----------
+ * Advances the iterator to the next occupied slot, updating its key and value.
+ * Returns true if there is a next entry, false otherwise.
+ */
+bool ht_next(hti *it)
+{
+    if (it == NULL || it->_table == NULL)
+        return false;
+
+    ht *table = it->_table;
+
+    size_t end = table->capacity;
+    if (it->_end < end)
+        end = it->_end;
+
+    while (it->_index < end)
+    {
+        size_t i = it->_index;
+        it->_index++;
+
+        if (CTRL_IS_FULL(table->ctrl[i]))
+        {
+            it->key = table->entries[i].key;
+            it->value = table->entries[i].value;
+            it->length = ht_key_length(it->key);
+            return true;
+        }
+    }
+
+    it->key = NULL;
+    it->value = NULL;
+    it->length = 0;
+    return false;
+}
@@ -0,0 +1,435 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "ht.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HAVE_PERF_EVENTS 1
+#endif
+
+/*
+ * Hashtable workload benchmark
+ *
+ * The reference measurement for hashtable changes: links against either layout,
+ * like ht_bench, and sweeps table sizes and key distributions.
+ * gcc -O2 -o ht_workload_bench ht_workload_bench.c ht.c -lm
+ * gcc -O2 -o ht_workload_bench_swiss ht_workload_bench.c ht_swiss.c -lm
+ * gcc -O2 -o ht_workload_bench_dense ht_workload_bench.c ht_dense.c -lm
+ *
+ * Usage: ./ht_workload_bench [max=<keys>] [min=<keys>] [zipf=<theta>] [arena] [inline] [robin]
+ *                            [load=<factor>] [hash=fnv1a|wy|crc32c|seeded]
+ * Runs sizes of 1000, 10000 ... up to max keys (10000000 by default; max=100000000
+ * needs about 14 GB). For every size:
+ * - insert: n distinct keys into a new table,
+ * - iterate: one ht_next pass over the table,
+ * then, for a uniform and a Zipfian (theta 0.99 by default) choice of keys:
+ * - hit: lookups of stored keys,
+ * - miss: lookups of keys that were never stored,
+ * - mixed: 90% lookups, 5% updates, 5% removes each followed by reinserting the key.
+ * Each workload runs max(n, 1M) operations (at most 10M), except insert and iterate
+ * which do n. Zipfian ranks are scrambled over the keys, so hot keys are spread
+ * across the table instead of being the first ones inserted.
+ *
+ * Reported: throughput, latency percentiles, hardware cache misses per operation
+ * (Linux perf events, "-" where they can't be opened: no PMU, containers,
+ * perf_event_paranoid) and the peak RSS of the process after each size.
+ * Latencies come from timing every SAMPLE_EVERY-th operation on its own, so the
+ * clock reads add only a fraction of their cost to the throughput figure; the
+ * median cost of a clock read pair is measured at startup and subtracted.
+ */
+
+#define KEY_SIZE 16
+#define MIN_OPS 1000000
+#define MAX_OPS 10000000
+#define SAMPLE_EVERY 16
+
+// Absent keys used by the miss workload, chosen by the same distributions
+#define MAX_ABSENT 1000000
+
+typedef struct
+{
+    double ops_per_sec;
+    uint64_t p50, p99, p999; // Sampled latencies in ns, 0 when not sampled
+    double misses_per_op;    // Negative when unavailable
+} result;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// xorshift64, as in ht_sharded_bench.c
+static inline uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// Spreads Zipfian ranks over key indexes (the MurmurHash3 finalizer)
+static inline uint64_t scramble(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Median ns of two back to back now_ns calls, taken out of every latency sample
+static uint64_t clock_overhead;
+
+static void calibrate_clock(void)
+{
+    uint64_t samples[1001];
+    for (size_t i = 0; i < 1001; i++)
+    {
+        uint64_t start = now_ns();
+        samples[i] = now_ns() - start;
+    }
+    qsort(samples, 1001, sizeof(uint64_t), compare_u64);
+    clock_overhead = samples[500];
+}
+
+/*
+ * fill_uniform / fill_zipf
+ * ----------
+ * Fill count key indexes in [0, n), uniformly or following a Zipfian distribution of
+ * parameter theta (Gray et al., "Quickly Generating Billion-Record Synthetic Databases",
+ * the generator YCSB uses). The rank distribution needs zeta(n), an O(n) sum.
+ */
+static void fill_uniform(uint32_t *indexes, size_t count, size_t n, uint64_t seed)
+{
+    uint64_t state = seed;
+    for (size_t i = 0; i < count; i++)
+        indexes[i] = (uint32_t)(next_random(&state) % n);
+}
+
+static void fill_zipf(uint32_t *indexes, size_t count, size_t n, double theta, uint64_t seed)
+{
+    double zetan = 0;
+    for (size_t i = 1; i <= n; i++)
+        zetan += 1.0 / pow((double)i, theta);
+    double zeta2 = 1.0 + 1.0 / pow(2.0, theta);
+    double alpha = 1.0 / (1.0 - theta);
+    double eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+
+    uint64_t state = seed;
+    for (size_t i = 0; i < count; i++)
+    {
+        double u = (double)(next_random(&state) >> 11) * 0x1.0p-53;
+        double uz = u * zetan;
+        uint64_t rank;
+        if (uz < 1.0)
+            rank = 0;
+        else if (uz < zeta2)
+            rank = 1;
+        else
+            rank = (uint64_t)((double)n * pow(eta * u - eta + 1.0, alpha));
+        indexes[i] = (uint32_t)(scramble(rank) % n);
+    }
+}
+
+// --- Cache Miss Counter ---
+#ifdef HAVE_PERF_EVENTS
+static int miss_counter = -1;
+
+static void misses_open(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    miss_counter = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void misses_start(void)
+{
+    if (miss_counter < 0)
+        return;
+    ioctl(miss_counter, PERF_EVENT_IOC_RESET, 0);
+    ioctl(miss_counter, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+// Misses since misses_start, or -1 without a counter
+static double misses_stop(void)
+{
+    uint64_t count;
+    if (miss_counter < 0)
+        return -1;
+    ioctl(miss_counter, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(miss_counter, &count, sizeof(count)) != (ssize_t)sizeof(count))
+        return -1;
+    return (double)count;
+}
+#else
+static void misses_open(void) {}
+static void misses_start(void) {}
+static double misses_stop(void) { return -1; }
+#endif
+
+// Peak resident set size of the process in MB
+static double peak_rss_mb(void)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return (double)usage.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+    return (double)usage.ru_maxrss / 1024.0; // kilobytes
+#endif
+}
+
+/*
+ * TIMED_LOOP
+ * ----------
+ * Runs stmt for i in 0..ops-1, timing every SAMPLE_EVERY-th run on its own into
+ * samples, and fills *res with the throughput, percentiles and cache misses.
+ */
+#define TIMED_LOOP(res, ops, samples, stmt)                                              \
+    do                                                                                   \
+    {                                                                                    \
+        size_t sampled_ = 0;                                                             \
+        misses_start();                                                                  \
+        uint64_t start_ = now_ns();                                                      \
+        for (size_t i = 0; i < (ops); i++)                                               \
+        {                                                                                \
+            if (i % SAMPLE_EVERY == 0)                                                   \
+            {                                                                            \
+                uint64_t op_start_ = now_ns();                                           \
+                stmt;                                                                    \
+                (samples)[sampled_++] = now_ns() - op_start_;                            \
+            }                                                                            \
+            else                                                                         \
+            {                                                                            \
+                stmt;                                                                    \
+            }                                                                            \
+        }                                                                                \
+        uint64_t elapsed_ = now_ns() - start_;                                           \
+        double misses_ = misses_stop();                                                  \
+        finish_result((res), (ops), elapsed_, misses_, (samples), sampled_);             \
+    } while (0)
+
+static void finish_result(result *res, size_t ops, uint64_t elapsed, double misses, uint64_t *samples,
+                          size_t sampled)
+{
+    res->ops_per_sec = (double)ops / ((double)elapsed * 1e-9);
+    res->misses_per_op = misses < 0 ? -1 : misses / (double)ops;
+    res->p50 = res->p99 = res->p999 = 0;
+    if (sampled > 0)
+    {
+        qsort(samples, sampled, sizeof(uint64_t), compare_u64);
+        uint64_t percentiles[3] = {samples[sampled / 2], samples[sampled * 99 / 100], samples[sampled * 999 / 1000]};
+        for (int p = 0; p < 3; p++)
+            percentiles[p] = percentiles[p] > clock_overhead ? percentiles[p] - clock_overhead : 0;
+        res->p50 = percentiles[0];
+        res->p99 = percentiles[1];
+        res->p999 = percentiles[2];
+    }
+}
+
+static void print_result(size_t n, const char *dist, const char *workload, const result *res)
+{
+    printf("%10zu %-8s %-8s %10.2f %9.1f", n, dist, workload, res->ops_per_sec / 1e6, 1e9 / res->ops_per_sec);
+    if (res->p999 > 0)
+        printf(" %8llu %8llu %8llu", (unsigned long long)res->p50, (unsigned long long)res->p99,
+               (unsigned long long)res->p999);
+    else
+        printf(" %8s %8s %8s", "-", "-", "-");
+    if (res->misses_per_op >= 0)
+        printf(" %10.2f\n", res->misses_per_op);
+    else
+        printf(" %10s\n", "-");
+}
+
+// Key i of the stored set, or of the absent set
+static inline const char *key_at(const char *keys, size_t i)
+{
+    return keys + i * KEY_SIZE;
+}
+
+/*
+ * run_size
+ * ----------
+ * Runs every workload on a new table of n keys. Returns false if a lookup
+ * returns a wrong result or the table can't be built.
+ */
+static bool run_size(size_t n, const ht_options *opts, double theta, const char *keys, const char *absent,
+                     uint32_t *indexes, uint64_t *samples)
+{
+    size_t ops = n < MIN_OPS ? MIN_OPS : n > MAX_OPS ? MAX_OPS : n;
+    size_t absent_n = n < MAX_ABSENT ? n : MAX_ABSENT;
+    result res;
+    bool ok = true;
+
+    ht *table = ht_create_opts(opts);
+    if (table == NULL)
+        return false;
+
+    TIMED_LOOP(&res, n, samples, ok &= ht_set(table, key_at(keys, i), (void *)(uintptr_t)(i + 1)) != NULL);
+    print_result(n, "-", "insert", &res);
+    if (!ok || ht_length(table) != n)
+    {
+        ht_destroy(table);
+        return false;
+    }
+
+    // ht_next steps differ in cost from one slot to the next, so only the average is kept
+    size_t visited = 0;
+    hti it = ht_iterator(table);
+    misses_start();
+    uint64_t start = now_ns();
+    while (ht_next(&it))
+        visited += it.value != NULL;
+    uint64_t elapsed = now_ns() - start;
+    finish_result(&res, n, elapsed, misses_stop(), samples, 0);
+    print_result(n, "-", "iterate", &res);
+    ok &= visited == n;
+
+    const char *dists[] = {"uniform", "zipf"};
+    for (int d = 0; d < 2 && ok; d++)
+    {
+        if (d == 0)
+            fill_uniform(indexes, ops, n, 0x9E3779B97F4A7C15ULL + n);
+        else
+            fill_zipf(indexes, ops, n, theta, 0x9E3779B97F4A7C15ULL + n);
+
+        size_t found = 0;
+        TIMED_LOOP(&res, ops, samples, found += ht_get(table, key_at(keys, indexes[i])) != NULL);
+        print_result(n, dists[d], "hit", &res);
+        ok &= found == ops;
+
+        found = 0;
+        TIMED_LOOP(&res, ops, samples, found += ht_get(table, key_at(absent, indexes[i] % absent_n)) != NULL);
+        print_result(n, dists[d], "miss", &res);
+        ok &= found == 0;
+
+        // The operation mix is drawn from another random stream than the keys
+        uint64_t state = 0xD1B54A32D192ED03ULL;
+        TIMED_LOOP(&res, ops, samples, {
+            const char *key = key_at(keys, indexes[i]);
+            uint64_t roll = next_random(&state) % 100;
+            if (roll < 90)
+                ok &= ht_get(table, key) != NULL;
+            else if (roll < 95)
+                ok &= ht_set(table, key, (void *)(uintptr_t)(indexes[i] + 1)) != NULL;
+            else
+                ok &= ht_remove(table, key) != NULL && ht_set(table, key, (void *)(uintptr_t)(indexes[i] + 1)) != NULL;
+        });
+        print_result(n, dists[d], "mixed", &res);
+        ok &= ht_length(table) == n;
+    }
+
+    ht_destroy(table);
+    printf("%10zu peak RSS %.1f MB\n", n, peak_rss_mb());
+    return ok;
+}
+
+static char *make_keys(size_t n, const char *prefix)
+{
+    char *keys = malloc(n * KEY_SIZE);
+    if (keys == NULL)
+        return NULL;
+    for (size_t i = 0; i < n; i++)
+        snprintf(keys + i * KEY_SIZE, KEY_SIZE, "%s%011zx", prefix, i);
+    return keys;
+}
+
+int main(int argc, char **argv)
+{
+    ht_options opts = {0};
+    size_t max = 10000000, min = 1000;
+    double theta = 0.99;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "max=", 4) == 0)
+            max = strtoull(argv[i] + 4, NULL, 10);
+        else if (strncmp(argv[i], "min=", 4) == 0)
+            min = strtoull(argv[i] + 4, NULL, 10);
+        else if (strncmp(argv[i], "zipf=", 5) == 0)
+            theta = strtod(argv[i] + 5, NULL);
+        else if (strcmp(argv[i], "arena") == 0)
+            opts.flags |= HT_KEY_ARENA;
+        else if (strcmp(argv[i], "inline") == 0)
+            opts.flags |= HT_KEY_INLINE;
+        else if (strcmp(argv[i], "robin") == 0)
+            opts.flags |= HT_ROBIN_HOOD;
+        else if (strncmp(argv[i], "load=", 5) == 0)
+            opts.max_load = strtod(argv[i] + 5, NULL);
+        else if (strcmp(argv[i], "hash=fnv1a") == 0)
+            opts.hash = HT_HASH_FNV1A;
+        else if (strcmp(argv[i], "hash=wy") == 0)
+            opts.hash = HT_HASH_WY;
+        else if (strcmp(argv[i], "hash=crc32c") == 0)
+            opts.hash = HT_HASH_CRC32C;
+        else if (strcmp(argv[i], "hash=seeded") == 0)
+            opts.hash = HT_HASH_SEEDED;
+        else
+        {
+            fprintf(stderr, "Error: unknown option '%s'.\n", argv[i]);
+            return 1;
+        }
+    }
+    if (min == 0 || max < min || max > UINT32_MAX || !(theta > 0 && theta < 1))
+    {
+        fprintf(stderr, "Error: need 0 < min <= max <= %u keys and a zipf theta between 0 and 1.\n", UINT32_MAX);
+        return 1;
+    }
+
+    size_t max_ops = max > MAX_OPS ? MAX_OPS : max < MIN_OPS ? MIN_OPS : max;
+    char *keys = make_keys(max, "key:");
+    char *absent = make_keys(max < MAX_ABSENT ? max : MAX_ABSENT, "abs:");
+    uint32_t *indexes = malloc(max_ops * sizeof(uint32_t));
+    uint64_t *samples = malloc((max > max_ops ? max : max_ops) / SAMPLE_EVERY * sizeof(uint64_t) + sizeof(uint64_t));
+    if (keys == NULL || absent == NULL || indexes == NULL || samples == NULL)
+    {
+        fprintf(stderr, "Error: out of memory.\n");
+        return 1;
+    }
+
+    misses_open();
+    calibrate_clock();
+    printf("%10s %-8s %-8s %10s %9s %8s %8s %8s %10s\n", "keys", "dist", "workload", "Mops/s", "ns/op", "p50 ns",
+           "p99 ns", "p999 ns", "misses/op");
+    for (size_t n = min; n <= max; n *= 10)
+    {
+        if (!run_size(n, &opts, theta, keys, absent, indexes, samples))
+        {
+            fprintf(stderr, "Error: workload on %zu keys failed or returned wrong results.\n", n);
+            return 1;
+        }
+        if (n > SIZE_MAX / 10)
+            break;
+    }
+
+    free(samples);
+    free(indexes);
+    free(absent);
+    free(keys);
+    return 0;
+}
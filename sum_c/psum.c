@@ -0,0 +1,776 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "psum.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PSUM_HAVE_THREADS 1
+#define PSUM_HAVE_MMAP 1
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*
+ * Partition Sums
+ *
+ * gcc -O2 -pthread -c psum.c          (SSE2 on x86-64)
+ * gcc -O2 -mavx2 -pthread -c psum.c   (AVX2)
+ *
+ * Usage:
+ * int64_t sums[2];
+ * psum_parity(values, n, sums);                 // sums[0]: even values, sums[1]: odd values
+ * psum_parity_parallel(values, n, 0, sums);     // the same on every CPU
+ *
+ * psum_key digit = {.kind = PSUM_KEY_BITS, .shift = 8};
+ * psum_bucket out[256];
+ * psum_buckets(values, n, &digit, 256, 0, out); // sum and count per second byte
+ *
+ * psum_parity_file("values.bin", NULL, sums);    // a file of ints, streamed in 16 MB chunks
+ *
+ * sum[a[i] & 1] += a[i] picks its accumulator from the data, so every add depends
+ * on the previous add to whichever of the two sums it lands in, through memory,
+ * and the loop can't be vectorized. Here every value goes to the same place:
+ * odd values are selected with a mask instead,
+ *
+ *     total += a[i];
+ *     odd   += a[i] & -(a[i] & 1);   // a[i] if odd, 0 if even
+ *
+ * and the even sum is total - odd. Each SIMD lane keeps its own total and odd sums,
+ * widened to 64 bits as they accumulate, with two vectors in flight per iteration
+ * so consecutive adds don't wait on each other.
+ */
+
+/*
+ * psum_parity_scalar
+ * ----------
+ * The loop of sum.c, with 64-bit sums.
+ */
+void psum_parity_scalar(const int *values, size_t n, int64_t sums[2])
+{
+    sums[0] = sums[1] = 0;
+    for (size_t i = 0; i < n; i++)
+        sums[values[i] & 1] += values[i];
+}
+
+/*
+ * psum_lanes
+ * ----------
+ * Adds the values up to the last full block into *total and their odd ones into *odd,
+ * and returns how many values it consumed (the rest are left to the scalar tail).
+ */
+#if defined(__AVX2__)
+
+static size_t psum_lanes(const int *values, size_t n, int64_t *total, int64_t *odd)
+{
+    __m256i total0 = _mm256_setzero_si256(), total1 = _mm256_setzero_si256();
+    __m256i odd0 = _mm256_setzero_si256(), odd1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));
+        // Bit 0 moved to the sign bit and shifted back: all ones for odd values
+        __m256i odd_values = _mm256_and_si256(v, _mm256_srai_epi32(_mm256_slli_epi32(v, 31), 31));
+        total0 = _mm256_add_epi64(total0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        total1 = _mm256_add_epi64(total1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+        odd0 = _mm256_add_epi64(odd0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(odd_values)));
+        odd1 = _mm256_add_epi64(odd1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(odd_values, 1)));
+    }
+
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_add_epi64(total0, total1));
+    *total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_add_epi64(odd0, odd1));
+    *odd = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return i;
+}
+
+#elif defined(__SSE2__)
+
+// Adds the four 32-bit lanes of v, sign-extended, to the two 64-bit lanes of *low and *high
+static inline void psum_widen_add(__m128i v, __m128i *low, __m128i *high)
+{
+    __m128i sign = _mm_srai_epi32(v, 31);
+    *low = _mm_add_epi64(*low, _mm_unpacklo_epi32(v, sign));
+    *high = _mm_add_epi64(*high, _mm_unpackhi_epi32(v, sign));
+}
+
+static size_t psum_lanes(const int *values, size_t n, int64_t *total, int64_t *odd)
+{
+    __m128i total0 = _mm_setzero_si128(), total1 = _mm_setzero_si128();
+    __m128i odd0 = _mm_setzero_si128(), odd1 = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(values + i));
+        // Bit 0 moved to the sign bit and shifted back: all ones for odd values
+        __m128i odd_values = _mm_and_si128(v, _mm_srai_epi32(_mm_slli_epi32(v, 31), 31));
+        psum_widen_add(v, &total0, &total1);
+        psum_widen_add(odd_values, &odd0, &odd1);
+    }
+
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, _mm_add_epi64(total0, total1));
+    *total = lanes[0] + lanes[1];
+    _mm_storeu_si128((__m128i *)lanes, _mm_add_epi64(odd0, odd1));
+    *odd = lanes[0] + lanes[1];
+    return i;
+}
+
+#elif defined(__ARM_NEON)
+
+static size_t psum_lanes(const int *values, size_t n, int64_t *total, int64_t *odd)
+{
+    int64x2_t total0 = vdupq_n_s64(0), total1 = vdupq_n_s64(0);
+    int64x2_t odd0 = vdupq_n_s64(0), odd1 = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        int32x4_t low = vld1q_s32(values + i), high = vld1q_s32(values + i + 4);
+        // vpadalq adds pairs of 32-bit lanes into the 64-bit lanes, widening as it goes
+        total0 = vpadalq_s32(total0, low);
+        total1 = vpadalq_s32(total1, high);
+        odd0 = vpadalq_s32(odd0, vandq_s32(low, vshrq_n_s32(vshlq_n_s32(low, 31), 31)));
+        odd1 = vpadalq_s32(odd1, vandq_s32(high, vshrq_n_s32(vshlq_n_s32(high, 31), 31)));
+    }
+    // Reduce lane by lane: vaddvq_s64 is AArch64 only
+    total0 = vaddq_s64(total0, total1);
+    odd0 = vaddq_s64(odd0, odd1);
+    *total = vgetq_lane_s64(total0, 0) + vgetq_lane_s64(total0, 1);
+    *odd = vgetq_lane_s64(odd0, 0) + vgetq_lane_s64(odd0, 1);
+    return i;
+}
+
+#else
+
+static size_t psum_lanes(const int *values, size_t n, int64_t *total, int64_t *odd)
+{
+    (void)values;
+    (void)n;
+    *total = *odd = 0;
+    return 0;
+}
+
+#endif
+
+/*
+ * psum_parity
+ * ----------
+ * Runs the SIMD lanes over the bulk of the array, and the masked scalar loop over the rest.
+ */
+void psum_parity(const int *values, size_t n, int64_t sums[2])
+{
+    int64_t total, odd;
+    size_t i = psum_lanes(values, n, &total, &odd);
+    for (; i < n; i++)
+    {
+        int64_t x = values[i];
+        total += x;
+        odd += x & -(x & 1);
+    }
+    sums[0] = total - odd;
+    sums[1] = odd;
+}
+
+// --- Parallel Reduction ---
+// Below this many values per thread, starting a thread costs more than it saves.
+#define PSUM_MIN_PER_THREAD (1 << 18)
+
+#ifdef PSUM_HAVE_THREADS
+typedef struct
+{
+    const int *values;
+    size_t n;
+    int64_t sums[2];
+} psum_slice;
+
+static void *psum_slice_worker(void *arg)
+{
+    psum_slice *slice = arg;
+    psum_parity(slice->values, slice->n, slice->sums);
+    return NULL;
+}
+#endif
+
+/*
+ * psum_parallel_threads
+ * ----------
+ * Returns how many threads to reduce n values on: threads (all online CPUs for 0),
+ * but no more than leaves each one PSUM_MIN_PER_THREAD values.
+ */
+static unsigned psum_parallel_threads(size_t n, unsigned threads)
+{
+#ifdef PSUM_HAVE_THREADS
+    // Not even two threads' worth: skip the sysconf call, which costs more than small reductions
+    if (n < 2 * PSUM_MIN_PER_THREAD)
+        return 1;
+    if (threads == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned)online : 1;
+    }
+    size_t most = n / PSUM_MIN_PER_THREAD;
+    if (most < threads)
+        threads = most > 0 ? (unsigned)most : 1;
+    return threads;
+#else
+    (void)n;
+    (void)threads;
+    return 1;
+#endif
+}
+
+/*
+ * psum_parity_parallel
+ * ----------
+ * Gives each thread a slice of the array (the calling thread takes the last one)
+ * and adds up their sums. If a thread can't be started, its slice is reduced
+ * on the calling thread instead.
+ */
+void psum_parity_parallel(const int *values, size_t n, unsigned threads, int64_t sums[2])
+{
+    threads = psum_parallel_threads(n, threads);
+    if (threads <= 1)
+    {
+        psum_parity(values, n, sums);
+        return;
+    }
+
+#ifdef PSUM_HAVE_THREADS
+    psum_slice *slices = malloc(threads * sizeof(psum_slice));
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    bool *started = calloc(threads, sizeof(bool));
+    if (slices == NULL || ids == NULL || started == NULL)
+    {
+        free(slices);
+        free(ids);
+        free(started);
+        psum_parity(values, n, sums);
+        return;
+    }
+
+    size_t per_slice = n / threads;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        size_t start = (size_t)t * per_slice;
+        size_t end = t + 1 == threads ? n : start + per_slice;
+        slices[t] = (psum_slice){values + start, end - start, {0, 0}};
+        if (t + 1 < threads)
+            started[t] = pthread_create(&ids[t], NULL, psum_slice_worker, &slices[t]) == 0;
+    }
+    psum_slice_worker(&slices[threads - 1]);
+
+    sums[0] = sums[1] = 0;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        if (t + 1 < threads)
+        {
+            if (started[t])
+                pthread_join(ids[t], NULL);
+            else
+                psum_slice_worker(&slices[t]);
+        }
+        sums[0] += slices[t].sums[0];
+        sums[1] += slices[t].sums[1];
+    }
+
+    free(slices);
+    free(ids);
+    free(started);
+#endif
+}
+
+// --- Bucket Copies ---
+// With few buckets, runs of values in the same bucket make every add wait for the previous
+// one to the same counters, through memory. Every fourth value goes to its own copy of the
+// buckets instead, giving four independent chains; the copies are added up at the end.
+#define PSUM_FEW_BUCKETS 256
+#define PSUM_COPIES 4
+
+// Cache line size: each thread's copies start on a line of their own
+#define PSUM_CACHE_LINE 64
+
+/*
+ * PSUM_TALLY
+ * ----------
+ * Adds every value x of values[0..n) to hist[bucket_of], bucket_of being an expression of x,
+ * spreading them over copies (1 or PSUM_COPIES) copies of buckets buckets; values, n, hist,
+ * buckets and copies are those of the enclosing function.
+ * A macro, so that each kind of key gets its own loop with the key computation inlined.
+ */
+#define PSUM_ADD(copy, value, bucket_of)                             \
+    do                                                               \
+    {                                                                \
+        int x = (value);                                             \
+        psum_bucket *bucket = &(copy)[bucket_of];                    \
+        bucket->sum += x;                                            \
+        bucket->count++;                                             \
+    } while (0)
+
+#define PSUM_TALLY(bucket_of)                                        \
+    do                                                               \
+    {                                                                \
+        size_t i = 0;                                                \
+        psum_bucket *h0 = hist;                                      \
+        if (copies == PSUM_COPIES)                                   \
+        {                                                            \
+            psum_bucket *h1 = h0 + buckets;                          \
+            psum_bucket *h2 = h1 + buckets, *h3 = h2 + buckets;      \
+            for (; i + PSUM_COPIES <= n; i += PSUM_COPIES)           \
+            {                                                        \
+                PSUM_ADD(h0, values[i], bucket_of);                  \
+                PSUM_ADD(h1, values[i + 1], bucket_of);              \
+                PSUM_ADD(h2, values[i + 2], bucket_of);              \
+                PSUM_ADD(h3, values[i + 3], bucket_of);              \
+            }                                                        \
+        }                                                            \
+        for (; i < n; i++)                                           \
+            PSUM_ADD(h0, values[i], bucket_of);                      \
+    } while (0)
+
+/*
+ * psum_key_valid
+ * ----------
+ * Returns true if key can map values to buckets buckets.
+ */
+static bool psum_key_valid(const psum_key *key, size_t buckets)
+{
+    if (key == NULL || buckets == 0)
+        return false;
+    switch (key->kind)
+    {
+    case PSUM_KEY_BITS:
+        return key->shift < 32 && (buckets & (buckets - 1)) == 0;
+    case PSUM_KEY_RANGE:
+        return key->width > 0;
+    case PSUM_KEY_FUNC:
+        return key->func != NULL;
+    default:
+        return false;
+    }
+}
+
+// Bucket of x for PSUM_KEY_RANGE, dividing by a power of 2 width with a shift.
+// x - min is taken in unsigned arithmetic: it can exceed INT64_MAX when min is far below INT_MIN.
+static inline size_t psum_range_shift(int x, int64_t min, unsigned shift, size_t last)
+{
+    if (x < min)
+        return 0;
+    uint64_t bucket = ((uint64_t)x - (uint64_t)min) >> shift;
+    return bucket < last ? (size_t)bucket : last;
+}
+
+static inline size_t psum_range_divide(int x, int64_t min, uint64_t width, size_t last)
+{
+    if (x < min)
+        return 0;
+    uint64_t bucket = ((uint64_t)x - (uint64_t)min) / width;
+    return bucket < last ? (size_t)bucket : last;
+}
+
+static inline size_t psum_clamp(size_t bucket, size_t last)
+{
+    return bucket < last ? bucket : last;
+}
+
+/*
+ * psum_tally
+ * ----------
+ * Adds the n values to hist, copies zeroed copies of buckets buckets, with the loop for the key's kind.
+ */
+static void psum_tally(const int *values, size_t n, const psum_key *key, size_t buckets, size_t copies,
+                       psum_bucket *hist)
+{
+    size_t last = buckets - 1;
+    if (key->kind == PSUM_KEY_BITS)
+    {
+        unsigned shift = key->shift;
+        PSUM_TALLY(((unsigned)x >> shift) & last);
+    }
+    else if (key->kind == PSUM_KEY_RANGE && (key->width & (key->width - 1)) == 0)
+    {
+        unsigned shift = 0;
+        while ((INT64_C(1) << shift) < key->width)
+            shift++;
+        int64_t min = key->min;
+        PSUM_TALLY(psum_range_shift(x, min, shift, last));
+    }
+    else if (key->kind == PSUM_KEY_RANGE)
+    {
+        int64_t min = key->min;
+        uint64_t width = (uint64_t)key->width;
+        PSUM_TALLY(psum_range_divide(x, min, width, last));
+    }
+    else
+    {
+        size_t (*func)(int value, void *ctx) = key->func;
+        void *ctx = key->ctx;
+        PSUM_TALLY(psum_clamp(func(x, ctx), last));
+    }
+}
+
+// --- Bucket Slices ---
+// One per thread: its share of the values and its private copies of the buckets.
+typedef struct
+{
+    const int *values;
+    size_t n;
+    const psum_key *key;
+    size_t buckets;
+    size_t copies;
+    psum_bucket *hist; // copies * buckets buckets, NULL if out of memory
+} psum_bucket_slice;
+
+static void *psum_bucket_worker(void *arg)
+{
+    psum_bucket_slice *slice = arg;
+    size_t bytes = slice->copies * slice->buckets * sizeof(psum_bucket);
+    bytes = (bytes + PSUM_CACHE_LINE - 1) & ~(size_t)(PSUM_CACHE_LINE - 1);
+    slice->hist = aligned_alloc(PSUM_CACHE_LINE, bytes);
+    if (slice->hist == NULL)
+        return NULL;
+    for (size_t b = 0; b < slice->copies * slice->buckets; b++)
+        slice->hist[b] = (psum_bucket){0, 0};
+    psum_tally(slice->values, slice->n, slice->key, slice->buckets, slice->copies, slice->hist);
+    return NULL;
+}
+
+/*
+ * psum_buckets
+ * ----------
+ * Tallies a slice of the values per thread (the calling thread takes the last one, and
+ * the slices of threads that can't be started), then merges every copy of every slice into out.
+ */
+bool psum_buckets(const int *values, size_t n, const psum_key *key, size_t buckets, unsigned threads,
+                  psum_bucket *out)
+{
+    if (out == NULL || !psum_key_valid(key, buckets) || buckets > SIZE_MAX / PSUM_COPIES / sizeof(psum_bucket))
+        return false;
+
+    threads = psum_parallel_threads(n, threads);
+    psum_bucket_slice *slices = malloc(threads * sizeof(psum_bucket_slice));
+    if (slices == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for bucket slices.\n");
+        return false;
+    }
+
+    size_t copies = buckets <= PSUM_FEW_BUCKETS ? PSUM_COPIES : 1;
+    size_t per_slice = n / threads;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        size_t start = (size_t)t * per_slice;
+        size_t end = t + 1 == threads ? n : start + per_slice;
+        slices[t] = (psum_bucket_slice){values + start, end - start, key, buckets, copies, NULL};
+    }
+
+#ifdef PSUM_HAVE_THREADS
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    bool *started = calloc(threads, sizeof(bool));
+    for (unsigned t = 0; ids != NULL && started != NULL && t + 1 < threads; t++)
+        started[t] = pthread_create(&ids[t], NULL, psum_bucket_worker, &slices[t]) == 0;
+    psum_bucket_worker(&slices[threads - 1]);
+    for (unsigned t = 0; t + 1 < threads; t++)
+    {
+        if (ids != NULL && started != NULL && started[t])
+            pthread_join(ids[t], NULL);
+        else
+            psum_bucket_worker(&slices[t]);
+    }
+    free(ids);
+    free(started);
+#else
+    for (unsigned t = 0; t < threads; t++)
+        psum_bucket_worker(&slices[t]);
+#endif
+
+    bool ok = true;
+    for (unsigned t = 0; t < threads; t++)
+        ok = ok && slices[t].hist != NULL;
+    if (ok)
+    {
+        for (size_t b = 0; b < buckets; b++)
+            out[b] = (psum_bucket){0, 0};
+        for (unsigned t = 0; t < threads; t++)
+        {
+            for (size_t b = 0; b < copies * buckets; b++)
+            {
+                out[b % buckets].sum += slices[t].hist[b].sum;
+                out[b % buckets].count += slices[t].hist[b].count;
+            }
+        }
+    }
+    else
+        fprintf(stderr, "Error: Failed to allocate memory for bucket copies.\n");
+
+    for (unsigned t = 0; t < threads; t++)
+        free(slices[t].hist);
+    free(slices);
+    return ok;
+}
+
+// --- Streaming ---
+#define PSUM_STREAM_CHUNK (16 << 20)
+
+/*
+ * psum_add_chunk
+ * ----------
+ * Adds the parity sums of the n values of one chunk to sums.
+ */
+static void psum_add_chunk(const int *values, size_t n, unsigned threads, int64_t sums[2])
+{
+    int64_t chunk[2];
+    psum_parity_parallel(values, n, threads, chunk);
+    sums[0] += chunk[0];
+    sums[1] += chunk[1];
+}
+
+#ifdef PSUM_HAVE_THREADS
+// --- Double Buffering ---
+// The reader thread fills buffers[k] and marks it full; the reducing thread empties it
+// and marks it free again, alternating between the two.
+typedef struct
+{
+    FILE *file;
+    size_t chunk;
+    int *buffers[2];
+    size_t lengths[2]; // Bytes read into each full buffer: less than chunk for the last one
+    bool full[2];
+    bool error;        // A read failed
+    bool stop;         // The reducing thread is done, the reader must not wait for it
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} psum_reader;
+
+static void *psum_reader_thread(void *arg)
+{
+    psum_reader *reader = arg;
+    for (int k = 0;; k ^= 1)
+    {
+        pthread_mutex_lock(&reader->lock);
+        while (reader->full[k] && !reader->stop)
+            pthread_cond_wait(&reader->changed, &reader->lock);
+        bool stop = reader->stop;
+        pthread_mutex_unlock(&reader->lock);
+        if (stop)
+            return NULL;
+
+        size_t length = fread(reader->buffers[k], 1, reader->chunk, reader->file);
+        pthread_mutex_lock(&reader->lock);
+        reader->lengths[k] = length;
+        reader->full[k] = true;
+        reader->error = ferror(reader->file) != 0;
+        pthread_cond_broadcast(&reader->changed);
+        pthread_mutex_unlock(&reader->lock);
+        if (length < reader->chunk)
+            return NULL;
+    }
+}
+#endif
+
+/*
+ * psum_stream_read
+ * ----------
+ * PSUM_STREAM_READ: reduces chunk k while the reader thread reads chunk k + 1.
+ * Without threads, or if the reader thread can't be started, reads and reduces in turn.
+ * Returns the number of bytes in the file, or sets *ok to false on errors.
+ */
+static size_t psum_stream_read(FILE *file, size_t chunk, unsigned threads, int64_t sums[2], bool *ok)
+{
+    size_t total = 0;
+#ifdef PSUM_HAVE_THREADS
+    psum_reader reader = {file, chunk, {malloc(chunk), malloc(chunk)}, {0, 0}, {false, false}, false, false,
+                          PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+    pthread_t id;
+    if (reader.buffers[0] != NULL && reader.buffers[1] != NULL &&
+        pthread_create(&id, NULL, psum_reader_thread, &reader) == 0)
+    {
+        for (int k = 0;; k ^= 1)
+        {
+            pthread_mutex_lock(&reader.lock);
+            while (!reader.full[k])
+                pthread_cond_wait(&reader.changed, &reader.lock);
+            size_t length = reader.lengths[k];
+            pthread_mutex_unlock(&reader.lock);
+
+            psum_add_chunk(reader.buffers[k], length / sizeof(int), threads, sums);
+            total += length;
+
+            pthread_mutex_lock(&reader.lock);
+            reader.full[k] = false;
+            if (length < chunk)
+                reader.stop = true;
+            pthread_cond_broadcast(&reader.changed);
+            pthread_mutex_unlock(&reader.lock);
+            if (length < chunk)
+                break;
+        }
+        pthread_join(id, NULL);
+        *ok = !reader.error;
+        free(reader.buffers[0]);
+        free(reader.buffers[1]);
+        return total;
+    }
+    free(reader.buffers[0]);
+    free(reader.buffers[1]);
+#endif
+
+    int *buffer = malloc(chunk);
+    if (buffer == NULL)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for stream buffer.\n");
+        *ok = false;
+        return 0;
+    }
+    size_t length;
+    do
+    {
+        length = fread(buffer, 1, chunk, file);
+        psum_add_chunk(buffer, length / sizeof(int), threads, sums);
+        total += length;
+    } while (length == chunk);
+    *ok = ferror(file) == 0;
+    free(buffer);
+    return total;
+}
+
+#ifdef PSUM_HAVE_MMAP
+/*
+ * psum_stream_mmap
+ * ----------
+ * PSUM_STREAM_MMAP: maps window k + 1 and asks for it to be read ahead (MADV_WILLNEED)
+ * before reducing window k, then unmaps window k, so at most two windows are mapped.
+ * Returns false if a window can't be mapped.
+ */
+static bool psum_stream_mmap(int fd, size_t size, size_t window, unsigned threads, int64_t sums[2])
+{
+    void *current = NULL;
+    for (size_t offset = 0; offset < size; offset += window)
+    {
+        size_t length = size - offset < window ? size - offset : window;
+        if (current == NULL)
+        {
+            current = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, (off_t)offset);
+            if (current == MAP_FAILED)
+                return false;
+            madvise(current, length, MADV_SEQUENTIAL);
+        }
+
+        void *next = NULL;
+        if (offset + length < size)
+        {
+            size_t next_length = size - offset - length < window ? size - offset - length : window;
+            next = mmap(NULL, next_length, PROT_READ, MAP_PRIVATE, fd, (off_t)(offset + length));
+            if (next == MAP_FAILED)
+            {
+                munmap(current, length);
+                return false;
+            }
+            madvise(next, next_length, MADV_SEQUENTIAL);
+            madvise(next, next_length, MADV_WILLNEED);
+        }
+
+        psum_add_chunk(current, length / sizeof(int), threads, sums);
+        munmap(current, length);
+        current = next;
+    }
+    return true;
+}
+#endif
+
+/*
+ * psum_parity_file
+ * ----------
+ * Streams the file with the chosen mode, rounding the chunk size to whole pages
+ * (down to the largest page multiple when rounding up would overflow).
+ */
+bool psum_parity_file(const char *path, const psum_stream_options *opts, int64_t sums[2])
+{
+    psum_stream_options options = {0};
+    if (opts != NULL)
+        options = *opts;
+    size_t chunk = options.chunk_bytes > 0 ? options.chunk_bytes : PSUM_STREAM_CHUNK;
+    size_t page = 4096;
+#ifdef PSUM_HAVE_MMAP
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size > 0)
+        page = (size_t)page_size;
+#endif
+    if (chunk > SIZE_MAX - (page - 1))
+        chunk = SIZE_MAX / page * page; // rounding up would wrap to 0
+    else
+        chunk = (chunk + page - 1) / page * page;
+    if (chunk == 0)
+    {
+        fprintf(stderr, "Error: invalid chunk size for %s.\n", path);
+        return false;
+    }
+
+    int64_t result[2] = {0, 0};
+    if (options.mode == PSUM_STREAM_MMAP)
+    {
+#ifdef PSUM_HAVE_MMAP
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            fprintf(stderr, "Error: can't open %s.\n", path);
+            return false;
+        }
+        struct stat st;
+        bool ok = false;
+        if (fstat(fd, &st) != 0)
+            fprintf(stderr, "Error: can't get the size of %s.\n", path);
+        else if (!S_ISREG(st.st_mode))
+            fprintf(stderr, "Error: %s isn't a regular file, stream it with PSUM_STREAM_READ.\n", path);
+        else if ((size_t)st.st_size % sizeof(int) != 0)
+            fprintf(stderr, "Error: %s isn't a whole number of ints.\n", path);
+        else if (!psum_stream_mmap(fd, (size_t)st.st_size, chunk, options.threads, result))
+            fprintf(stderr, "Error: can't map %s.\n", path);
+        else
+            ok = true;
+        close(fd);
+        if (!ok)
+            return false;
+#else
+        fprintf(stderr, "Error: PSUM_STREAM_MMAP isn't supported on this platform.\n");
+        return false;
+#endif
+    }
+    else
+    {
+        FILE *file = fopen(path, "rb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "Error: can't open %s.\n", path);
+            return false;
+        }
+        bool ok = true;
+        size_t size = psum_stream_read(file, chunk, options.threads, result, &ok);
+        fclose(file);
+        if (!ok)
+        {
+            fprintf(stderr, "Error: reading %s failed.\n", path);
+            return false;
+        }
+        if (size % sizeof(int) != 0)
+        {
+            fprintf(stderr, "Error: %s isn't a whole number of ints.\n", path);
+            return false;
+        }
+    }
+
+    sums[0] = result[0];
+    sums[1] = result[1];
+    return true;
+}
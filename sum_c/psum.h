@@ -0,0 +1,120 @@
+#ifndef PSUM_H
+#define PSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Partition sums over int arrays: the sum[a[i] & 1] += a[i] of sum.c as reusable kernels.
+ * sums[0] gets the sum of the even values and sums[1] that of the odd ones, in 64 bits,
+ * so any number of ints can be added without overflow.
+ */
+
+/** The plain loop of sum.c, widened to 64-bit sums: the reference the others must match */
+void psum_parity_scalar(const int *values, size_t n, int64_t sums[2]);
+
+/** Same sums, computed without branches or indexed stores: several SIMD lanes
+ *  (AVX2, SSE2 or NEON, whichever the build targets) each accumulate all values
+ *  and the odd ones, and the even sum is their difference.
+ */
+void psum_parity(const int *values, size_t n, int64_t sums[2]);
+
+/** psum_parity split across up to threads threads, 0 for one per online CPU, each
+ *  reducing a contiguous slice. Small arrays, and platforms without threads,
+ *  are reduced on the calling thread.
+ */
+void psum_parity_parallel(const int *values, size_t n, unsigned threads, int64_t sums[2]);
+
+/** Bucket keys for psum_key.kind */
+#define PSUM_KEY_BITS 0  /* bits of the value: ((unsigned)value >> shift) & (buckets - 1), with a
+                            power of 2 number of buckets (low k bits, or a radix digit) */
+#define PSUM_KEY_RANGE 1 /* (value - min) / width, values outside the buckets' range counted
+                            in the first or last */
+#define PSUM_KEY_FUNC 2  /* func(value, ctx), results past the last bucket counted in the last */
+
+/** How psum_buckets maps each value to a bucket. {PSUM_KEY_BITS} is parity with 2 buckets. */
+typedef struct
+{
+    unsigned kind;                        // PSUM_KEY_* kind of key
+    unsigned shift;                       // PSUM_KEY_BITS: lowest bit of the bucket number
+    int64_t min;                          // PSUM_KEY_RANGE: lowest value of the first bucket
+    int64_t width;                        // PSUM_KEY_RANGE: values per bucket, at least 1
+    size_t (*func)(int value, void *ctx); // PSUM_KEY_FUNC: bucket of value
+    void *ctx;                            // PSUM_KEY_FUNC: passed to func
+} psum_key;
+
+/** Sum and number of the values of one bucket */
+typedef struct
+{
+    int64_t sum;
+    uint64_t count;
+} psum_bucket;
+
+/** The general form of the parity sums: adds every value to the sum and count of its bucket
+ *  out[key(value)], for buckets buckets, on up to threads threads (0 for one per online CPU).
+ *  Each thread tallies its slice into private, cache-line aligned bucket copies, merged at the end.
+ *  Return false (out untouched) if the key is invalid for buckets, or out of memory.
+ */
+bool psum_buckets(const int *values, size_t n, const psum_key *key, size_t buckets, unsigned threads,
+                  psum_bucket *out);
+
+/** Ways to stream a file, for psum_stream_options.mode */
+#define PSUM_STREAM_READ 0 /* read chunks into two buffers: a reader thread fills one while the other
+                              is reduced */
+#define PSUM_STREAM_MMAP 1 /* map a window at a time, asking for the next one to be read ahead while
+                              the current one is reduced (Unix only) */
+
+/** File streaming options for psum_parity_file. A zeroed struct gives the defaults. */
+typedef struct
+{
+    unsigned mode;      // PSUM_STREAM_READ or PSUM_STREAM_MMAP
+    size_t chunk_bytes; // Bytes read or mapped at a time, 0 for 16 MB
+    unsigned threads;   // Threads reducing each chunk, 0 for one per online CPU
+} psum_stream_options;
+
+/** Parity sums (as psum_parity) of a file of native-endian 32-bit ints, reduced chunk by chunk
+ *  as it is read, so memory use stays at two chunks whatever the size of the file.
+ *  opts may be NULL for the defaults.
+ *  Return false if the file can't be read, or its size isn't a whole number of ints.
+ *  PSUM_STREAM_MMAP only takes regular files: stream pipes and devices with PSUM_STREAM_READ.
+ */
+bool psum_parity_file(const char *path, const psum_stream_options *opts, int64_t sums[2]);
+
+/*
+ * Closed forms for arithmetic ranges: first, first + step, first + 2 step ... up to last.
+ * Terms 0, 2, 4 ... all have the parity of first and terms 1, 3, 5 ... that of first + step
+ * (the same one for an even step), and each group is itself an arithmetic series:
+ * j terms of a, a + 2 step ... add up to j a + step j (j - 1).
+ * The arithmetic is done modulo 2^64, which gives the exact sum whenever it fits in 64 bits.
+ */
+#define PSUM_RANGE_COUNT(first, last, step) \
+    ((int64_t)(last) < (int64_t)(first) ? (uint64_t)0 : (uint64_t)((int64_t)(last) - (first)) / (uint64_t)(step) + 1)
+#define PSUM_SERIES(a, step, j) ((uint64_t)(int64_t)(a) * (j) + (uint64_t)(int64_t)(step) * (j) * ((j) - 1))
+
+/** Sum of the values of parity (0 for even, 1 for odd) in the range from first to last by step
+ *  (at least 1), as an integer constant expression: usable in static initializers and
+ *  _Static_assert, and folded by the compiler. Arguments are evaluated several times.
+ */
+#define PSUM_RANGE_SUM(first, last, step, parity)                                                         \
+    ((int64_t)((((int64_t)(first) & 1) == (parity)                                                        \
+                    ? PSUM_SERIES(first, step, (PSUM_RANGE_COUNT(first, last, step) + 1) / 2)               \
+                    : 0) +                                                                                \
+               ((((int64_t)(first) + (step)) & 1) == (parity)                                             \
+                    ? PSUM_SERIES((int64_t)(first) + (step), step, PSUM_RANGE_COUNT(first, last, step) / 2) \
+                    : 0)))
+
+/** Parity sums (as psum_parity) of the range from first to last by step, in O(1) with no array:
+ *  inlined, so constant ranges fold to constants. Ranges with last below first are empty.
+ *  Return false (sums untouched) if step is below 1. Arbitrary data goes to psum_parity.
+ */
+static inline bool psum_parity_range(int first, int last, int step, int64_t sums[2])
+{
+    if (step < 1)
+        return false;
+    sums[0] = PSUM_RANGE_SUM(first, last, step, 0);
+    sums[1] = PSUM_RANGE_SUM(first, last, step, 1);
+    return true;
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "psum.h"
+
+/*
+ * Partition sum benchmark
+ *
+ * Compares the scalar loop of sum.c with psum_parity and psum_parity_parallel:
+ * gcc -O2 -pthread -o psum_bench psum_bench.c psum.c
+ * (add -mavx2 or -march=native for the AVX2 kernel)
+ *
+ * Usage: ./psum_bench [max values] [threads]
+ * Defaults to arrays of 100, 1000 ... up to 1000000000 values (4 GB) of random ints,
+ * and one thread per online CPU (0) for the parallel kernel. Small arrays are reduced
+ * repeatedly, so every line adds up at least 200 million values per kernel.
+ * Each line reports the throughput of each kernel in GB/s of ints read, and the
+ * speedup over the scalar loop. The three must agree on the sums.
+ */
+
+#define MIN_VALUES_PER_LINE 200000000
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: cheap random numbers
+static inline uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/*
+ * time_kernel
+ * ----------
+ * Runs kernel rounds times over the n values and returns the seconds per round.
+ * sums gets the result of the last round.
+ */
+static double time_kernel(int kernel, const int *values, size_t n, unsigned threads, size_t rounds, int64_t sums[2])
+{
+    double start = now_sec();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        if (kernel == 0)
+            psum_parity_scalar(values, n, sums);
+        else if (kernel == 1)
+            psum_parity(values, n, sums);
+        else
+            psum_parity_parallel(values, n, threads, sums);
+    }
+    return (now_sec() - start) / (double)rounds;
+}
+
+int main(int argc, char **argv)
+{
+    size_t max = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000000;
+    unsigned threads = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 10) : 0;
+
+    int *values = malloc((max > 0 ? max : 1) * sizeof(int));
+    if (values == NULL)
+    {
+        fprintf(stderr, "Error: out of memory for %zu values.\n", max);
+        return 1;
+    }
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < max; i++)
+        values[i] = (int)(uint32_t)next_random(&state);
+
+    printf("%12s %12s %12s %12s %9s %9s\n", "values", "scalar GB/s", "simd GB/s", "threads GB/s", "simd x",
+           "threads x");
+    for (size_t n = 100; n <= max; n *= 10)
+    {
+        size_t rounds = n < MIN_VALUES_PER_LINE ? MIN_VALUES_PER_LINE / n : 1;
+        int64_t expected[2], simd[2], parallel[2];
+        double scalar_sec = time_kernel(0, values, n, threads, rounds, expected);
+        double simd_sec = time_kernel(1, values, n, threads, rounds, simd);
+        double parallel_sec = time_kernel(2, values, n, threads, rounds, parallel);
+        if (simd[0] != expected[0] || simd[1] != expected[1] || parallel[0] != expected[0] ||
+            parallel[1] != expected[1])
+        {
+            fprintf(stderr, "Error: kernels disagree on %zu values.\n", n);
+            free(values);
+            return 1;
+        }
+
+        double bytes = (double)n * sizeof(int);
+        printf("%12zu %12.2f %12.2f %12.2f %9.2f %9.2f\n", n, bytes / scalar_sec / 1e9, bytes / simd_sec / 1e9,
+               bytes / parallel_sec / 1e9, scalar_sec / simd_sec, scalar_sec / parallel_sec);
+    }
+
+    free(values);
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "psum.h"
+
+/*
+ * Bucketed partition sum benchmark
+ *
+ * Times psum_buckets on 2, 16, 256 and 65536 buckets:
+ * gcc -O2 -pthread -o psum_buckets_bench psum_buckets_bench.c psum.c
+ *
+ * Usage: ./psum_buckets_bench [number of values] [threads]
+ * Defaults to 100000000 random ints, and one thread per online CPU (0).
+ * Every bucket count is run with three keys: the low bits of the value (PSUM_KEY_BITS),
+ * equal ranges over all ints (PSUM_KEY_RANGE) and a hash of the value (PSUM_KEY_FUNC,
+ * a call per value). Each line reports the millions of values tallied per millisecond
+ * on one thread and on [threads] threads, and the two must agree.
+ */
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: cheap random numbers
+static inline uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// PSUM_KEY_FUNC key: multiplicative hash, top bits picked by the bucket count in ctx
+static size_t hash_bucket(int value, void *ctx)
+{
+    unsigned bits = *(const unsigned *)ctx;
+    return (size_t)(((uint32_t)value * 2654435761u) >> (32 - bits));
+}
+
+/*
+ * time_buckets
+ * ----------
+ * Returns the millions of values tallied per millisecond, or 0 if psum_buckets failed.
+ */
+static double time_buckets(const int *values, size_t n, const psum_key *key, size_t buckets, unsigned threads,
+                           psum_bucket *out)
+{
+    double start = now_sec();
+    if (!psum_buckets(values, n, key, buckets, threads, out))
+        return 0;
+    return (double)n / ((now_sec() - start) * 1e3) / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000000;
+    unsigned threads = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 10) : 0;
+
+    int *values = malloc((n > 0 ? n : 1) * sizeof(int));
+    psum_bucket *single = malloc(65536 * sizeof(psum_bucket));
+    psum_bucket *parallel = malloc(65536 * sizeof(psum_bucket));
+    if (values == NULL || single == NULL || parallel == NULL)
+    {
+        fprintf(stderr, "Error: out of memory.\n");
+        return 1;
+    }
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < n; i++)
+        values[i] = (int)(uint32_t)next_random(&state);
+
+    static const unsigned bucket_bits[] = {1, 4, 8, 16};
+    printf("%zu values\n", n);
+    printf("%8s %-6s %18s %18s\n", "buckets", "key", "1 thread M/ms", "threads M/ms");
+    for (size_t k = 0; k < sizeof(bucket_bits) / sizeof(bucket_bits[0]); k++)
+    {
+        unsigned bits = bucket_bits[k];
+        size_t buckets = (size_t)1 << bits;
+        psum_key keys[3] = {
+            {.kind = PSUM_KEY_BITS},
+            {.kind = PSUM_KEY_RANGE, .min = INT32_MIN, .width = (INT64_C(1) << 32) / (int64_t)buckets},
+            {.kind = PSUM_KEY_FUNC, .func = hash_bucket, .ctx = &bits},
+        };
+        static const char *names[3] = {"bits", "range", "func"};
+
+        for (int key = 0; key < 3; key++)
+        {
+            double one = time_buckets(values, n, &keys[key], buckets, 1, single);
+            double many = time_buckets(values, n, &keys[key], buckets, threads, parallel);
+            for (size_t b = 0; b < buckets; b++)
+            {
+                if (single[b].sum != parallel[b].sum || single[b].count != parallel[b].count)
+                {
+                    fprintf(stderr, "Error: results differ across threads in bucket %zu.\n", b);
+                    return 1;
+                }
+            }
+            printf("%8zu %-6s %18.2f %18.2f\n", buckets, names[key], one, many);
+        }
+    }
+
+    free(values);
+    free(single);
+    free(parallel);
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "psum.h"
+
+/*
+ * Streaming partition sum benchmark
+ *
+ * Compares psum_parity_file with plain reads of the same file (Unix only):
+ * gcc -O2 -pthread -o psum_stream_bench psum_stream_bench.c psum.c
+ *
+ * Usage: ./psum_stream_bench <file> [size in MB] [threads]
+ * If the file doesn't exist it is first written with [size in MB] (2048 by default) of
+ * random ints, and kept for later runs. Threads defaults to one per online CPU (0).
+ * Every line reports GB/s once cold, after dropping the file's pages from the page cache
+ * (posix_fadvise), so reads come from the disk, and once warm, reading it back from the
+ * page cache. "read only" reads the file in 16 MB chunks and does nothing else: the
+ * ceiling for the other lines. Last, the peak RSS shows memory stayed at a few chunks.
+ */
+
+#define WRITE_CHUNK (16 << 20)
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift64: cheap random numbers
+static inline uint64_t next_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/*
+ * write_file
+ * ----------
+ * Writes mb megabytes of random ints to path, a chunk at a time.
+ */
+static bool write_file(const char *path, size_t mb)
+{
+    FILE *file = fopen(path, "wb");
+    int *chunk = malloc(WRITE_CHUNK);
+    if (file == NULL || chunk == NULL)
+    {
+        fprintf(stderr, "Error: can't create %s.\n", path);
+        if (file != NULL)
+            fclose(file);
+        free(chunk);
+        return false;
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    bool ok = true;
+    for (size_t left = mb << 20; ok && left > 0;)
+    {
+        size_t bytes = left < WRITE_CHUNK ? left : WRITE_CHUNK;
+        for (size_t i = 0; i < bytes / sizeof(int); i++)
+            chunk[i] = (int)(uint32_t)next_random(&state);
+        ok = fwrite(chunk, 1, bytes, file) == bytes;
+        left -= bytes;
+    }
+    ok = fclose(file) == 0 && ok;
+    free(chunk);
+    if (!ok)
+        fprintf(stderr, "Error: writing %s failed.\n", path);
+    return ok;
+}
+
+/*
+ * drop_cache
+ * ----------
+ * Asks the kernel to drop the file's pages from the page cache, so the next read goes to disk.
+ */
+static void drop_cache(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+/*
+ * read_only
+ * ----------
+ * Reads the whole file in WRITE_CHUNK chunks without looking at them.
+ */
+static bool read_only(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    char *chunk = malloc(WRITE_CHUNK);
+    bool ok = file != NULL && chunk != NULL;
+    while (ok && fread(chunk, 1, WRITE_CHUNK, file) == WRITE_CHUNK)
+        ;
+    ok = ok && ferror(file) == 0;
+    if (file != NULL)
+        fclose(file);
+    free(chunk);
+    return ok;
+}
+
+/*
+ * run
+ * ----------
+ * Times one pass over the file, with mode -1 for read_only or a PSUM_STREAM_* mode,
+ * and returns its throughput in GB/s, or 0 on errors.
+ */
+static double run(const char *path, size_t size, int mode, unsigned threads, int64_t sums[2])
+{
+    double start = now_sec();
+    bool ok;
+    if (mode < 0)
+        ok = read_only(path);
+    else
+    {
+        psum_stream_options opts = {(unsigned)mode, 0, threads};
+        ok = psum_parity_file(path, &opts, sums);
+    }
+    double seconds = now_sec() - start;
+    return ok ? (double)size / seconds / 1e9 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <file> [size in MB] [threads]\n", argv[0]);
+        return 1;
+    }
+    const char *path = argv[1];
+    size_t mb = argc > 2 ? strtoull(argv[2], NULL, 10) : 2048;
+    unsigned threads = argc > 3 ? (unsigned)strtoul(argv[3], NULL, 10) : 0;
+
+    struct stat st;
+    if (stat(path, &st) != 0)
+    {
+        if (!write_file(path, mb) || stat(path, &st) != 0)
+            return 1;
+    }
+    size_t size = (size_t)st.st_size;
+
+    static const char *names[] = {"read only", "psum read", "psum mmap"};
+    int64_t sums[2][2] = {{0, 0}, {0, 0}}, unused[2];
+    printf("%s: %.1f MB\n", path, (double)size / (1 << 20));
+    printf("%-10s %12s %12s\n", "", "cold GB/s", "warm GB/s");
+    for (int mode = -1; mode <= PSUM_STREAM_MMAP; mode++)
+    {
+        int64_t *result = mode < 0 ? unused : sums[mode];
+        drop_cache(path);
+        double cold = run(path, size, mode, threads, result);
+        double warm = run(path, size, mode, threads, result);
+        if (cold == 0 || warm == 0)
+            return 1;
+        printf("%-10s %12.2f %12.2f\n", names[mode + 1], cold, warm);
+    }
+    if (sums[PSUM_STREAM_READ][0] != sums[PSUM_STREAM_MMAP][0] ||
+        sums[PSUM_STREAM_READ][1] != sums[PSUM_STREAM_MMAP][1])
+    {
+        fprintf(stderr, "Error: read and mmap modes disagree.\n");
+        return 1;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("even %lld, odd %lld, peak RSS %.1f MB\n", (long long)sums[0][0], (long long)sums[0][1],
+           (double)usage.ru_maxrss / 1024);
+    return 0;
+}
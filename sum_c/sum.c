@@ -1,19 +1,12 @@
 #include <stdio.h>
+#include "psum.h"
 
 int main(void)
 {
-    int a[100];
+    // The sums of the even and odd numbers from 1 to 100, from their closed forms: integer
+    // constant expressions, so the compiler computes them and there is nothing left to loop over.
+    // psum_parity_scalar keeps the original loop, sum[a[i] & 1] += a[i], for arrays.
+    static const int64_t sum[2] = {PSUM_RANGE_SUM(1, 100, 1, 0), PSUM_RANGE_SUM(1, 100, 1, 1)};
 
-    for (int i = 0; i < 100; i++)
-    {
-        a[i] = i + 1;
-    }
-
-    int sum[2] = {0, 0};
-    for (int i = 0; i < 100; i++)
-    {
-        sum[a[i] & 1] += a[i];
-    }
-
-    printf("%d\n", sum);
-}
\ No newline at end of file
+    printf("Even: %lld\nOdd: %lld\n", (long long)sum[0], (long long)sum[1]);
+}